@@ -0,0 +1,184 @@
+/*
+ * Matthew Diamond 2016
+ * Member functions for the Command_Queue class.
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <atomic>
+
+// Included SDL components
+#include "SDL.h"
+
+// Included files
+#include "main.hpp"
+
+// Included "other" classes
+#include "Command_Queue.hpp"
+
+// Included modules classes
+#include "Module.hpp"
+#include "Modules/Delay.hpp"
+#include "Modules/Mixer.hpp"
+#include "Modules/Oscillator.hpp"
+#include "Modules/Poly.hpp"
+
+/********************************
+ * RING BUFFER MEMBER FUNCTIONS *
+ ********************************/
+
+/*
+ * Constructor.
+ */
+Command_Queue::Ring_Buffer::Ring_Buffer() :
+    read_index(0), write_index(0)
+{}
+
+/*
+ * Push a command onto the ring buffer. Return true if there was room for it,
+ * false otherwise.
+ */
+bool Command_Queue::Ring_Buffer::push(const Command &command)
+{
+    unsigned int write = write_index.load(std::memory_order_relaxed);
+
+    if(write - read_index.load(std::memory_order_acquire) == CAPACITY)
+    {
+        return false;
+    }
+
+    commands[write % CAPACITY] = command;
+    write_index.store(write + 1, std::memory_order_release);
+
+    return true;
+}
+
+/*
+ * Pop the oldest command off of the ring buffer. Return true if there was a
+ * command to pop, false otherwise.
+ */
+bool Command_Queue::Ring_Buffer::pop(Command *command)
+{
+    unsigned int read = read_index.load(std::memory_order_relaxed);
+
+    if(read == write_index.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    *command = commands[read % CAPACITY];
+    read_index.store(read + 1, std::memory_order_release);
+
+    return true;
+}
+
+/**********************************
+ * COMMAND QUEUE MEMBER FUNCTIONS *
+ **********************************/
+
+/*
+ * Constructor.
+ */
+Command_Queue::Command_Queue() :
+    num_posted(0), num_applied(0)
+{}
+
+/*
+ * Destructor.
+ */
+Command_Queue::~Command_Queue()
+{}
+
+/*
+ * Post a command for the audio thread. If audio is off, the audio callback
+ * will not be around to apply it, so apply it right away instead. If the queue
+ * is full, wait for the audio thread to make room.
+ */
+void Command_Queue::post(Command command)
+{
+    num_posted ++;
+
+    while(!pending.push(command))
+    {
+        if(AUDIO_ON)
+        {
+            SDL_Delay(1);
+        }
+        else
+        {
+            apply_commands();
+        }
+    }
+
+    if(!AUDIO_ON)
+    {
+        apply_commands();
+    }
+}
+
+/*
+ * Apply waiting commands in the order they were posted.
+ */
+void Command_Queue::apply_commands()
+{
+    Command command;
+
+    while(pending.pop(&command))
+    {
+        apply_command(&command);
+        num_applied.fetch_add(1, std::memory_order_release);
+    }
+}
+
+/*
+ * Return how many commands have been posted so far. Once the audio thread has
+ * applied that many, it will never touch anything those commands refer to
+ * again.
+ */
+unsigned int Command_Queue::get_num_posted()
+{
+    return num_posted;
+}
+
+/*
+ * Return whether the audio thread has finished applying the given number of
+ * commands. The counts are compared by their difference, so that they can
+ * wrap around.
+ */
+bool Command_Queue::has_applied(unsigned int count)
+{
+    return (int) (num_applied.load(std::memory_order_acquire) - count) >= 0;
+}
+
+/*
+ * Apply a single command.
+ */
+void Command_Queue::apply_command(Command *command)
+{
+    switch(command->command_type)
+    {
+    case SET_VALUE:
+        command->module->smooth_input(command->input_num, command->val);
+        break;
+    case JUMP_VALUE:
+        command->module->jump_input(command->input_num, command->val);
+        break;
+    case NOTE_ON:
+        ((Poly *) command->module)->note_on(command->note, command->val);
+        break;
+    case NOTE_OFF:
+        ((Poly *) command->module)->note_off(command->note);
+        break;
+    case RESET_BUFFER:
+        ((Delay *) command->module)->reset_buffer();
+        break;
+    case SET_NUM_CHANNELS:
+        ((Mixer *) command->module)->processed_channels = command->input_num;
+        command->module->changed = true;
+        break;
+    }
+}
+
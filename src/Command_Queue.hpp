@@ -0,0 +1,106 @@
+/*
+ * Matthew Diamond 2016
+ * The header for the Command_Queue class. The command queue is how the main
+ * thread changes parameter values the audio thread reads while processing,
+ * without ever locking audio. The main thread posts commands, and the audio
+ * callback applies every waiting command at the start of each block. Changes
+ * to connections between modules are published as whole new execution plans
+ * instead, see Plan_Publisher. The queue is a single producer, single
+ * consumer ring buffer, so neither thread ever waits on the other. This file
+ * defines the class.
+ */
+
+#ifndef MSS_COMMAND_QUEUE_HPP
+#define MSS_COMMAND_QUEUE_HPP
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <atomic>
+
+// Forward declaration of Module class
+class Module;
+
+/**********************************
+ * COMMAND QUEUE CLASS DEFINITION *
+ **********************************/
+
+class Command_Queue
+{
+public:
+    // The most commands that can be waiting to be applied at any one time
+    static const unsigned int CAPACITY = 1024;
+
+    // Command type enum
+    enum CommandType
+    {
+        SET_VALUE = 0,
+        JUMP_VALUE,
+        NOTE_ON,
+        NOTE_OFF,
+        RESET_BUFFER,
+        SET_NUM_CHANNELS
+    };
+
+    // A struct to represent a change to be made by the audio thread, only the
+    // fields relevant to the command type are used
+    struct Command
+    {
+        CommandType command_type;
+        // The module being changed
+        Module *module = nullptr;
+        // The input being changed, or the number of channels to process
+        int input_num = 0;
+        // The value to set the input to, or the frequency of the note
+        float val = 0;
+        // The note being started or released
+        int note = 0;
+    };
+
+    // Constructor and destructor
+    Command_Queue();
+    ~Command_Queue();
+
+    // Member functions
+    //   Post a command for the audio thread to apply, called from the main
+    //   thread only
+    void post(Command);
+    //   Apply every waiting command, called from the audio thread only (or
+    //   from the main thread while audio is off)
+    void apply_commands();
+    //   Return how many commands have been posted so far, called from the
+    //   main thread only
+    unsigned int get_num_posted();
+    //   Return whether the audio thread has finished applying the given
+    //   number of commands, called from the main thread only
+    bool has_applied(unsigned int);
+
+private:
+    // A single producer, single consumer ring buffer of commands
+    struct Ring_Buffer
+    {
+        Command commands[CAPACITY];
+        std::atomic<unsigned int> read_index;
+        std::atomic<unsigned int> write_index;
+
+        Ring_Buffer();
+        bool push(const Command &);
+        bool pop(Command *);
+    };
+
+    // Commands waiting to be applied by the audio thread
+    Ring_Buffer pending;
+    // How many commands have been posted, only touched by the main thread,
+    // and how many of them the audio thread has finished applying
+    unsigned int num_posted;
+    std::atomic<unsigned int> num_applied;
+
+    // Member functions
+    //   Apply a single command
+    void apply_command(Command *);
+};
+
+#endif
+
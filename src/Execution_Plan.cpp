@@ -0,0 +1,973 @@
+/*
+ * Matthew Diamond 2016
+ * Member functions for the Execution_Plan class.
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+// Included files
+#include "main.hpp"
+#include "signal_kernels.hpp"
+
+// Included "other" classes
+#include "Execution_Plan.hpp"
+#include "Parallel_Scheduler.hpp"
+
+// Included modules classes
+#include "Module.hpp"
+
+/***********************************
+ * EXECUTION PLAN MEMBER FUNCTIONS *
+ ***********************************/
+
+/*
+ * Constructor.
+ */
+Execution_Plan::Execution_Plan() :
+    epoch(0), output(nullptr), tight_feedback(false), arena(nullptr),
+    buffer_stride(0), parallel(false)
+{}
+
+/*
+ * Destructor.
+ */
+Execution_Plan::~Execution_Plan()
+{}
+
+/*
+ * Depth first search through the inputs of the given module, finding strongly
+ * connected components with Tarjan's algorithm. Each component is either a
+ * single module that is not part of a loop, or every module in a loop. Inputs
+ * that read from the output module are not followed, the output module is
+ * never processed, so they just read silence.
+ */
+void Execution_Plan::find_components(Module *module,
+                                     Component_Search *search)
+{
+    unsigned int index = search->indices.size();
+
+    search->indices[module] = index;
+    search->low_links[module] = index;
+    search->stack.push_back(module);
+    search->on_stack.insert(module);
+
+    for(unsigned int i = 0; i < module->inputs.size(); i ++)
+    {
+        Module *src = module->inputs[i].from;
+
+        if(src == nullptr || src == output)
+        {
+            continue;
+        }
+
+        if(search->indices.find(src) == search->indices.end())
+        {
+            find_components(src, search);
+            search->low_links[module] = std::min(search->low_links[module],
+                                                 search->low_links[src]);
+        }
+        else if(search->on_stack.find(src) != search->on_stack.end())
+        {
+            search->low_links[module] = std::min(search->low_links[module],
+                                                 search->indices[src]);
+        }
+    }
+
+    // If nothing this module depends upon leads back to a module found before
+    // it, this module and everything found after it that is still on the
+    // stack make up a component
+    if(search->low_links[module] == index)
+    {
+        Module *member;
+        unsigned int component = component_members.size();
+
+        component_members.push_back(std::vector<Module *>());
+        do
+        {
+            member = search->stack.back();
+            search->stack.pop_back();
+            search->on_stack.erase(member);
+            components[member] = component;
+            component_members[component].push_back(member);
+        }
+        while(member != module);
+    }
+}
+
+/*
+ * Order the modules in each component by how many connections away from the
+ * output module they are, farthest first, since those are upstream of the
+ * rest of the loop. Modules the same distance away are ordered by their slot,
+ * which is saved along with the patch.
+ */
+void Execution_Plan::order_components()
+{
+    std::map<Module *, unsigned int> distances;
+    std::vector<Module *> queue;
+
+    // Breadth first search from the output module to find distances
+    distances[output] = 0;
+    queue.push_back(output);
+    for(unsigned int i = 0; i < queue.size(); i ++)
+    {
+        for(unsigned int j = 0; j < queue[i]->inputs.size(); j ++)
+        {
+            Module *src = queue[i]->inputs[j].from;
+            if(src != nullptr && distances.find(src) == distances.end())
+            {
+                distances[src] = distances[queue[i]] + 1;
+                queue.push_back(src);
+            }
+        }
+    }
+
+    for(unsigned int i = 0; i < component_members.size(); i ++)
+    {
+        std::sort(component_members[i].begin(), component_members[i].end(),
+                  [&distances](Module *a, Module *b)
+                  {
+                      if(distances.at(a) != distances.at(b))
+                      {
+                          return distances.at(a) > distances.at(b);
+                      }
+                      return a->number < b->number;
+                  });
+    }
+}
+
+/*
+ * Add every component that the given component depends upon to the schedule,
+ * then add the modules in the given component, in order. If the component is
+ * a loop, record where in the schedule it is.
+ */
+void Execution_Plan::schedule_component(unsigned int component,
+                                        std::vector<bool> *scheduled)
+{
+    std::vector<Module *> *members = &component_members[component];
+    bool loop = members->size() > 1;
+    unsigned int first;
+
+    (*scheduled)[component] = true;
+
+    for(unsigned int i = 0; i < members->size(); i ++)
+    {
+        Module *member = (*members)[i];
+        for(unsigned int j = 0; j < member->inputs.size(); j ++)
+        {
+            Module *src = member->inputs[j].from;
+            if(src == nullptr || src == output)
+            {
+                continue;
+            }
+
+            if(src == member)
+            {
+                loop = true;
+            }
+            else if(!(*scheduled)[components[src]])
+            {
+                schedule_component(components[src], scheduled);
+            }
+        }
+    }
+
+    first = schedule.size();
+    for(unsigned int i = 0; i < members->size(); i ++)
+    {
+        schedule_indices[(*members)[i]] = schedule.size();
+        schedule.push_back((*members)[i]);
+    }
+
+    if(loop)
+    {
+        loops.push_back({first, (unsigned int) schedule.size() - 1});
+    }
+}
+
+/*
+ * Record the source of every input of every module in the schedule, then of
+ * the output module. A connection that reads from a module at or after the
+ * reader in the schedule is a feedback connection, it can only be within a
+ * loop, since components are scheduled after everything they depend upon.
+ */
+void Execution_Plan::record_bindings()
+{
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        first_bindings.push_back(bindings.size());
+        for(unsigned int j = 0; j < schedule[i]->inputs.size(); j ++)
+        {
+            Module *src = schedule[i]->inputs[j].from;
+            bool scheduled = src != nullptr && src != output;
+            unsigned int src_index = scheduled ? schedule_indices[src] : 0;
+            bool feedback = scheduled && src_index >= i;
+
+            bindings.push_back({schedule[i], j, src,
+                                schedule[i]->inputs[j].from_output, feedback,
+                                src_index, false, false, nullptr, nullptr});
+        }
+    }
+    first_bindings.push_back(bindings.size());
+
+    for(unsigned int j = 0; j < output->inputs.size(); j ++)
+    {
+        Module *src = output->inputs[j].from;
+        bool scheduled = src != nullptr && src != output;
+
+        bindings.push_back({output, j, src, output->inputs[j].from_output,
+                            false, scheduled ? schedule_indices[src] : 0,
+                            false, false, nullptr, nullptr});
+    }
+}
+
+/*
+ * Compile the schedule for everything the given module depends upon. The
+ * given module itself is not scheduled, it is expected to be the output
+ * module, whose inputs are read directly by the audio callback.
+ */
+void Execution_Plan::compile(Module *output_)
+{
+    Component_Search search;
+    std::vector<bool> scheduled;
+
+    output = output_;
+    tight_feedback = TIGHT_FEEDBACK;
+    schedule.clear();
+    bindings.clear();
+    first_bindings.clear();
+    unscheduled.clear();
+    loops.clear();
+    feedbacks.clear();
+
+    // Find the components of everything the output module depends upon, and
+    // order the modules within them
+    for(unsigned int i = 0; i < output->inputs.size(); i ++)
+    {
+        Module *src = output->inputs[i].from;
+        if(src != nullptr && src != output
+           && search.indices.find(src) == search.indices.end())
+        {
+            find_components(src, &search);
+        }
+    }
+    order_components();
+
+    // Schedule each component after everything it depends upon
+    scheduled = std::vector<bool>(component_members.size(), false);
+    for(unsigned int i = 0; i < output->inputs.size(); i ++)
+    {
+        Module *src = output->inputs[i].from;
+        if(src != nullptr && src != output && !scheduled[components[src]])
+        {
+            schedule_component(components[src], &scheduled);
+        }
+    }
+
+    record_bindings();
+
+    // Keep track of every module that is not in the schedule, including the
+    // output module
+    for(unsigned int i = 0; i < MODULES.size(); i ++)
+    {
+        if(MODULES[i] != nullptr
+           && schedule_indices.find(MODULES[i]) == schedule_indices.end())
+        {
+            unscheduled.push_back(MODULES[i]);
+        }
+    }
+
+    calculate_dependencies();
+    infer_rates();
+    find_constant_bindings();
+    allocate_arena(assign_buffers());
+
+    // The rest of this is only needed while compiling
+    components.clear();
+    component_members.clear();
+    schedule_indices.clear();
+}
+
+/*
+ * For every connection between two scheduled modules, record that the module
+ * reading must wait for the module it reads from. Feedback connections read a
+ * copy made at the end of the previous block, so they do not have to wait for
+ * anything, which leaves the rest of the graph free of cycles. Processing in
+ * parallel gives the same result as processing the schedule in order.
+ */
+void Execution_Plan::calculate_dependencies()
+{
+    std::vector<unsigned int> path_lengths(schedule.size(), 1);
+    unsigned int longest_path = 0;
+
+    dependents = std::vector<std::vector<unsigned int>>(schedule.size());
+    num_dependencies = std::vector<unsigned int>(schedule.size(), 0);
+    pending_dependencies =
+        std::vector<std::atomic<unsigned int>>(schedule.size());
+
+    for(unsigned int i = 0; i < bindings.size(); i ++)
+    {
+        if(bindings[i].src == nullptr || bindings[i].src == output
+           || bindings[i].module == output || bindings[i].feedback)
+        {
+            continue;
+        }
+
+        unsigned int first = schedule_indices[bindings[i].src];
+        unsigned int second = schedule_indices[bindings[i].module];
+
+        // Only count each pair of modules once, even if one is connected to
+        // several inputs on the other
+        if(std::find(dependents[first].begin(), dependents[first].end(),
+                     second) == dependents[first].end())
+        {
+            dependents[first].push_back(second);
+            num_dependencies[second] ++;
+        }
+    }
+
+    // Find the longest chain of modules that must be processed one after
+    // another, since no amount of threads can process the plan any faster
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        for(unsigned int j = 0; j < dependents[i].size(); j ++)
+        {
+            path_lengths[dependents[i][j]] =
+                std::max(path_lengths[dependents[i][j]], path_lengths[i] + 1);
+        }
+        longest_path = std::max(longest_path, path_lengths[i]);
+    }
+
+    // Only bother with the parallel scheduler if the plan is big enough and
+    // wide enough on average to keep at least two threads busy, otherwise the
+    // cost of synchronizing threads outweighs the work being shared. Loops
+    // processed one sample at a time are never handed out to worker threads
+    parallel = PARALLEL_SCHEDULER != nullptr
+               && schedule.size() >= PARALLEL_MODULE_THRESHOLD
+               && schedule.size() <= Parallel_Scheduler::TASK_QUEUE_CAPACITY
+               && schedule.size() >= longest_path * 2
+               && (!tight_feedback || loops.empty());
+}
+
+/*
+ * Assign buffers to the modules in the schedule the way registers are
+ * allocated to variables. Each module's buffer is released right after the
+ * last module in the schedule that reads it, so that the next module to need
+ * a buffer can reuse it. When loops are processed one sample at a time, every
+ * module in a loop counts as reading at the end of the loop. A module gets a
+ * buffer that is never shared if:
+ *   - its output is read by the output module, since the audio callback reads
+ *     it after the whole schedule is done
+ *   - its output is read by a feedback connection, since it is copied once
+ *     the whole schedule is done
+ *   - it displays its output in a waveform, since that is drawn whenever the
+ *     main thread gets to it
+ *   - the plan is processed in parallel, since then the schedule does not say
+ *     which module finishes first
+ * A static module whose buffer is shared stops being static, since the next
+ * module to output into its buffer overwrites what would be reused, and so
+ * does every static module that reads it.
+ */
+unsigned int Execution_Plan::assign_buffers()
+{
+    std::vector<unsigned int> last_reads(schedule.size());
+    std::vector<unsigned int> read_positions(schedule.size());
+    std::vector<std::vector<unsigned int>> releases(schedule.size());
+    std::vector<unsigned int> free_buffers;
+    unsigned int num_buffers = 0;
+
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        last_reads[i] = i;
+        read_positions[i] = i;
+        if(parallel || schedule[i]->graphics_objects_initialized)
+        {
+            last_reads[i] = schedule.size();
+        }
+    }
+
+    if(tight_feedback)
+    {
+        for(unsigned int i = 0; i < loops.size(); i ++)
+        {
+            for(unsigned int j = loops[i].first; j <= loops[i].last; j ++)
+            {
+                read_positions[j] = loops[i].last;
+            }
+        }
+    }
+
+    // Find the last module to read each buffer, a module that is read by the
+    // output module or by a feedback connection is read after everything in
+    // the schedule
+    for(unsigned int i = 0; i < bindings.size(); i ++)
+    {
+        if(bindings[i].src == nullptr || bindings[i].src == output)
+        {
+            continue;
+        }
+
+        unsigned int src_index = schedule_indices[bindings[i].src];
+        unsigned int read_position = schedule.size();
+        if(bindings[i].module != output && !bindings[i].feedback)
+        {
+            read_position =
+                read_positions[schedule_indices[bindings[i].module]];
+        }
+
+        last_reads[src_index] = std::max(last_reads[src_index],
+                                         read_position);
+    }
+
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        if(last_reads[i] < schedule.size())
+        {
+            releases[last_reads[i]].push_back(i);
+        }
+    }
+
+    // Walk the schedule, giving each module a free buffer if there is one,
+    // then releasing the buffers it was the last to read. Releasing only
+    // after the module has its own buffer makes sure that it never outputs
+    // into a buffer it is reading from
+    buffer_indices = std::vector<unsigned int>(schedule.size());
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        if(free_buffers.empty())
+        {
+            buffer_indices[i] = num_buffers ++;
+        }
+        else
+        {
+            buffer_indices[i] = free_buffers.back();
+            free_buffers.pop_back();
+        }
+
+        for(unsigned int j = 0; j < releases[i].size(); j ++)
+        {
+            free_buffers.push_back(buffer_indices[releases[i][j]]);
+        }
+    }
+
+    std::vector<unsigned int> buffer_users(num_buffers, 0);
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        buffer_users[buffer_indices[i]] ++;
+    }
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        if(buffer_users[buffer_indices[i]] > 1)
+        {
+            static_modules[i] = false;
+        }
+        for(unsigned int k = first_bindings[i]; k < first_bindings[i + 1];
+            k ++)
+        {
+            if(bindings[k].src != nullptr && bindings[k].src != output
+               && !static_modules[bindings[k].src_index])
+            {
+                static_modules[i] = false;
+            }
+        }
+    }
+
+    return num_buffers;
+}
+
+/*
+ * Allocate the whole arena at once, with room to spare so that the first
+ * buffer can be aligned, and with a copy after the assigned buffers for each
+ * module read by a feedback connection. Each buffer is padded out to a
+ * multiple of the alignment, so that every buffer after the first is aligned
+ * as well. The arena starts out silent. Once the arena is allocated, work out
+ * which buffer every binding reads, which for any output besides a module's
+ * main output is owned by the module.
+ */
+void Execution_Plan::allocate_arena(unsigned int num_buffers)
+{
+    unsigned int samples_per_alignment = BUFFER_ALIGNMENT / sizeof(float);
+    std::map<std::pair<Module *, unsigned int>, unsigned int> copy_indices;
+    uintptr_t address;
+
+    for(unsigned int i = 0; i < bindings.size(); i ++)
+    {
+        std::pair<Module *, unsigned int> src(bindings[i].src,
+                                              bindings[i].src_output);
+
+        if(bindings[i].feedback && copy_indices.find(src) == copy_indices.end())
+        {
+            unsigned int copy_index = num_buffers + copy_indices.size();
+            copy_indices[src] = copy_index;
+        }
+    }
+
+    buffer_stride = ((BUFFER_SIZE + samples_per_alignment - 1)
+                     / samples_per_alignment) * samples_per_alignment;
+    arena_memory = std::vector<float>(buffer_stride
+                                      * (num_buffers + copy_indices.size())
+                                      + samples_per_alignment);
+
+    address = (uintptr_t) &arena_memory[0];
+    address = (address + BUFFER_ALIGNMENT - 1)
+              & ~((uintptr_t) BUFFER_ALIGNMENT - 1);
+    arena = (float *) address;
+
+    for(unsigned int i = 0; i < bindings.size(); i ++)
+    {
+        Module *src = bindings[i].src;
+
+        if(src == nullptr)
+        {
+            continue;
+        }
+        else if(src == output)
+        {
+            bindings[i].src_buffer = silence();
+            bindings[i].buffer = silence();
+            continue;
+        }
+
+        bindings[i].src_buffer =
+            arena + buffer_indices[schedule_indices[src]] * buffer_stride;
+        if(bindings[i].src_output != 0)
+        {
+            bindings[i].src_buffer =
+                src->extra_buffers[bindings[i].src_output - 1].data();
+        }
+        bindings[i].buffer = bindings[i].src_buffer;
+        if(bindings[i].feedback)
+        {
+            unsigned int copy_index =
+                copy_indices[{src, bindings[i].src_output}];
+
+            bindings[i].buffer = arena + copy_index * buffer_stride;
+            if(copy_index == num_buffers + feedbacks.size())
+            {
+                feedbacks.push_back({bindings[i].src_buffer,
+                                     bindings[i].buffer});
+            }
+        }
+    }
+}
+
+/*
+ * Decide which modules in the schedule may be calculated at control rate.
+ * None may be if the control period is a single sample. Modules processed one
+ * sample at a time in a tight feedback loop never are, and neither is any
+ * module read by an input that needs every sample, including every input of
+ * the output module. Whether a module that may be calculated at control rate
+ * actually is depends on the module, see Module::rate.
+ */
+void Execution_Plan::infer_rates()
+{
+    control_rates = std::vector<bool>(schedule.size(), CONTROL_PERIOD > 1);
+
+    if(tight_feedback)
+    {
+        for(unsigned int i = 0; i < loops.size(); i ++)
+        {
+            for(unsigned int j = loops[i].first; j <= loops[i].last; j ++)
+            {
+                control_rates[j] = false;
+            }
+        }
+    }
+
+    for(unsigned int i = 0; i < bindings.size(); i ++)
+    {
+        if(bindings[i].src != nullptr && bindings[i].src != output
+           && !bindings[i].module->reads_control_rate(bindings[i].input_num))
+        {
+            control_rates[schedule_indices[bindings[i].src]] = false;
+        }
+    }
+}
+
+/*
+ * Decide which inputs know when the output they read is constant for a block,
+ * which is any input reading the main output of a module in the schedule,
+ * except through a feedback connection, which reads the previous block, or
+ * from a loop processed one sample at a time. Of those, the inputs that can read a signal
+ * calculated at control rate read a constant output as a value instead.
+ * Modules in a loop never go dormant, since a feedback connection may read
+ * them after the rest of the block is decided, and neither do modules whose
+ * state has to keep up with their inputs. A module outside of any loop is
+ * static if each of its inputs reads nothing, silence from the output module,
+ * or another static module, which is always earlier in the schedule, as long
+ * as it keeps its buffer to itself, see assign_buffers().
+ */
+void Execution_Plan::find_constant_bindings()
+{
+    std::vector<bool> looped(schedule.size(), false);
+
+    for(unsigned int i = 0; i < loops.size(); i ++)
+    {
+        for(unsigned int j = loops[i].first; j <= loops[i].last; j ++)
+        {
+            looped[j] = true;
+        }
+    }
+
+    for(unsigned int i = 0; i < bindings.size(); i ++)
+    {
+        Binding *binding = &bindings[i];
+
+        binding->tracked = binding->src != nullptr && binding->src != output
+                           && binding->src_output == 0 && !binding->feedback
+                           && binding->module != output
+                           && !(tight_feedback && looped[binding->src_index]);
+        binding->foldable = binding->tracked
+                            && binding->module->reads_control_rate(
+                                   binding->input_num);
+    }
+
+    constant_tracked = std::vector<bool>(schedule.size(), false);
+    for(unsigned int i = 0; i < bindings.size(); i ++)
+    {
+        if(bindings[i].tracked)
+        {
+            constant_tracked[bindings[i].src_index] = true;
+        }
+    }
+
+    dormant_candidates = std::vector<bool>(schedule.size(), false);
+    dormant = std::vector<bool>(schedule.size(), false);
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        dormant_candidates[i] = !looped[i] && schedule[i]->can_go_dormant();
+    }
+
+    static_modules = std::vector<bool>(schedule.size(), false);
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        static_modules[i] = !looped[i];
+        for(unsigned int k = first_bindings[i]; k < first_bindings[i + 1];
+            k ++)
+        {
+            if(bindings[k].src != nullptr && bindings[k].src != output
+               && (bindings[k].feedback
+                   || !static_modules[bindings[k].src_index]))
+            {
+                static_modules[i] = false;
+            }
+        }
+    }
+}
+
+/*
+ * Point the output of every module in this plan at its buffer in the arena,
+ * and the output of every other module at silence, and tell each module the
+ * rate it may be calculated at and whether or not it is processed. Nothing
+ * has been output to the arena yet, so there is no output to reuse. A module
+ * that is not processed would never finish smoothing its inputs, so they are
+ * set to their targets. Then point the inputs of every module in this
+ * plan at the buffers they read from. This must be done by the audio thread
+ * before processing with this plan for the first time.
+ */
+void Execution_Plan::bind()
+{
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        schedule[i]->out = arena + buffer_indices[i] * buffer_stride;
+        schedule[i]->rate = control_rates[i] ? Module::CONTROL_RATE
+                                             : Module::AUDIO_RATE;
+        schedule[i]->scheduled = true;
+        schedule[i]->output_cached = false;
+        schedule[i]->output_reused = false;
+    }
+
+    for(unsigned int i = 0; i < unscheduled.size(); i ++)
+    {
+        unscheduled[i]->out = silence();
+        unscheduled[i]->rate = Module::AUDIO_RATE;
+        unscheduled[i]->scheduled = false;
+        unscheduled[i]->stop_smoothing();
+    }
+
+    for(unsigned int i = 0; i < bindings.size(); i ++)
+    {
+        Module::Parameter *input =
+            &bindings[i].module->inputs[bindings[i].input_num];
+
+        input->in = bindings[i].buffer;
+        input->live = bindings[i].src != nullptr;
+        input->constant = false;
+    }
+}
+
+/*
+ * Process every module in the schedule. First, point the inputs being
+ * smoothed at their ramps, and decide which modules are dormant. Since the
+ * schedule is topologically sorted, the output buffers of all dependencies
+ * will already be filled by the time each module is processed. If this plan
+ * is worth processing in parallel, hand it to the parallel scheduler instead.
+ * Once everything is processed, leave the inputs being smoothed where their
+ * ramps got to, and copy the output of every module read by a feedback
+ * connection, for the next block to read.
+ */
+void Execution_Plan::process()
+{
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        schedule[i]->start_smoothing(BUFFER_SIZE);
+    }
+    find_dormant_modules();
+
+    if(parallel)
+    {
+        PARALLEL_SCHEDULER->process(this);
+    }
+    else
+    {
+        unsigned int next_loop = 0;
+
+        for(unsigned int i = 0; i < schedule.size(); i ++)
+        {
+            if(tight_feedback && next_loop < loops.size()
+               && loops[next_loop].first == i)
+            {
+                process_loop_tightly(loops[next_loop]);
+                i = loops[next_loop].last;
+                next_loop ++;
+            }
+            else
+            {
+                process_module(i);
+            }
+        }
+    }
+
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        schedule[i]->finish_smoothing(BUFFER_SIZE);
+    }
+
+    for(unsigned int i = 0; i < feedbacks.size(); i ++)
+    {
+        copy_samples(feedbacks[i].src_buffer, feedbacks[i].buffer,
+                     BUFFER_SIZE);
+    }
+}
+
+/*
+ * Decide which modules are dormant for the next block. Walking the schedule
+ * from back to front, every module that may go dormant is dormant unless a
+ * module after it that is not dormant, or the output module, reads it. Each
+ * module decides which of its inputs it reads given its current parameters.
+ */
+void Execution_Plan::find_dormant_modules()
+{
+    for(unsigned int i = 0; i < schedule.size(); i ++)
+    {
+        dormant[i] = dormant_candidates[i];
+    }
+
+    for(unsigned int k = first_bindings.back(); k < bindings.size(); k ++)
+    {
+        if(bindings[k].src != nullptr && bindings[k].src != output)
+        {
+            dormant[bindings[k].src_index] = false;
+        }
+    }
+
+    for(unsigned int i = schedule.size(); i -- > 0;)
+    {
+        if(dormant[i])
+        {
+            continue;
+        }
+
+        for(unsigned int k = first_bindings[i]; k < first_bindings[i + 1];
+            k ++)
+        {
+            if(bindings[k].src != nullptr && bindings[k].src != output
+               && schedule[i]->reads_input(bindings[k].input_num))
+            {
+                dormant[bindings[k].src_index] = false;
+            }
+        }
+    }
+}
+
+/*
+ * Process the module at the given index in the schedule for a whole block. A
+ * dormant module only moves its state on by the block and fills its output
+ * buffers with silence. A static module whose inputs and settings are the same
+ * as during the last block, and whose sources all reused their outputs, is
+ * left with the output it already has if that output has settled. Otherwise,
+ * every input reading a constant output as a value takes the first sample of
+ * that output as its value for the block, and goes back to reading the output
+ * once the module is processed. Then, if anything tracks it, note whether or
+ * not the module's own output was constant, and if the module is static,
+ * whether or not its output has settled, which it only can have after a
+ * block in which nothing changed.
+ */
+void Execution_Plan::process_module(unsigned int i)
+{
+    Module *module = schedule[i];
+    bool unchanged = false;
+
+    if(dormant[i])
+    {
+        module->skip(BUFFER_SIZE);
+        std::fill(module->out, module->out + BUFFER_SIZE, 0);
+        for(unsigned int k = 0; k < module->extra_outs.size(); k ++)
+        {
+            std::fill(module->extra_outs[k],
+                      module->extra_outs[k] + BUFFER_SIZE, 0);
+        }
+        module->output_constant = true;
+        module->output_cached = false;
+        module->output_reused = false;
+        return;
+    }
+
+    if(static_modules[i])
+    {
+        unchanged = !module->changed.exchange(false)
+                    && module->smoothed_inputs.empty();
+        for(unsigned int k = first_bindings[i]; k < first_bindings[i + 1];
+            k ++)
+        {
+            if(bindings[k].src != nullptr && bindings[k].src != output
+               && !bindings[k].src->output_reused)
+            {
+                unchanged = false;
+            }
+        }
+
+        module->output_reused = unchanged && module->output_cached;
+        if(module->output_reused)
+        {
+            return;
+        }
+    }
+
+    for(unsigned int k = first_bindings[i]; k < first_bindings[i + 1]; k ++)
+    {
+        if(bindings[k].tracked)
+        {
+            Module::Parameter *input =
+                &module->inputs[bindings[k].input_num];
+
+            input->constant = bindings[k].src->output_constant;
+            if(input->constant && bindings[k].foldable)
+            {
+                input->val = bindings[k].buffer[0];
+                input->live = false;
+            }
+        }
+    }
+
+    module->process(BUFFER_SIZE);
+
+    for(unsigned int k = first_bindings[i]; k < first_bindings[i + 1]; k ++)
+    {
+        if(bindings[k].foldable)
+        {
+            module->inputs[bindings[k].input_num].live = true;
+        }
+    }
+
+    if(constant_tracked[i])
+    {
+        module->output_constant = is_constant(module->out, BUFFER_SIZE);
+    }
+    if(static_modules[i])
+    {
+        module->output_cached = unchanged && module->output_static();
+    }
+}
+
+/*
+ * Process the modules in a loop one sample at a time, pointing all of their
+ * outputs and their inputs at the current sample before processing each one. Feedback
+ * connections read the previous sample instead, which for the first sample is
+ * the last sample of the previous block. Once the loop is done, point
+ * everything back at the start of its buffer.
+ */
+void Execution_Plan::process_loop_tightly(const Loop &loop)
+{
+    for(unsigned int i = 0; i < BUFFER_SIZE; i ++)
+    {
+        for(unsigned int j = loop.first; j <= loop.last; j ++)
+        {
+            Module *module = schedule[j];
+
+            module->out = arena + buffer_indices[j] * buffer_stride + i;
+            for(unsigned int k = 0; k < module->extra_outs.size(); k ++)
+            {
+                module->extra_outs[k] = module->extra_buffers[k].data() + i;
+            }
+            for(unsigned int k = first_bindings[j];
+                k < first_bindings[j + 1]; k ++)
+            {
+                Binding *binding = &bindings[k];
+                float **in = &module->inputs[binding->input_num].in;
+
+                if(binding->src == nullptr)
+                {
+                    continue;
+                }
+                else if(!binding->feedback)
+                {
+                    *in = binding->buffer + i;
+                }
+                else if(i == 0)
+                {
+                    *in = binding->buffer + BUFFER_SIZE - 1;
+                }
+                else
+                {
+                    *in = binding->src_buffer + i - 1;
+                }
+            }
+            for(unsigned int k = 0; k < module->smoothed_inputs.size(); k ++)
+            {
+                Module::Parameter *input =
+                    &module->inputs[module->smoothed_inputs[k]];
+
+                input->in = input->ramp + i;
+            }
+
+            module->process(1);
+        }
+    }
+
+    for(unsigned int j = loop.first; j <= loop.last; j ++)
+    {
+        schedule[j]->out = arena + buffer_indices[j] * buffer_stride;
+        for(unsigned int k = 0; k < schedule[j]->extra_outs.size(); k ++)
+        {
+            schedule[j]->extra_outs[k] = schedule[j]->extra_buffers[k].data();
+        }
+        for(unsigned int k = first_bindings[j]; k < first_bindings[j + 1];
+            k ++)
+        {
+            schedule[j]->inputs[bindings[k].input_num].in = bindings[k].buffer;
+        }
+    }
+}
+
+/*
+ * Return a buffer of silence, shared by every module that is not in the plan
+ * currently in use. Nothing ever processes those modules, so it stays silent.
+ */
+float *Execution_Plan::silence()
+{
+    static std::vector<float> silent_buffer(BUFFER_SIZE);
+
+    return &silent_buffer[0];
+}
+
@@ -0,0 +1,242 @@
+/*
+ * Matthew Diamond 2016
+ * The header for the Execution_Plan class. An execution plan is a flat,
+ * topologically sorted list of the modules that the output module depends
+ * upon. It is compiled whenever the connections between modules change, and
+ * the audio callback simply walks it from front to back, so every module is
+ * guaranteed to be processed after all of the modules it depends upon. The
+ * plan also records which modules must wait on which, so that it can be
+ * handed to the parallel scheduler instead. Once compiled, a plan is never
+ * changed, it is a snapshot of the graph that includes which module each
+ * input reads from, so the audio thread never looks at connections being
+ * edited by the main thread. The plan also owns the output buffers of every
+ * module it schedules, laid out one after another in a single aligned arena,
+ * so that compiling a plan allocates memory only once. When the schedule is
+ * processed in order, a buffer that nothing will read again for the rest of
+ * the block is handed on to the next module, so the arena only needs about as
+ * many buffers as the graph is wide.
+ *
+ * Modules that feed back into each other form a loop, found as a strongly
+ * connected component of the graph. Within a loop, modules are ordered by how
+ * far they are from the output module, farthest first, and any connection
+ * that reads from a module at or after the reader in that order is a
+ * feedback connection. A feedback connection reads a copy of its source's
+ * output from the previous block, so the result never depends on the order in
+ * which modules were created or connected. With tight feedback on, the
+ * modules in a loop are processed one sample at a time instead, and feedback
+ * connections read the previous sample.
+ *
+ * The plan also decides the rate at which each module it schedules may be
+ * calculated. A module that only modulates other modules, such as a slow LFO
+ * driving a filter cutoff, may calculate a point once every control period
+ * and interpolate in between, so the modules reading it still get a full
+ * buffer.
+ *
+ * After a module that another module tracks is processed, the plan notes
+ * whether its output was constant for the block. An input that reads a
+ * constant output as a value instead of a buffer takes its first sample as
+ * that value for the block, so the module reading it can take the same
+ * shortcuts as when it is not connected at all, and a module whose signal is
+ * silent can skip its work. Modules that nothing will read during a block,
+ * such as the sources of a mixer channel turned all the way down, go dormant,
+ * and fill their output buffers with silence instead of being processed.
+ * Modules that only read other such modules, or nothing at all, such as an
+ * oscillator at 0 Hz used as a DC offset, are static, and once their output
+ * has settled it is kept and reused every block until something they depend
+ * upon changes. This file defines the class.
+ */
+
+#ifndef MSS_EXECUTION_PLAN_HPP
+#define MSS_EXECUTION_PLAN_HPP
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <atomic>
+#include <map>
+#include <set>
+#include <vector>
+
+// Forward declaration of Module class
+class Module;
+
+/***********************************
+ * EXECUTION PLAN CLASS DEFINITION *
+ ***********************************/
+
+class Execution_Plan
+{
+public:
+    // The number of bytes each output buffer in the arena is aligned to
+    static const unsigned int BUFFER_ALIGNMENT = 64;
+
+    // A struct to represent the module an input reads from when this plan is
+    // in use, or nullptr if it reads a constant value, and which of its
+    // outputs, along with the buffer it reads during a block, and whether or
+    // not it is a feedback connection
+    struct Binding
+    {
+        Module *module;
+        unsigned int input_num;
+        Module *src;
+        unsigned int src_output;
+        bool feedback;
+        // The index of the source in the schedule, if it is in the schedule
+        unsigned int src_index;
+        // Whether or not the input knows when the source's output is constant
+        // for a block, and whether or not it then reads it as a value, see
+        // find_constant_bindings()
+        bool tracked;
+        bool foldable;
+        // The buffer read during a block, which for a feedback connection is
+        // the copy of the source's output from the previous block
+        float *buffer;
+        // The source's own output buffer
+        float *src_buffer;
+    };
+
+    // A struct to represent a copy of a module's output, made at the end of
+    // every block for feedback connections to read during the next block
+    struct Feedback
+    {
+        float *src_buffer;
+        float *buffer;
+    };
+
+    // A struct to represent a feedback loop, the modules from first to last
+    // in the schedule, inclusive
+    struct Loop
+    {
+        unsigned int first;
+        unsigned int last;
+    };
+
+    // The order in which this plan was published
+    unsigned int epoch;
+    // The output module whose inputs are read once the schedule is processed
+    Module *output;
+    // The modules to process, in the order in which they must be processed
+    std::vector<Module *> schedule;
+    // For each module in the schedule, the schedule indices of the modules
+    // that may not be processed until it has been
+    std::vector<std::vector<unsigned int>> dependents;
+    // For each module in the schedule, how many modules it must wait for
+    std::vector<unsigned int> num_dependencies;
+    // For each module in the schedule, how many modules it is still waiting
+    // for in the block currently being processed by the parallel scheduler
+    std::vector<std::atomic<unsigned int>> pending_dependencies;
+    // The source of every input of every module in the schedule, in schedule
+    // order, followed by the inputs of the output module
+    std::vector<Binding> bindings;
+    // For each module in the schedule, the index of its first binding,
+    // followed by the index of the first binding of the output module, so
+    // that the bindings of module i end where those of module i + 1 begin
+    std::vector<unsigned int> first_bindings;
+    // Every other module in the graph, whose output buffers are pointed at
+    // silence while this plan is in use
+    std::vector<Module *> unscheduled;
+    // Every feedback loop in the schedule, in schedule order
+    std::vector<Loop> loops;
+    // Whether or not the modules in each loop are processed one sample at a
+    // time
+    bool tight_feedback;
+    // The output copies read by feedback connections
+    std::vector<Feedback> feedbacks;
+    // The output buffers of the modules in the schedule, and the number of
+    // samples from the start of one to the start of the next
+    float *arena;
+    unsigned int buffer_stride;
+    // For each module in the schedule, which buffer in the arena it outputs
+    // to
+    std::vector<unsigned int> buffer_indices;
+    // Whether or not this plan is worth processing in parallel
+    bool parallel;
+    // For each module in the schedule, whether or not its output may be
+    // calculated at control rate, because every input reading it can do
+    // without every sample
+    std::vector<bool> control_rates;
+    // For each module in the schedule, whether or not it may go dormant, and
+    // whether or not it is dormant for the block currently being processed,
+    // because nothing reads its output
+    std::vector<bool> dormant_candidates;
+    std::vector<bool> dormant;
+    // For each module in the schedule, whether or not any input tracks
+    // whether its output is constant, so that it is worth checking
+    std::vector<bool> constant_tracked;
+    // For each module in the schedule, whether or not every input either
+    // reads nothing or reads another static module, and its buffer is its
+    // own, so that its output can be reused, see process_module()
+    std::vector<bool> static_modules;
+
+    // Constructor and destructor
+    Execution_Plan();
+    ~Execution_Plan();
+
+    // Member functions
+    //   Compile the schedule for all modules that the given module depends
+    //   upon
+    void compile(Module *);
+    //   Point every input of every module in this plan at its source
+    void bind();
+    //   Process every module in the schedule, in order
+    void process();
+    //   Process a single module in the schedule, given its index
+    void process_module(unsigned int);
+    //   Return a buffer of silence, for modules that are not in the plan in
+    //   use, which must never be written to
+    static float *silence();
+
+private:
+    // The state of the search for strongly connected components
+    struct Component_Search
+    {
+        std::map<Module *, unsigned int> indices;
+        std::map<Module *, unsigned int> low_links;
+        std::vector<Module *> stack;
+        std::set<Module *> on_stack;
+    };
+
+    // The memory the arena is carved out of
+    std::vector<float> arena_memory;
+    // Which strongly connected component each module belongs to, and the
+    // modules in each component, only used while compiling
+    std::map<Module *, unsigned int> components;
+    std::vector<std::vector<Module *>> component_members;
+    // The index of each module in the schedule, only used while compiling
+    std::map<Module *, unsigned int> schedule_indices;
+
+    // Member functions
+    //   Find the strongly connected component of a module and of everything
+    //   it depends upon
+    void find_components(Module *, Component_Search *);
+    //   Order the modules within each component, farthest from the output
+    //   module first
+    void order_components();
+    //   Add a component to the schedule after all of its dependencies
+    void schedule_component(unsigned int, std::vector<bool> *);
+    //   Record the source of every input, and which are feedback connections
+    void record_bindings();
+    //   Determine which modules must wait on which, and whether or not there
+    //   is enough independent work to make processing in parallel worthwhile
+    void calculate_dependencies();
+    //   Decide which modules in the schedule may be calculated at control rate
+    void infer_rates();
+    //   Decide which inputs know when their sources' outputs are constant,
+    //   which modules may go dormant, and which are static
+    void find_constant_bindings();
+    //   Decide which modules are dormant for the next block
+    void find_dormant_modules();
+    //   Decide which buffer each module in the schedule outputs to, return the
+    //   number of buffers needed
+    unsigned int assign_buffers();
+    //   Allocate every buffer in the arena, and the copies for feedback
+    //   connections after them, then work out which buffer each binding reads
+    void allocate_arena(unsigned int);
+    //   Process the modules in a loop one sample at a time
+    void process_loop_tightly(const Loop &);
+};
+
+#endif
+
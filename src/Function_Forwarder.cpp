@@ -76,17 +76,21 @@ bool Function_Forwarder::handle_event(Graphics_Object *g)
     }
     else if(g->name == possible_names[8])
     {
-        increment_page_number(-1);
+        create_module(Module::POLY);
     }
     else if(g->name == possible_names[9])
     {
-        increment_page_number(1);
+        increment_page_number(-1);
     }
     else if(g->name == possible_names[10])
     {
-        save_patch(((Text_Box *) g)->text.text);
+        increment_page_number(1);
     }
     else if(g->name == possible_names[11])
+    {
+        save_patch(((Text_Box *) g)->text.text);
+    }
+    else if(g->name == possible_names[12])
     {
         load_patch(((Text_Box *) g)->text.text);
     }
@@ -36,8 +36,9 @@ private:
     std::vector<std::string> possible_names =
         {"add adsr button", "add delay button", "add filter button",
          "add mixer button", "add multiplier button", "add noise button",
-         "add oscillator button", "add sah button", "previous page button",
-         "next page button", "save patch text box", "load patch text box"
+         "add oscillator button", "add sah button", "add poly button",
+         "previous page button", "next page button", "save patch text box",
+         "load patch text box"
         };
 };
 
@@ -0,0 +1,333 @@
+/*
+ * Matthew Diamond 2016
+ * Member functions for the Parallel_Scheduler class.
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Included files
+#include "main.hpp"
+
+// Included "other" classes
+#include "Execution_Plan.hpp"
+#include "Parallel_Scheduler.hpp"
+
+// Included modules classes
+#include "Module.hpp"
+
+/*******************************
+ * TASK QUEUE MEMBER FUNCTIONS *
+ *******************************/
+
+/*
+ * Constructor.
+ */
+Parallel_Scheduler::Task_Queue::Task_Queue() :
+    front(0), back(0)
+{}
+
+/*
+ * Push a task onto the back of the queue, called by the thread that owns the
+ * queue only. The task is written before the back moves past it, so a thief
+ * that sees the new back sees the task too. Every task is pushed at most once
+ * per block, so the queue never holds more than its capacity.
+ */
+void Parallel_Scheduler::Task_Queue::push(unsigned int task)
+{
+    int64_t b = back.load(std::memory_order_relaxed);
+
+    tasks[b % TASK_QUEUE_CAPACITY].store(task, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    back.store(b + 1, std::memory_order_relaxed);
+}
+
+/*
+ * Pop the most recently pushed task off of the back of the queue, called by
+ * the thread that owns the queue only. The back is moved first, so that
+ * thieves stop short of the task being popped, unless it is the last one, in
+ * which case the owner races them for it by moving the front instead. Return
+ * true if a task was popped, false if the queue was empty or a thief got the
+ * last task first.
+ */
+bool Parallel_Scheduler::Task_Queue::pop(unsigned int *task)
+{
+    int64_t b = back.load(std::memory_order_relaxed) - 1;
+    int64_t f;
+    bool popped = true;
+
+    back.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    f = front.load(std::memory_order_relaxed);
+
+    if(f > b)
+    {
+        back.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    *task = tasks[b % TASK_QUEUE_CAPACITY].load(std::memory_order_relaxed);
+    if(f == b)
+    {
+        popped = front.compare_exchange_strong(f, f + 1,
+                                               std::memory_order_seq_cst,
+                                               std::memory_order_relaxed);
+        back.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return popped;
+}
+
+/*
+ * Take the oldest task off of the front of the queue, called by any thread
+ * but the one that owns the queue. The task is only taken if no other thread
+ * moved the front in the meantime. Return true if a task was stolen, false if
+ * the queue was empty or another thread took the task first.
+ */
+bool Parallel_Scheduler::Task_Queue::steal(unsigned int *task)
+{
+    int64_t f = front.load(std::memory_order_acquire);
+    int64_t b;
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    b = back.load(std::memory_order_acquire);
+    if(f >= b)
+    {
+        return false;
+    }
+
+    *task = tasks[f % TASK_QUEUE_CAPACITY].load(std::memory_order_relaxed);
+
+    return front.compare_exchange_strong(f, f + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed);
+}
+
+/***************************************
+ * PARALLEL SCHEDULER MEMBER FUNCTIONS *
+ ***************************************/
+
+/*
+ * Constructor. Start the given number of worker threads.
+ */
+Parallel_Scheduler::Parallel_Scheduler(unsigned int num_workers_) :
+    num_workers(num_workers_), task_queues(new Task_Queue[num_workers_ + 1]),
+    current_plan(nullptr), remaining_tasks(0), active_workers(0),
+    generation(0), quit(false)
+{
+    for(unsigned int i = 1; i <= num_workers; i ++)
+    {
+        threads.push_back(std::thread(&Parallel_Scheduler::worker, this, i));
+        configure_thread(i);
+    }
+
+    std::cout << "Parallel scheduler started with " << num_workers
+              << " worker threads" << std::endl;
+}
+
+/*
+ * Destructor. Wake up every worker thread, tell them to exit, and wait for
+ * them to do so.
+ */
+Parallel_Scheduler::~Parallel_Scheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        quit = true;
+    }
+    wake_condition.notify_all();
+
+    for(unsigned int i = 0; i < threads.size(); i ++)
+    {
+        threads[i].join();
+    }
+
+    delete[] task_queues;
+}
+
+/*
+ * Pin worker thread i to its own core, leaving the first core to the audio
+ * thread, and ask for real time scheduling. Neither is guaranteed to be
+ * allowed, so failure is reported but otherwise ignored.
+ */
+void Parallel_Scheduler::configure_thread(unsigned int i)
+{
+#ifdef __linux__
+    pthread_t handle = threads[i - 1].native_handle();
+    unsigned int num_cores = std::thread::hardware_concurrency();
+    cpu_set_t cpu_set;
+    sched_param param;
+
+    if(num_cores > 1)
+    {
+        CPU_ZERO(&cpu_set);
+        CPU_SET(i % num_cores, &cpu_set);
+        if(pthread_setaffinity_np(handle, sizeof(cpu_set_t), &cpu_set) != 0)
+        {
+            std::cout << RED_STDOUT << "Could not pin worker thread " << i
+                      << DEFAULT_STDOUT << std::endl;
+        }
+    }
+
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO) - 1;
+    if(pthread_setschedparam(handle, SCHED_FIFO, &param) != 0)
+    {
+        std::cout << RED_STDOUT << "Could not raise priority of worker thread "
+                  << i << DEFAULT_STDOUT << std::endl;
+    }
+#else
+    (void) i;
+#endif
+}
+
+/*
+ * Try to steal a task from every task queue other than the one belonging to
+ * thread i. Return true if a task was stolen, false otherwise.
+ */
+bool Parallel_Scheduler::steal(unsigned int i, unsigned int *task)
+{
+    for(unsigned int j = 1; j <= num_workers; j ++)
+    {
+        if(task_queues[(i + j) % (num_workers + 1)].steal(task))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Process modules until none remain in this block. Each time a module is
+ * processed, the dependency counters of the modules that wait on it are
+ * decremented, and any module left with no outstanding dependencies is pushed
+ * onto this thread's own task queue.
+ */
+void Parallel_Scheduler::run_tasks(unsigned int i)
+{
+    unsigned int task;
+
+    while(remaining_tasks.load() > 0)
+    {
+        if(task_queues[i].pop(&task) || steal(i, &task))
+        {
+            Execution_Plan *plan = current_plan.load();
+
+            plan->process_module(task);
+
+            for(unsigned int j = 0; j < plan->dependents[task].size(); j ++)
+            {
+                unsigned int dependent = plan->dependents[task][j];
+                if(plan->pending_dependencies[dependent].fetch_sub(1) == 1)
+                {
+                    task_queues[i].push(dependent);
+                }
+            }
+
+            remaining_tasks.fetch_sub(1);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/*
+ * The main loop of worker thread i. Wait for a new block, help process it,
+ * then go back to waiting. Waiting starts with a short spin, since blocks
+ * often arrive back to back, before going to sleep.
+ */
+void Parallel_Scheduler::worker(unsigned int i)
+{
+    unsigned int last_generation = 0;
+
+    while(true)
+    {
+        for(unsigned int spins = 0; spins < 1000
+            && generation.load() == last_generation && !quit; spins ++)
+        {
+            std::this_thread::yield();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            wake_condition.wait(lock, [&]
+            {
+                return generation.load() != last_generation || quit;
+            });
+        }
+
+        if(quit)
+        {
+            return;
+        }
+
+        last_generation = generation.load();
+
+        active_workers.fetch_add(1);
+        run_tasks(i);
+        active_workers.fetch_sub(1);
+    }
+}
+
+/*
+ * Process a block of audio with the given plan. The dependency counters are
+ * reset, every module with no dependencies is handed out to the task queues,
+ * and the workers are woken up. The audio thread then helps process the block
+ * itself, and finally waits until no worker is still touching the plan. Only
+ * the owner of a task queue may push onto it, but no worker looks at any
+ * queue between blocks, so the audio thread can push for all of them before
+ * waking them.
+ */
+void Parallel_Scheduler::process(Execution_Plan *plan)
+{
+    current_plan.store(plan);
+
+    for(unsigned int i = 0; i < plan->schedule.size(); i ++)
+    {
+        plan->pending_dependencies[i].store(plan->num_dependencies[i]);
+    }
+
+    // The count of remaining tasks must be set before any task is visible to
+    // a worker thread
+    remaining_tasks.store(plan->schedule.size());
+
+    unsigned int next_queue = 0;
+    for(unsigned int i = 0; i < plan->schedule.size(); i ++)
+    {
+        if(plan->num_dependencies[i] == 0)
+        {
+            task_queues[next_queue].push(i);
+            next_queue = (next_queue + 1) % (num_workers + 1);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        generation.fetch_add(1);
+    }
+    wake_condition.notify_all();
+
+    run_tasks(0);
+
+    while(active_workers.load() != 0)
+    {
+        std::this_thread::yield();
+    }
+}
+
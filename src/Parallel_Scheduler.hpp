@@ -0,0 +1,101 @@
+/*
+ * Matthew Diamond 2016
+ * The header for the Parallel_Scheduler class. The parallel scheduler owns a
+ * pool of worker threads that help the audio thread process an execution plan.
+ * Modules whose dependencies have all been processed are put on per-thread
+ * task queues, and threads that run out of work steal from each other, so
+ * independent branches of the signal chain are processed concurrently. The
+ * audio thread always waits for every worker to finish before returning, so
+ * the output module's inputs are complete once process() returns. This file
+ * defines the class.
+ */
+
+#ifndef MSS_PARALLEL_SCHEDULER_HPP
+#define MSS_PARALLEL_SCHEDULER_HPP
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Forward declaration of Execution_Plan class
+class Execution_Plan;
+
+/***************************************
+ * PARALLEL SCHEDULER CLASS DEFINITION *
+ ***************************************/
+
+class Parallel_Scheduler
+{
+public:
+    // The most modules that a task queue can hold, execution plans with more
+    // modules than this are always processed serially
+    static const unsigned int TASK_QUEUE_CAPACITY = 4096;
+
+    // The number of worker threads, not counting the audio thread
+    unsigned int num_workers;
+
+    // Constructor and destructor
+    Parallel_Scheduler(unsigned int);
+    ~Parallel_Scheduler();
+
+    // Member functions
+    //   Process every module in an execution plan using the audio thread and
+    //   all worker threads, return once every module has been processed
+    void process(Execution_Plan *);
+
+private:
+    // A double ended queue of indices into an execution plan's schedule, the
+    // lock-free work stealing deque of Chase and Lev. The thread that owns the
+    // queue pushes and pops from the back, other threads steal from the
+    // front. No thread ever waits on another, so a thread preempted partway
+    // through taking a task never holds up the rest.
+    struct Task_Queue
+    {
+        std::atomic<unsigned int> tasks[TASK_QUEUE_CAPACITY];
+        std::atomic<int64_t> front, back;
+
+        Task_Queue();
+        void push(unsigned int);
+        bool pop(unsigned int *);
+        bool steal(unsigned int *);
+    };
+
+    // The worker threads
+    std::vector<std::thread> threads;
+    // One task queue per thread, the audio thread's queue comes first
+    Task_Queue *task_queues;
+    // The plan currently being processed
+    std::atomic<Execution_Plan *> current_plan;
+    // How many modules remain to be processed in the current block
+    std::atomic<unsigned int> remaining_tasks;
+    // How many workers are currently looking for or running tasks
+    std::atomic<unsigned int> active_workers;
+    // Incremented once per block to wake the worker threads
+    std::atomic<unsigned int> generation;
+    // Whether or not the worker threads should exit
+    std::atomic<bool> quit;
+    // Used by idle worker threads to sleep until the next block
+    std::mutex wake_mutex;
+    std::condition_variable wake_condition;
+
+    // Member functions
+    //   The main loop of each worker thread
+    void worker(unsigned int);
+    //   Run and steal tasks until every module in the block is processed
+    void run_tasks(unsigned int);
+    //   Try to steal a task from any other thread's task queue
+    bool steal(unsigned int, unsigned int *);
+    //   Pin a worker thread to a core and raise its priority, if possible
+    void configure_thread(unsigned int);
+};
+
+#endif
+
@@ -0,0 +1,133 @@
+/*
+ * Matthew Diamond 2016
+ * Member functions for the Plan_Publisher class.
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <atomic>
+#include <vector>
+
+// Included files
+#include "main.hpp"
+
+// Included "other" classes
+#include "Command_Queue.hpp"
+#include "Execution_Plan.hpp"
+#include "Plan_Publisher.hpp"
+
+// Included modules classes
+#include "Module.hpp"
+
+/***********************************
+ * PLAN PUBLISHER MEMBER FUNCTIONS *
+ ***********************************/
+
+/*
+ * Constructor. Start out with an empty plan, so that there is always one to
+ * acquire.
+ */
+Plan_Publisher::Plan_Publisher() :
+    published(new Execution_Plan()), acknowledged_epoch(0), current(nullptr),
+    published_epoch(0)
+{}
+
+/*
+ * Destructor. Audio must be off by now, so everything can be deleted.
+ */
+Plan_Publisher::~Plan_Publisher()
+{
+    for(unsigned int i = 0; i < retired.size(); i ++)
+    {
+        delete retired[i].execution_plan;
+        delete retired[i].module;
+    }
+
+    delete published.load();
+}
+
+/*
+ * Publish a new plan. The plan it replaces may still be in use by the audio
+ * thread, so it is retired until the audio thread acknowledges the new plan's
+ * epoch. If audio is off, the audio callback will not be around to acquire the
+ * new plan, so acquire it right away instead.
+ */
+void Plan_Publisher::publish(Execution_Plan *execution_plan)
+{
+    Execution_Plan *previous_execution_plan;
+
+    execution_plan->epoch = ++ published_epoch;
+    previous_execution_plan = published.exchange(execution_plan,
+                                                 std::memory_order_acq_rel);
+    retired.push_back({published_epoch, previous_execution_plan, nullptr, 0});
+
+    if(!AUDIO_ON)
+    {
+        acquire();
+    }
+}
+
+/*
+ * Retire a module. The next plan to be published will not use it, so it can
+ * be deleted once that plan's epoch has been acknowledged. Several modules may
+ * be retired before that plan is published. Commands posted for the module
+ * before now may still be waiting in the command queue, and the audio thread
+ * applies them before acquiring a plan, possibly a block after acknowledging
+ * the new epoch, so the module also waits for all of them to be applied.
+ */
+void Plan_Publisher::retire(Module *module)
+{
+    retired.push_back({published_epoch + 1, nullptr, module,
+                       COMMAND_QUEUE.get_num_posted()});
+}
+
+/*
+ * Delete every plan and module retired in an epoch that the audio thread has
+ * acknowledged, once it has also applied every command posted before they were
+ * retired.
+ */
+void Plan_Publisher::collect_garbage()
+{
+    unsigned int epoch = acknowledged_epoch.load(std::memory_order_acquire);
+    unsigned int i = 0;
+
+    while(i < retired.size())
+    {
+        if(retired[i].epoch <= epoch
+           && COMMAND_QUEUE.has_applied(retired[i].num_commands))
+        {
+            delete retired[i].execution_plan;
+            delete retired[i].module;
+            retired.erase(retired.begin() + i);
+        }
+        else
+        {
+            i ++;
+        }
+    }
+}
+
+/*
+ * Return the most recently published plan. The first time a plan is acquired,
+ * bind the inputs of every module it processes, then acknowledge its epoch,
+ * since the previous plan will never be used again.
+ */
+Execution_Plan *Plan_Publisher::acquire()
+{
+    Execution_Plan *execution_plan =
+        published.load(std::memory_order_acquire);
+
+    if(execution_plan != current)
+    {
+        execution_plan->bind();
+        current = execution_plan;
+        acknowledged_epoch.store(execution_plan->epoch,
+                                 std::memory_order_release);
+    }
+
+    return current;
+}
+
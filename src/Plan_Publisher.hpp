@@ -0,0 +1,84 @@
+/*
+ * Matthew Diamond 2016
+ * The header for the Plan_Publisher class. Execution plans are immutable
+ * snapshots of the graph of modules: which modules to process, in what order,
+ * and which module each of their inputs reads from. The main thread builds a
+ * complete new snapshot whenever the graph changes and publishes it with a
+ * single atomic pointer swap. At the start of each block, the audio thread
+ * picks up the most recently published snapshot, binds its inputs, and
+ * acknowledges the snapshot's epoch. Snapshots and removed modules are only
+ * deleted on the main thread, once the audio thread has acknowledged an epoch
+ * in which they are no longer used. Removed modules also wait for the audio
+ * thread to apply every command posted for them before they were removed. This
+ * file defines the class.
+ */
+
+#ifndef MSS_PLAN_PUBLISHER_HPP
+#define MSS_PLAN_PUBLISHER_HPP
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <atomic>
+#include <vector>
+
+// Forward declarations of Module and Execution_Plan classes
+class Module;
+class Execution_Plan;
+
+/***********************************
+ * PLAN PUBLISHER CLASS DEFINITION *
+ ***********************************/
+
+class Plan_Publisher
+{
+public:
+    // Constructor and destructor
+    Plan_Publisher();
+    ~Plan_Publisher();
+
+    // Member functions
+    //   Publish a new execution plan, called from the main thread only
+    void publish(Execution_Plan *);
+    //   Delete a module once no published plan uses it anymore and every
+    //   command posted for it has been applied, called from the main thread
+    //   only, before publishing a plan without the module
+    void retire(Module *);
+    //   Delete everything retired in an epoch the audio thread has
+    //   acknowledged, called from the main thread only
+    void collect_garbage();
+    //   Return the most recently published plan, binding its inputs if it is
+    //   new, called from the audio thread only (or from the main thread while
+    //   audio is off)
+    Execution_Plan *acquire();
+
+private:
+    // A plan or module waiting to be deleted, the epoch after which the audio
+    // thread will never use it again, and how many commands the audio thread
+    // must have applied before it is safe to delete
+    struct Retired
+    {
+        unsigned int epoch;
+        Execution_Plan *execution_plan;
+        Module *module;
+        unsigned int num_commands;
+    };
+
+    // The most recently published plan
+    std::atomic<Execution_Plan *> published;
+    // The epoch of the plan the audio thread is currently using
+    std::atomic<unsigned int> acknowledged_epoch;
+    // The plan the audio thread is currently using, only touched by the audio
+    // thread
+    Execution_Plan *current;
+    // The epoch of the most recently published plan, only touched by the main
+    // thread
+    unsigned int published_epoch;
+    // Everything waiting to be deleted, only touched by the main thread
+    std::vector<Retired> retired;
+};
+
+#endif
+
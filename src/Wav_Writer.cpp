@@ -0,0 +1,154 @@
+/*
+ * Matthew Diamond 2016
+ * Member functions for the Wav_Writer class.
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+// Included "other" classes
+#include "Wav_Writer.hpp"
+
+/*******************************
+ * WAV WRITER MEMBER FUNCTIONS *
+ *******************************/
+
+/*
+ * Constructor. Open the file and write a header with no samples, which is
+ * filled in once the file is closed.
+ */
+Wav_Writer::Wav_Writer(std::string filename, unsigned int num_channels_,
+                       unsigned int sample_rate_, bool pcm_) :
+    file(filename, std::ios::binary), num_channels(num_channels_),
+    sample_rate(sample_rate_), pcm(pcm_), data_size(0)
+{
+    if(file.is_open())
+    {
+        write_header();
+    }
+}
+
+/*
+ * Destructor.
+ */
+Wav_Writer::~Wav_Writer()
+{
+    if(file.is_open())
+    {
+        close();
+    }
+}
+
+/*
+ * Return true if the file was opened successfully, false otherwise.
+ */
+bool Wav_Writer::is_open()
+{
+    return file.is_open();
+}
+
+/*
+ * Write integers to the file in little endian byte order, regardless of the
+ * byte order of this machine.
+ */
+void Wav_Writer::write_uint16(uint16_t val)
+{
+    char bytes[2] = {(char) (val & 0xff), (char) ((val >> 8) & 0xff)};
+    file.write(bytes, 2);
+}
+
+void Wav_Writer::write_uint32(uint32_t val)
+{
+    write_uint16(val & 0xffff);
+    write_uint16((val >> 16) & 0xffff);
+}
+
+/*
+ * Write the RIFF header, the format chunk, and the start of the data chunk.
+ * Float files also get a fact chunk, which is required for any format other
+ * than PCM.
+ */
+void Wav_Writer::write_header()
+{
+    uint16_t bytes_per_sample = pcm ? 2 : 4;
+    uint32_t num_frames = data_size / (bytes_per_sample * num_channels);
+
+    file.seekp(0);
+
+    file.write("RIFF", 4);
+    write_uint32((pcm ? 36 : 50) + data_size);
+    file.write("WAVE", 4);
+
+    file.write("fmt ", 4);
+    write_uint32(pcm ? 16 : 18);
+    write_uint16(pcm ? 1 : 3);
+    write_uint16(num_channels);
+    write_uint32(sample_rate);
+    write_uint32(sample_rate * num_channels * bytes_per_sample);
+    write_uint16(num_channels * bytes_per_sample);
+    write_uint16(bytes_per_sample * 8);
+    if(!pcm)
+    {
+        write_uint16(0);
+        file.write("fact", 4);
+        write_uint32(4);
+        write_uint32(num_frames);
+    }
+
+    file.write("data", 4);
+    write_uint32(data_size);
+}
+
+/*
+ * Write samples to the file. Samples written as PCM are clipped between -1
+ * and 1 first.
+ */
+void Wav_Writer::write(float *samples, unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        if(pcm)
+        {
+            float sample = samples[i];
+            if(sample > 1)
+            {
+                sample = 1;
+            }
+            else if(sample < -1)
+            {
+                sample = -1;
+            }
+            write_uint16((uint16_t) (int16_t) (sample * 32767));
+        }
+        else
+        {
+            uint32_t bits;
+            memcpy(&bits, &samples[i], 4);
+            write_uint32(bits);
+        }
+    }
+
+    data_size += num_samples * (pcm ? 2 : 4);
+}
+
+/*
+ * Go back and fill in the sizes in the header, then close the file.
+ */
+bool Wav_Writer::close()
+{
+    bool success;
+
+    write_header();
+    success = file.good();
+    file.close();
+
+    return success;
+}
+
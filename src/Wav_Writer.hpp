@@ -0,0 +1,60 @@
+/*
+ * Matthew Diamond 2016
+ * The header for the Wav_Writer class. A wav writer streams interleaved
+ * samples to a WAV file, either as 32 bit floats or as 16 bit PCM, and fills
+ * in the sizes in the header once it is closed. This file defines the class.
+ */
+
+#ifndef MSS_WAV_WRITER_HPP
+#define MSS_WAV_WRITER_HPP
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+/*******************************
+ * WAV WRITER CLASS DEFINITION *
+ *******************************/
+
+class Wav_Writer
+{
+public:
+    // Constructor and destructor
+    Wav_Writer(std::string, unsigned int, unsigned int, bool);
+    ~Wav_Writer();
+
+    // Member functions
+    //   Return true if the file was opened successfully, false otherwise
+    bool is_open();
+    //   Write the given number of interleaved samples to the file
+    void write(float *, unsigned int);
+    //   Fill in the header and close the file, return true if everything was
+    //   written successfully, false otherwise
+    bool close();
+
+private:
+    // The file being written to
+    std::ofstream file;
+    // Audio information
+    unsigned int num_channels;
+    unsigned int sample_rate;
+    // Whether to write 16 bit PCM samples instead of 32 bit float samples
+    bool pcm;
+    // The number of bytes of samples written so far
+    uint32_t data_size;
+
+    // Member functions
+    //   Write the header, using the current data size
+    void write_header();
+    //   Write integers in little endian byte order
+    void write_uint16(uint16_t);
+    void write_uint32(uint32_t);
+};
+
+#endif
+
@@ -9,6 +9,7 @@
 
 // Included libraries
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -97,6 +98,13 @@ void keydown_event(SDL_Event *e)
             create_module(Module::SAH);
         }
     }
+    else if(e->key.keysym.sym == SDLK_9)
+    {
+        if(e->key.keysym.mod & KMOD_LCTRL)
+        {
+            create_module(Module::POLY);
+        }
+    }
     else if(e->key.keysym.sym == SDLK_LEFTBRACKET)
     {
         if(e->key.keysym.mod & KMOD_LCTRL)
@@ -138,6 +146,49 @@ void keydown_event(SDL_Event *e)
     }
 }
 
+/*
+ * Handle SDL_KEYDOWN and SDL_KEYUP events for the keys that play notes, which
+ * are laid out like a piano keyboard over two rows, starting from C3 on the Z
+ * key and from C4 on the Q key. These keys only play notes while there is a
+ * poly module to play them on, otherwise they are handled like any other key.
+ * Notes are only started while no text box is active, but always released.
+ * Return true if the key plays a note, false otherwise.
+ */
+bool note_key_event(SDL_Event *e)
+{
+    static const std::map<int, int> note_keys =
+    {
+        {SDLK_z, 48}, {SDLK_s, 49}, {SDLK_x, 50}, {SDLK_d, 51}, {SDLK_c, 52},
+        {SDLK_v, 53}, {SDLK_g, 54}, {SDLK_b, 55}, {SDLK_h, 56}, {SDLK_n, 57},
+        {SDLK_j, 58}, {SDLK_m, 59}, {SDLK_COMMA, 60},
+        {SDLK_q, 60}, {SDLK_2, 61}, {SDLK_w, 62}, {SDLK_3, 63}, {SDLK_e, 64},
+        {SDLK_r, 65}, {SDLK_5, 66}, {SDLK_t, 67}, {SDLK_6, 68}, {SDLK_y, 69},
+        {SDLK_7, 70}, {SDLK_u, 71}, {SDLK_i, 72}
+    };
+    auto note_key = note_keys.find(e->key.keysym.sym);
+
+    if(note_key == note_keys.end() || !poly_modules_exist())
+    {
+        return false;
+    }
+    else if(e->type == SDL_KEYUP)
+    {
+        play_note(note_key->second, false);
+        return true;
+    }
+    else if(ACTIVE_TEXT_BOX != NULL || e->key.keysym.mod & KMOD_LCTRL)
+    {
+        return false;
+    }
+
+    if(!e->key.repeat)
+    {
+        play_note(note_key->second, true);
+    }
+
+    return true;
+}
+
 /*
  * For each graphics object on the current page,
  * check if it has been clicked. If so, call its
@@ -196,10 +247,15 @@ bool event_handler(SDL_Event *e)
             quit = true;
         }
 
-        // Otherwise, if a keyboard key is pressed...
-        else if(e->type == SDL_KEYDOWN)
+        // Otherwise, if a keyboard key is pressed or released, play or
+        // release a note if it is one of the note keys, or handle any other
+        // key press
+        else if(e->type == SDL_KEYDOWN || e->type == SDL_KEYUP)
         {
-            keydown_event(e);
+            if(!note_key_event(e) && e->type == SDL_KEYDOWN)
+            {
+                keydown_event(e);
+            }
         }
 
         // If neither an SDL_QUIT or SDL_KEYDOWN event has been received,
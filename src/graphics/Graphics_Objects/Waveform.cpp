@@ -30,7 +30,7 @@
  * Constructor.
  */
 Waveform::Waveform(std::string name_, SDL_Rect location_, SDL_Color color_,
-                   SDL_Color background_color_, std::vector<float> *buffer_) :
+                   SDL_Color background_color_, float **buffer_) :
     Graphics_Object(name_, WAVEFORM, NULL, location_, color_),
     background_color(background_color_), range_low(-1),
     range_high(1), buffer(buffer_),
@@ -27,16 +27,17 @@
 class Waveform: public Graphics_Object
 {
 public:
-    // The background color, the range of display, the pointer to the buffer to
-    // be rendered, and an internal buffer to store the buffer in the main
-    // thread
+    // The background color, the range of display, a pointer to the pointer
+    // to the buffer to be rendered, since that buffer may move, and an
+    // internal buffer to store the buffer in the main thread
     SDL_Color background_color;
     float range_low, range_high;
-    std::vector<float> *buffer, render_buffer;
+    float **buffer;
+    std::vector<float> render_buffer;
     Rect background;
 
     // Constructor and destructor
-    Waveform(std::string, SDL_Rect, SDL_Color, SDL_Color, std::vector<float> *);
+    Waveform(std::string, SDL_Rect, SDL_Color, SDL_Color, float **);
     virtual ~Waveform();
 
     // Member functions
@@ -22,6 +22,7 @@
 #include "initialize.hpp"
 #include "main.hpp"
 #include "populate_wavetables.hpp"
+#include "signal_kernels.hpp"
 #include "signal_processing.hpp"
 
 // Included modules classes
@@ -97,9 +98,19 @@ bool initialize()
     // Populate wavetables
     populate_wavetables();
 
+    // Select the fastest signal kernels this processor supports
+    std::cout << "Using " << select_signal_kernels() << " signal kernels"
+              << std::endl;
+
     // Seed rand()
     srand(time(NULL));
 
+    // Start the worker threads if parallel processing was asked for
+    if(NUM_WORKER_THREADS > 0)
+    {
+        PARALLEL_SCHEDULER = new Parallel_Scheduler(NUM_WORKER_THREADS);
+    }
+
     // Initialize the output module
     initialize_output();
 
@@ -252,6 +263,10 @@ void initialize_utilities_page()
         {location.x + location.w + MODULE_SPACING, location.y, 43,
          location.h};
     locations["add sah button"] = location;
+    location =
+        {location.x + location.w + MODULE_SPACING, location.y, 49,
+         location.h};
+    locations["add poly button"] = location;
     location =
         {WINDOW_WIDTH - 79 - 55 - (2 * MODULE_SPACING), location.y, 79,
          location.h};
@@ -298,6 +313,9 @@ void initialize_utilities_page()
     graphics_objects["add sah button"] =
         new Button("add sah button", locations["add sah button"], WHITE, BLACK,
                    "ADD SAH", NO_MODULE_LISTENER);
+    graphics_objects["add poly button"] =
+        new Button("add poly button", locations["add poly button"], WHITE,
+                   BLACK, "ADD POLY", NO_MODULE_LISTENER);
     graphics_objects["previous page button"] =
         new Button("previous page button", locations["previous page button"],
                    WHITE, BLACK, "PREVIOUS PAGE", NO_MODULE_LISTENER);
@@ -399,7 +417,10 @@ void initialize_output()
 {
     // Create the output module
     Output *output = new Output();
-    output->initialize_graphics_objects();
+    if(GRAPHICS_ON)
+    {
+        output->initialize_graphics_objects();
+    }
     MODULES.push_back(output);
 
     std::cout << "Output initialized" << std::endl;
@@ -8,6 +8,7 @@
  ************/
 
 // Included libraries
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -31,30 +32,207 @@
 #include "Modules/Noise.hpp"
 #include "Modules/Oscillator.hpp"
 #include "Modules/Output.hpp"
+#include "Modules/Poly.hpp"
+#include "Modules/Sah.hpp"
+
+/********************
+ * HELPER FUNCTIONS *
+ ********************/
+
+/*
+ * Read the text representation of a single module, starting after the line
+ * containing its type and name, which is given. The output module is reused,
+ * any other module is created and added to the vector of modules. Every line
+ * up to DONE is read before the inputs, since for some module types the
+ * number of inputs saved depends on the number of lines. The values and
+ * source module names of its inputs are stored to be applied once every
+ * module exists, inputs that were not saved keep their defaults. Return the
+ * module, or nullptr if it could not be read.
+ */
+Module *read_module(std::ifstream *infile, std::string *header,
+                    std::vector<float> *vals, std::vector<std::string> *srcs)
+{
+    std::string line;
+    std::vector<std::string> lines;
+    std::vector<std::string> unique_lines;
+    unsigned int num_inputs;
+    Module *module;
+    int type = stoi(header->substr(0, header->find(" ")));
+    std::string name = header->substr(header->find("(") + 1,
+                                      header->rfind(")")
+                                      - header->find("(") - 1);
+
+    if(type == Module::OUTPUT)
+    {
+        module = MODULES[0];
+    }
+    else
+    {
+        module = construct_module(type);
+        if(module == nullptr)
+        {
+            return nullptr;
+        }
+        module->name = name;
+        add_module(module);
+    }
+
+    while(getline(*infile, line) && line != "DONE")
+    {
+        lines.push_back(line);
+    }
+    if(line != "DONE")
+    {
+        return nullptr;
+    }
+
+    // The value of every input comes first, then the source of every input,
+    // then whatever is unique to the module type
+    num_inputs = module->saved_inputs(lines.size());
+    if(num_inputs > module->inputs.size() || lines.size() < 2 * num_inputs)
+    {
+        return nullptr;
+    }
+    for(unsigned int i = 0; i < num_inputs; i ++)
+    {
+        vals->push_back(stof(lines[i]));
+        srcs->push_back(lines[num_inputs + i]);
+    }
+    unique_lines.assign(lines.begin() + 2 * num_inputs, lines.end());
+
+    module->set_unique_text_representation(&unique_lines);
+
+    return module;
+}
+
+/*
+ * Set the input of the given module to the given value, or to come from the
+ * module with the given name, or from the output of it named after a colon,
+ * and update its text box and toggle button to match if there are any. Values
+ * are set without smoothing, so that a patch loaded while audio is on does not
+ * glide from the defaults of its modules. Return true if successful, false
+ * otherwise.
+ */
+bool load_input(Module *module, int input_num, float val, std::string *src_name)
+{
+    Text_Box *text_box = module->inputs[input_num].text_box;
+    Toggle_Button *toggle_button = module->inputs[input_num].toggle_button;
+    unsigned int src_output;
+    Module *src;
+
+    if(*src_name == "NULL")
+    {
+        module->set(input_num, val, false);
+        if(text_box != nullptr && text_box->prompt_text.text != "input")
+        {
+            text_box->update_current_text(std::to_string(val));
+        }
+        return true;
+    }
+
+    src = find_module(src_name, &src_output);
+    if(src == nullptr || src == module || src->module_type == Module::OUTPUT)
+    {
+        return false;
+    }
+
+    module->set(input_num, src, src_output);
+    if(text_box != nullptr)
+    {
+        text_box->update_current_text(src->get_short_output_name(src_output));
+    }
+    if(toggle_button != nullptr)
+    {
+        toggle_button->b = true;
+    }
+    return true;
+}
 
 /**************
  * LOAD PATCH *
  **************/
 
-void load_patch(std::string filename)
+/*
+ * Replace every module other than the output module with the modules saved in
+ * the given file by save_patch(). Every module is created before any inputs
+ * are set, since an input may come from a module further on in the file, and
+ * the execution plan is only published once the whole patch is in place.
+ * Return true if the whole patch was loaded, false otherwise.
+ */
+bool load_patch(std::string filename)
 {
     std::ifstream infile;
+    std::string line;
+    std::vector<Module *> modules;
+    std::vector<std::vector<float>> vals;
+    std::vector<std::vector<std::string>> srcs;
+    bool success = true;
 
     infile.open(filename);
 
-    if(infile.is_open())
+    if(!infile.is_open() || MODULES.empty() || MODULES[0] == NULL)
+    {
+        std::cout << RED_STDOUT << "Patch could not be loaded!"
+                  << DEFAULT_STDOUT << std::endl;
+        return false;
+    }
+
+    defer_execution_plan_updates();
+
+    // Remove every module other than the output module
+    for(unsigned int i = 1; i < MODULES.size(); i ++)
     {
-        infile.close();
+        if(MODULES[i] != NULL)
+        {
+            remove_module(MODULES[i]);
+        }
+    }
+
+    // Create every module in the file
+    try
+    {
+        while(success && getline(infile, line))
+        {
+            if(!line.empty())
+            {
+                vals.push_back(std::vector<float>());
+                srcs.push_back(std::vector<std::string>());
+                modules.push_back(read_module(&infile, &line, &vals.back(),
+                                              &srcs.back()));
+                success = modules.back() != nullptr;
+            }
+        }
+    }
+    catch(std::exception &e)
+    {
+        success = false;
+    }
+
+    // Set every input of every module
+    for(unsigned int i = 0; success && i < modules.size(); i ++)
+    {
+        for(unsigned int j = 0; success && j < vals[i].size(); j ++)
+        {
+            success = load_input(modules[i], j, vals[i][j], &srcs[i][j]);
+        }
+    }
+
+    infile.close();
 
-        MODULES_CHANGED = true;
+    resume_execution_plan_updates();
 
-        /* std::cout << "Patch " << filename << " loaded" << std::endl; */
-        std::cout << "Patch loading not implemented" << std::endl;
+    MODULES_CHANGED = true;
+
+    if(success)
+    {
+        std::cout << "Patch " << filename << " loaded" << std::endl;
     }
     else
     {
-        std::cout << RED_STDOUT << "Patch could not be loaded!"
-                  << DEFAULT_STDOUT << std::endl;
+        std::cout << RED_STDOUT << "Patch " << filename
+                  << " could not be fully loaded!" << DEFAULT_STDOUT
+                  << std::endl;
     }
-}
 
+    return success;
+}
@@ -17,7 +17,7 @@
  * FUNCTION DECLARATIONS *
  *************************/
 
-void load_patch(std::string);
+bool load_patch(std::string);
 
 #endif
 
@@ -12,6 +12,7 @@
 
 // Included libraries
 #include <iostream>
+#include <string>
 #include <vector>
 
 // Included SDL components
@@ -47,9 +48,17 @@ unsigned int BUFFER_SIZE;
 unsigned int NUM_CHANNELS;
 bool AUDIO_ON = true;
 
+// Whether or not modules have graphics objects, false when rendering offline
+bool GRAPHICS_ON = true;
+
 // Wavetables
-std::vector<std::vector<float>> WAVETABLES(4, std::vector<float>(SAMPLE_RATE,
-                                                                  0));
+const unsigned int WAVETABLE_BITS = 11;
+const unsigned int WAVETABLE_SIZE = 1 << WAVETABLE_BITS;
+const unsigned int WAVETABLE_OCTAVES = 10;
+const float WAVETABLE_MIN_FREQUENCY = 40;
+std::vector<std::vector<std::vector<float>>> WAVETABLES(
+    4, std::vector<std::vector<float>>(
+        WAVETABLE_OCTAVES, std::vector<float>(WAVETABLE_SIZE + 1, 0)));
 // Module dimensions and amount of modules per page
 const int MODULE_WIDTH = 160;
 const int MODULE_HEIGHT = 135;
@@ -99,6 +108,45 @@ Graphics_Listener *NO_MODULE_LISTENER = (Graphics_Listener *) &FORWARDER;
 std::vector<Module *> MODULES = std::vector<Module *>();
 bool MODULES_CHANGED = true;
 
+// Snapshots of the order in which modules are processed by the audio callback,
+// compiled whenever connections between modules change, and changes to
+// parameter values made by the main thread, both picked up by the audio
+// callback at the start of the next block
+Plan_Publisher PLAN_PUBLISHER;
+Command_Queue COMMAND_QUEUE;
+
+// The patch to render offline (none to open a window as usual), the WAV file
+// to render it to, how many seconds to render, and whether to write 16 bit PCM
+// samples instead of 32 bit float samples
+std::string RENDER_PATCH_FILENAME = "";
+std::string RENDER_OUTPUT_FILENAME = "render.wav";
+float RENDER_SECONDS = 10;
+bool RENDER_PCM = false;
+
+// The number of worker threads to help the audio thread process modules (0 to
+// process everything on the audio thread), the least amount of modules an
+// execution plan must have to be processed in parallel, and the parallel
+// scheduler itself, which only exists if there are worker threads
+unsigned int NUM_WORKER_THREADS = 0;
+const unsigned int PARALLEL_MODULE_THRESHOLD = 8;
+Parallel_Scheduler *PARALLEL_SCHEDULER = nullptr;
+
+// Whether modules in a feedback loop are processed one sample at a time, so
+// that feedback is delayed by a single sample instead of a whole block
+bool TIGHT_FEEDBACK = false;
+
+// The number of samples between the points calculated by a module whose
+// output only modulates other modules, which are interpolated in between (1
+// to calculate every sample of every module, the default is short enough that
+// an LFO stays within a hundredth of its range)
+unsigned int CONTROL_PERIOD = 8;
+
+// How many milliseconds a parameter takes to reach a value typed in while
+// audio is on (0 to jump straight to it), and whether it gets there along a
+// one-pole curve instead of a straight line
+float SMOOTHING_TIME = 20;
+bool SMOOTHING_EXPONENTIAL = false;
+
 /***********************
  * TESTING MODE TOGGLE *
  ***********************/
@@ -111,17 +159,25 @@ bool testing = false;
 
 /*
  * Driver function for the whole program. This program
- * will either run in test mode or normally. If run in test
- * mode this function will run a series of tests and then exit.
- * If run normally, this function will open the audio device,
- * initialize the output module, and then wait for user interaction.
+ * will either run in test mode, render a patch offline, or run normally.
+ * If run in test mode this function will run a series of tests and then exit.
+ * If rendering offline, this function will render the patch to a WAV file
+ * as fast as possible and then exit. If run normally, this function will open
+ * the audio device, initialize the output module, and then wait for user
+ * interaction.
  */
 int main(int argc, char **argv)
 {
     int exit_status = 0;
 
+    // Read any options given on the command line
+    if(!parse_arguments(argc, argv))
+    {
+        exit_status = -1;
+    }
+
     // If this is testing mode, just run the tests
-    if(testing)
+    else if(testing)
     {
         if(!testing_mode())
         {
@@ -129,6 +185,16 @@ int main(int argc, char **argv)
         }
     }
 
+    // If a patch was given to render, render it without opening a window or
+    // the audio device
+    else if(!RENDER_PATCH_FILENAME.empty())
+    {
+        if(!render_mode())
+        {
+            exit_status = -1;
+        }
+    }
+
     // If this is normal mode, open SDL, initialize necessary
     // objects, and begin processing audio and graphics
     else
@@ -13,6 +13,7 @@
 
 // Included libraries
 #include <map>
+#include <string>
 
 // Included SDL components
 #include "SDL_ttf.h"
@@ -28,7 +29,11 @@
 
 // Included "other" classes
 #include "Color_Modifier.hpp"
+#include "Command_Queue.hpp"
+#include "Execution_Plan.hpp"
 #include "Function_Forwarder.hpp"
+#include "Parallel_Scheduler.hpp"
+#include "Plan_Publisher.hpp"
 
 /**********************
  * EXTERNAL VARIABLES *
@@ -47,8 +52,19 @@ extern unsigned int BUFFER_SIZE;
 extern unsigned int NUM_CHANNELS;
 extern bool AUDIO_ON;
 
-// Wavetables
-extern std::vector<std::vector<float>> WAVETABLES;
+// Whether or not modules have graphics objects, false when rendering offline
+extern bool GRAPHICS_ON;
+
+// Wavetables, one for each octave of each waveform type, band-limited for
+// that octave. Each holds one period in a power of two number of entries,
+// followed by a copy of its first entry for interpolation
+extern const unsigned int WAVETABLE_BITS;
+extern const unsigned int WAVETABLE_SIZE;
+extern const unsigned int WAVETABLE_OCTAVES;
+//   The lowest frequency that oscillators read wavetables at, below it
+//   waveforms do not alias audibly and are calculated exactly instead
+extern const float WAVETABLE_MIN_FREQUENCY;
+extern std::vector<std::vector<std::vector<float>>> WAVETABLES;
 
 // Graphics objects and variables
 //   Module dimensions and amount of modules per page
@@ -88,5 +104,31 @@ extern Graphics_Listener *NO_MODULE_LISTENER;
 extern std::vector<Module *> MODULES;
 extern bool MODULES_CHANGED;
 
+// Snapshots of the order in which modules are processed by the audio
+// callback, and parameter changes waiting to be applied by it
+extern Plan_Publisher PLAN_PUBLISHER;
+extern Command_Queue COMMAND_QUEUE;
+
+// Offline rendering to a WAV file instead of opening a window
+extern std::string RENDER_PATCH_FILENAME;
+extern std::string RENDER_OUTPUT_FILENAME;
+extern float RENDER_SECONDS;
+extern bool RENDER_PCM;
+
+// Parallel processing of modules
+extern unsigned int NUM_WORKER_THREADS;
+extern const unsigned int PARALLEL_MODULE_THRESHOLD;
+extern Parallel_Scheduler *PARALLEL_SCHEDULER;
+
+// Feedback loops between modules
+extern bool TIGHT_FEEDBACK;
+
+// Modules calculated at control rate
+extern unsigned int CONTROL_PERIOD;
+
+// Parameter smoothing
+extern float SMOOTHING_TIME;
+extern bool SMOOTHING_EXPONENTIAL;
+
 #endif
 
@@ -8,7 +8,10 @@
  ************/
 
 // Included libraries
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include <vector>
 
 // Included SDL components
@@ -20,7 +23,12 @@
 #include "event_handler.hpp"
 #include "image_processing.hpp"
 #include "initialize.hpp"
+#include "load_patch.hpp"
 #include "main.hpp"
+#include "module_utils.hpp"
+#include "populate_wavetables.hpp"
+#include "signal_kernels.hpp"
+#include "signal_processing.hpp"
 #include "tests.hpp"
 
 // Included modules classes
@@ -29,6 +37,7 @@
 // Included "other" classes
 #include "Color_Modifier.hpp"
 #include "Timer.hpp"
+#include "Wav_Writer.hpp"
 
 /********************
  * HELPER FUNCTIONS *
@@ -46,7 +55,8 @@ void destroy_pages()
 }
 
 /*
- * Destroy all modules.
+ * Destroy all modules. Audio must be off, so that removing each module is
+ * applied right away, then everything removed can be deleted.
  */
 void destroy_modules()
 {
@@ -54,9 +64,136 @@ void destroy_modules()
     {
         if(MODULES[i] != NULL)
         {
-            delete MODULES[i];
+            remove_module(MODULES[i]);
         }
     }
+
+    PLAN_PUBLISHER.collect_garbage();
+}
+
+/*
+ * Print out the options that may be given on the command line.
+ */
+void print_usage(char *program_name)
+{
+    std::cout << "Usage: " << program_name << " [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "    -w, --workers N    process modules on N worker threads "
+                 "as well as the audio thread" << std::endl;
+    std::cout << "    -r, --render FILE  render the patch saved in FILE to a "
+                 "WAV file, without" << std::endl
+              << "                       opening a window or the audio device"
+              << std::endl;
+    std::cout << "    -o, --output FILE  the WAV file to render to (default "
+              << RENDER_OUTPUT_FILENAME << ")" << std::endl;
+    std::cout << "    -s, --seconds N    how many seconds to render (default "
+              << RENDER_SECONDS << ")" << std::endl;
+    std::cout << "    -p, --pcm          render 16 bit PCM samples instead of "
+                 "32 bit floats" << std::endl;
+    std::cout << "    -f, --tight-feedback" << std::endl
+              << "                       process feedback loops one sample at "
+                 "a time, so that" << std::endl
+              << "                       feedback is delayed by a sample "
+                 "instead of a block" << std::endl;
+    std::cout << "    -c, --control-period N" << std::endl
+              << "                       calculate modulation sources once "
+                 "every N samples and" << std::endl
+              << "                       interpolate in between (default "
+              << CONTROL_PERIOD << ", 1 for every sample)" << std::endl;
+    std::cout << "    -t, --smoothing-time MS" << std::endl
+              << "                       how long parameters take to reach "
+                 "new values (default" << std::endl
+              << "                       " << SMOOTHING_TIME
+              << ", 0 to jump straight to them)" << std::endl;
+    std::cout << "    -e, --exponential-smoothing" << std::endl
+              << "                       smooth parameters along a one-pole "
+                 "curve instead of a" << std::endl
+              << "                       straight line" << std::endl;
+    std::cout << "    -h, --help         print this message" << std::endl;
+}
+
+/*
+ * Read the options given on the command line into the relevant external
+ * variables. Return true if all of them made sense, false otherwise.
+ */
+bool parse_arguments(int argc, char **argv)
+{
+    for(int i = 1; i < argc; i ++)
+    {
+        std::string argument = argv[i];
+
+        if((argument == "-w" || argument == "--workers") && i + 1 < argc)
+        {
+            int num_workers = atoi(argv[++ i]);
+            if(num_workers < 0)
+            {
+                std::cout << RED_STDOUT << "The number of worker threads "
+                          "cannot be negative" << DEFAULT_STDOUT << std::endl;
+                return false;
+            }
+            NUM_WORKER_THREADS = num_workers;
+        }
+        else if((argument == "-r" || argument == "--render") && i + 1 < argc)
+        {
+            RENDER_PATCH_FILENAME = argv[++ i];
+        }
+        else if((argument == "-o" || argument == "--output") && i + 1 < argc)
+        {
+            RENDER_OUTPUT_FILENAME = argv[++ i];
+        }
+        else if((argument == "-s" || argument == "--seconds") && i + 1 < argc)
+        {
+            RENDER_SECONDS = atof(argv[++ i]);
+            if(RENDER_SECONDS <= 0)
+            {
+                std::cout << RED_STDOUT << "The number of seconds to render "
+                          "must be positive" << DEFAULT_STDOUT << std::endl;
+                return false;
+            }
+        }
+        else if(argument == "-p" || argument == "--pcm")
+        {
+            RENDER_PCM = true;
+        }
+        else if(argument == "-f" || argument == "--tight-feedback")
+        {
+            TIGHT_FEEDBACK = true;
+        }
+        else if((argument == "-c" || argument == "--control-period")
+                && i + 1 < argc)
+        {
+            int control_period = atoi(argv[++ i]);
+            if(control_period < 1)
+            {
+                std::cout << RED_STDOUT << "The control period must be at "
+                          "least 1 sample" << DEFAULT_STDOUT << std::endl;
+                return false;
+            }
+            CONTROL_PERIOD = control_period;
+        }
+        else if((argument == "-t" || argument == "--smoothing-time")
+                && i + 1 < argc)
+        {
+            SMOOTHING_TIME = atof(argv[++ i]);
+            if(SMOOTHING_TIME < 0)
+            {
+                std::cout << RED_STDOUT << "The smoothing time cannot be "
+                          "negative" << DEFAULT_STDOUT << std::endl;
+                return false;
+            }
+        }
+        else if(argument == "-e" || argument == "--exponential-smoothing")
+        {
+            SMOOTHING_EXPONENTIAL = true;
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+
+    return true;
 }
 
 /*
@@ -64,8 +201,10 @@ void destroy_modules()
  */
 void cleanup()
 {
-    // Pause audio
+    // Pause audio, and mark it off so that changes to modules no longer wait
+    // for the audio callback
     SDL_PauseAudio(1);
+    AUDIO_ON = false;
 
     // Destroy the renderer
     if(RENDERER != nullptr)
@@ -95,6 +234,14 @@ void cleanup()
         std::cout << "Destroyed all pages" << std::endl;
     }
 
+    // Stop the worker threads
+    if(PARALLEL_SCHEDULER != nullptr)
+    {
+        delete PARALLEL_SCHEDULER;
+        PARALLEL_SCHEDULER = nullptr;
+        std::cout << "Stopped worker threads" << std::endl;
+    }
+
     // Quit SDL
     SDL_Quit();
     std::cout << "SDL terminated" << std::endl;
@@ -111,6 +258,13 @@ void cleanup()
  */
 bool testing_mode()
 {
+    // Some tests process modules, which need a buffer size and wavetables,
+    // but never the audio device or graphics
+    AUDIO_ON = false;
+    GRAPHICS_ON = false;
+    BUFFER_SIZE = 512;
+    populate_wavetables();
+
     return run_tests();
 }
 
@@ -147,6 +301,9 @@ bool normal_mode()
         draw_surface();
         frame_count ++;
 
+        // Delete any modules and execution plans the audio thread is done with
+        PLAN_PUBLISHER.collect_garbage();
+
         // Every 500 frames, print out the framerate
         if(frame_count % 500 == 0)
         {
@@ -170,3 +327,96 @@ bool normal_mode()
     return true;
 }
 
+/*
+ * Run in offline render mode. Load the patch, then call the audio callback in
+ * a loop, as fast as possible, writing every block to a WAV file. No window is
+ * opened and no audio device is used, so modules have no graphics objects.
+ * Report how much faster than real time processing ran. If everything goes
+ * smoothly, return true, otherwise, return false.
+ */
+bool render_mode()
+{
+    unsigned int num_frames = RENDER_SECONDS * SAMPLE_RATE;
+    unsigned int frames_rendered = 0;
+    Uint64 processing_ticks = 0;
+    Uint64 start_ticks;
+    double processing_seconds;
+    std::vector<float> buffer;
+
+    // Modules are only ever processed from this thread, so changes to them
+    // never wait on the audio callback, and they never need graphics
+    AUDIO_ON = false;
+    GRAPHICS_ON = false;
+    BUFFER_SIZE = 512;
+    NUM_CHANNELS = 2;
+    buffer = std::vector<float>(BUFFER_SIZE * NUM_CHANNELS);
+
+    // Populate wavetables
+    populate_wavetables();
+
+    // Select the fastest signal kernels this processor supports
+    std::cout << "Using " << select_signal_kernels() << " signal kernels"
+              << std::endl;
+
+    // Start the worker threads if parallel processing was asked for
+    if(NUM_WORKER_THREADS > 0)
+    {
+        PARALLEL_SCHEDULER = new Parallel_Scheduler(NUM_WORKER_THREADS);
+    }
+
+    // Initialize the output module and load the patch
+    initialize_output();
+    if(!load_patch(RENDER_PATCH_FILENAME))
+    {
+        cleanup();
+        return false;
+    }
+
+    Wav_Writer wav_writer(RENDER_OUTPUT_FILENAME, NUM_CHANNELS, SAMPLE_RATE,
+                          RENDER_PCM);
+    if(!wav_writer.is_open())
+    {
+        std::cout << RED_STDOUT << "Could not open " << RENDER_OUTPUT_FILENAME
+                  << DEFAULT_STDOUT << std::endl;
+        cleanup();
+        return false;
+    }
+
+    // Render one block at a time, only timing the processing itself
+    while(frames_rendered < num_frames)
+    {
+        unsigned int frames = std::min(BUFFER_SIZE,
+                                       num_frames - frames_rendered);
+
+        start_ticks = SDL_GetPerformanceCounter();
+        audio_callback(NULL, (Uint8 *) &buffer[0],
+                       buffer.size() * sizeof(float));
+        processing_ticks += SDL_GetPerformanceCounter() - start_ticks;
+
+        wav_writer.write(&buffer[0], frames * NUM_CHANNELS);
+        frames_rendered += frames;
+    }
+
+    if(!wav_writer.close())
+    {
+        std::cout << RED_STDOUT << "Could not write " << RENDER_OUTPUT_FILENAME
+                  << DEFAULT_STDOUT << std::endl;
+        cleanup();
+        return false;
+    }
+
+    processing_seconds = (double) processing_ticks
+                         / SDL_GetPerformanceFrequency();
+    std::cout << GREEN_STDOUT << "Rendered " << RENDER_SECONDS
+              << " seconds to " << RENDER_OUTPUT_FILENAME << " in "
+              << processing_seconds << " seconds of processing ("
+              << RENDER_SECONDS / processing_seconds << "x real time)"
+              << DEFAULT_STDOUT << std::endl;
+
+    // Clean up
+    cleanup();
+
+    // Return success
+    return true;
+}
+
@@ -18,10 +18,12 @@
 
 // Helper functions
 void destroy_pages();
+bool parse_arguments(int, char **);
 
 // Main helper functions
 bool testing_mode();
 bool normal_mode();
+bool render_mode();
 
 #endif
 
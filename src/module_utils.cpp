@@ -8,6 +8,7 @@
  ************/
 
 // Included libraries
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -23,16 +24,24 @@
 // Included modules classes
 #include "Module.hpp"
 
+/********************
+ * STATIC VARIABLES *
+ ********************/
+
+// How many callers have asked for execution plan updates to be deferred
+static unsigned int execution_plan_updates_deferred = 0;
+
 /********************
  * HELPER FUNCTIONS *
  ********************/
 
 /*
- * Create a module of the type specified.
+ * Construct a module of the type specified, without adding it to the vector of
+ * modules. Return nullptr if the type is not one the user may create.
  */
-void create_module(int type)
+Module *construct_module(int type)
 {
-    Module *module;
+    Module *module = nullptr;
 
     switch(type)
     {
@@ -60,9 +69,30 @@ void create_module(int type)
     case Module::SAH:
         module = new Sah();
         break;
+    case Module::POLY:
+        module = new Poly();
+        break;
+    }
+
+    return module;
+}
+
+/*
+ * Add a constructed module to the first empty spot in the vector of modules,
+ * initializing its graphics objects first if there are graphics. The default
+ * value of each input is what gets saved until it is set.
+ */
+void add_module(Module *module)
+{
+    for(unsigned int i = 0; i < module->inputs.size(); i ++)
+    {
+        module->inputs[i].saved_val = module->inputs[i].val;
     }
 
-    module->initialize_graphics_objects();
+    if(GRAPHICS_ON)
+    {
+        module->initialize_graphics_objects();
+    }
 
     bool push_on_back = false;
     for(unsigned int i = 0; i < MODULES.size(); i ++)
@@ -88,6 +118,98 @@ void create_module(int type)
     MODULES_CHANGED = true;
 }
 
+/*
+ * Create a module of the type specified.
+ */
+void create_module(int type)
+{
+    add_module(construct_module(type));
+
+    update_execution_plan();
+}
+
+/*
+ * Remove a module. Every input it outputs to is cancelled, and the module is
+ * retired, to be deleted once the audio thread has acknowledged a new
+ * execution plan without it and applied every command posted for it.
+ */
+void remove_module(Module *module)
+{
+    // Remove the module from the vector of modules
+    for(unsigned int i = 0; i < MODULES.size(); i ++)
+    {
+        if(MODULES[i] == module)
+        {
+            MODULES[i] = NULL;
+        }
+    }
+
+    // Cancel any inputs that the module is outputting to
+    for(unsigned int i = 0; i < MODULES.size(); i ++)
+    {
+        if(MODULES[i] != NULL)
+        {
+            for(unsigned int j = 0; j < MODULES[i]->inputs.size(); j ++)
+            {
+                if(MODULES[i]->inputs[j].from == module)
+                {
+                    MODULES[i]->cancel_input(j);
+                }
+            }
+        }
+    }
+
+    // Mark modules changed so that they will be re-rendered
+    MODULES_CHANGED = true;
+
+    // Recompile the execution plan now that nothing depends on the module,
+    // the module is retired first so that it is deleted once that plan is in
+    // use
+    PLAN_PUBLISHER.retire(module);
+    update_execution_plan();
+
+    std::cout << "Module \"" << module->name << "\" removed" << std::endl;
+}
+
+/*
+ * Start or release a note on every poly module. Notes are numbered the same
+ * way as MIDI notes, with note 69 being A at 440 Hz.
+ */
+void play_note(int note, bool note_on)
+{
+    Command_Queue::Command command;
+
+    command.command_type = note_on ? Command_Queue::NOTE_ON
+                                   : Command_Queue::NOTE_OFF;
+    command.note = note;
+    command.val = 440 * pow(2, (note - 69) / 12.0);
+
+    for(unsigned int i = 0; i < MODULES.size(); i ++)
+    {
+        if(MODULES[i] != NULL && MODULES[i]->module_type == Module::POLY)
+        {
+            command.module = MODULES[i];
+            COMMAND_QUEUE.post(command);
+        }
+    }
+}
+
+/*
+ * Return whether or not there are any poly modules to play notes on.
+ */
+bool poly_modules_exist()
+{
+    for(unsigned int i = 0; i < MODULES.size(); i ++)
+    {
+        if(MODULES[i] != NULL && MODULES[i]->module_type == Module::POLY)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /*
  * Given the name of a module, return a pointer to it if
  * it exists, or nullptr if it doesn't.
@@ -109,6 +231,37 @@ Module *find_module(std::string *name)
     return nullptr;
 }
 
+/*
+ * Given the name of a module, optionally followed by a colon and the name of
+ * one of its other outputs, return a pointer to it and set the given output
+ * number to the output named, 0 for its main output, or return nullptr if
+ * there is no such module or output.
+ */
+Module *find_module(std::string *name, unsigned int *output_num)
+{
+    std::string module_name = name->substr(0, name->rfind(":"));
+    std::string output_name;
+    Module *module = find_module(&module_name);
+
+    *output_num = 0;
+    if(module == nullptr || module_name == *name)
+    {
+        return module;
+    }
+
+    output_name = name->substr(name->rfind(":") + 1);
+    for(unsigned int i = 0; i < module->extra_output_names.size(); i ++)
+    {
+        if(module->extra_output_names[i] == output_name)
+        {
+            *output_num = i + 1;
+            return module;
+        }
+    }
+
+    return nullptr;
+}
+
 /*
  * This function takes a module type as input and returns
  * the first number that is not already contained in the name of
@@ -205,3 +358,53 @@ std::vector<SDL_Color> generate_module_colors()
     return colors;
 }
 
+
+/*
+ * Stop publishing a new execution plan every time the connections between
+ * modules change, for example while loading a whole patch, so that the audio
+ * thread never sees a partially built graph.
+ */
+void defer_execution_plan_updates()
+{
+    execution_plan_updates_deferred ++;
+}
+
+/*
+ * Go back to publishing a new execution plan every time the connections
+ * between modules change, and publish one right away to catch up on any
+ * changes made while updates were deferred.
+ */
+void resume_execution_plan_updates()
+{
+    execution_plan_updates_deferred --;
+
+    update_execution_plan();
+}
+
+/*
+ * Compile a new execution plan from the output module, then publish it to be
+ * picked up by the audio thread at the start of the next block. The plan is
+ * compiled without interfering with processing, and the plan it replaces is
+ * deleted once the audio thread is done with it.
+ */
+void update_execution_plan()
+{
+    Execution_Plan *execution_plan;
+
+    if(execution_plan_updates_deferred > 0)
+    {
+        return;
+    }
+
+    execution_plan = new Execution_Plan();
+
+    // Only the output module can be the root of an execution plan, if it is
+    // gone, there is nothing left to process
+    if(!MODULES.empty() && MODULES[0] != NULL
+       && MODULES[0]->module_type == Module::OUTPUT)
+    {
+        execution_plan->compile(MODULES[0]);
+    }
+
+    PLAN_PUBLISHER.publish(execution_plan);
+}
@@ -23,17 +23,30 @@
 #include "Modules/Noise.hpp"
 #include "Modules/Oscillator.hpp"
 #include "Modules/Output.hpp"
+#include "Modules/Poly.hpp"
 #include "Modules/Sah.hpp"
 
 /*************************
  * FUNCTION DECLARATIONS *
  *************************/
 
-// Module initialization function
+// Module initialization functions
+Module *construct_module(int);
+void add_module(Module *);
 void create_module(int);
 
-// A function for finding a module given its name
+// Module removal function
+void remove_module(Module *);
+
+// Functions for starting or releasing a note on every poly module, and for
+// finding out if there are any
+void play_note(int, bool);
+bool poly_modules_exist();
+
+// Functions for finding a module given its name, and one of its outputs
+// given the name of the output after the name of the module
 Module *find_module(std::string *);
+Module *find_module(std::string *, unsigned int *);
 
 // A function for determining what number should be in a new module's name
 int find_available_module_number(int);
@@ -48,5 +61,10 @@ SDL_Rect find_module_location(int);
 // A function for generating colors for a module
 std::vector<SDL_Color> generate_module_colors();
 
+// Functions for recompiling the order in which modules are processed
+void defer_execution_plan_updates();
+void resume_execution_plan_updates();
+void update_execution_plan();
+
 #endif
 
@@ -8,6 +8,8 @@
  ************/
 
 // Included libraries
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <map>
 #include <string>
@@ -17,6 +19,10 @@
 #include "image_processing.hpp"
 #include "main.hpp"
 #include "module_utils.hpp"
+#include "signal_kernels.hpp"
+
+// Included "other" classes
+#include "Execution_Plan.hpp"
 
 // Included modules classes
 #include "Module.hpp"
@@ -28,8 +34,17 @@
 #include "Modules/Noise.hpp"
 #include "Modules/Oscillator.hpp"
 #include "Modules/Output.hpp"
+#include "Modules/Poly.hpp"
 #include "Modules/Sah.hpp"
 
+/*************
+ * CONSTANTS *
+ *************/
+
+// How much of the distance to a new value is left once the smoothing time is
+// up along a one-pole curve, -60 dB, after which the value jumps to the target
+static const double SMOOTHING_REMAINDER = .001;
+
 /*******************************
  * MODULE NAME PER MODULE TYPE *
  *******************************/
@@ -44,13 +59,31 @@ const std::map<Module::ModuleType, std::string> Module::module_names =
     {NOISE, "noise"},
     {OSCILLATOR, "oscillator"},
     {OUTPUT, "output"},
-    {SAH, "sah"}
+    {SAH, "sah"},
+    {POLY, "poly"}
 };
 
 /******************************************
  * MODULE PARAMETER NAMES PER MODULE TYPE *
  ******************************************/
 
+/*
+ * Return the names of the parameters of a mixer, a signal and a multiplier
+ * for each of the most channels a mixer can have.
+ */
+static std::vector<std::string> mixer_parameter_names()
+{
+    std::vector<std::string> names;
+
+    for(unsigned int i = 1; i <= Mixer::MAX_CHANNELS; i ++)
+    {
+        names.push_back("signal " + std::to_string(i));
+        names.push_back("signal " + std::to_string(i) + " multiplier");
+    }
+
+    return names;
+}
+
 const std::map<Module::ModuleType,
                std::vector<std::string>> Module::parameter_names =
 {
@@ -84,18 +117,7 @@ const std::map<Module::ModuleType,
     },
     {
         MIXER,
-        {
-            "signal 1",
-            "signal 1 multiplier",
-            "signal 2",
-            "signal 2 multiplier",
-            "signal 3",
-            "signal 3 multiplier",
-            "signal 4",
-            "signal 4 multiplier",
-            "signal 5",
-            "signal 5 multiplier"
-        }
+        mixer_parameter_names()
     },
     {
         MULTIPLIER,
@@ -133,7 +155,21 @@ const std::map<Module::ModuleType,
         SAH,
         {
             "signal",
-            "hold time"
+            "hold time",
+            "trigger"
+        }
+    },
+    {
+        POLY,
+        {
+            "frequency",
+            "note on/off",
+            "attack",
+            "decay",
+            "sustain",
+            "release",
+            "frequency cutoff",
+            "q"
         }
     }
 };
@@ -152,9 +188,11 @@ Module::Module(ModuleType _module_type) :
         MODULE, NULL, find_module_location(find_available_module_slot()),
         BLACK),
     module_type(_module_type), number(find_available_module_slot()),
-    processed(false),
+    graphics_objects_initialized(false),
     inputs(std::vector<Parameter>(parameter_names.at(_module_type).size())),
-    out(std::vector<float>(BUFFER_SIZE))
+    out(Execution_Plan::silence()), rate(AUDIO_RATE), output_constant(false),
+    scheduled(false), changed(true), output_cached(false),
+    output_reused(false)
 {
     if(COLORBLIND_ON)
     {
@@ -169,65 +207,23 @@ Module::Module(ModuleType _module_type) :
         secondary_module_color = colors[1];
     }
 
+    smoothed_inputs.reserve(inputs.size());
+
     std::cout << "Module \"" << name << "\" created" << std::endl;
 }
 
 /*
- * Destructor.
+ * Destructor. By the time a module is deleted, it has already been removed
+ * via remove_module(), and the audio thread is no longer using it.
  */
 Module::~Module()
 {
-    // Lock audio to avoid interfering with processing
-    SDL_LockAudio();
-
-    // Remove this module from the vector of modules
-    for(unsigned int i = 0; i < MODULES.size(); i ++)
-    {
-        if(MODULES[i] != NULL && MODULES[i] == this)
-        {
-            MODULES[i] = NULL;
-        }
-    }
-
-    // Cancel any inputs that this module is outputting to
-    for(auto it1 = MODULES.begin(); it1 != MODULES.end(); it1 ++)
-    {
-        if(*it1 != NULL)
-        {
-            for(auto it2 = (*it1)->inputs.begin(); it2 != (*it1)->inputs.end(); it2 ++)
-            {
-                if((*it2).from == this)
-                {
-                    std::cout << it2 - (*it1)->inputs.begin() << std::endl;
-                    (*it1)->cancel_input(it2 - (*it1)->inputs.begin());
-                }
-            }
-        }
-    }
-
-    // Erase this module from the vector of modules
-    for(unsigned int i = 0; i < MODULES.size(); i ++)
-    {
-        if(MODULES[i] != NULL && MODULES[i] == this)
-        {
-            MODULES.erase(MODULES.begin() + i);
-        }
-    }
-
     // Delete all graphics objects
     for(auto it = graphics_objects.begin();
         it != graphics_objects.end(); it ++)
     {
         delete it->second;
     }
-
-    // Mark modules changed so that they will be re-rendered
-    MODULES_CHANGED = true;
-
-    std::cout << "Module \"" << name << "\" removed" << std::endl;
-
-    // Unlock audio
-    SDL_UnlockAudio();
 }
 
 /*
@@ -250,7 +246,8 @@ void Module::handle_text_box_event(Text_Box *text_box)
     // to output to the input associated with the text box
     else
     {
-        Module *src = find_module(&text_box->text.text);
+        unsigned int src_output;
+        Module *src = find_module(&text_box->text.text, &src_output);
         // If the module is not found, inform the user, take no action
         if(src == nullptr)
         {
@@ -281,14 +278,13 @@ void Module::handle_text_box_event(Text_Box *text_box)
         {
             Toggle_Button *toggle_button = inputs[input_num].toggle_button;
 
-            set(input_num, src);
+            set(input_num, src, src_output);
             if(toggle_button != nullptr)
             {
                 toggle_button->b = true;
             }
             text_box->update_current_text(
-                text_box->text.text.substr(0, 3) + " "
-                + text_box->text.text.substr(text_box->text.text.find(" ") + 1));
+                src->get_short_output_name(src_output));
         }
     }
 }
@@ -305,7 +301,7 @@ void Module::handle_toggle_button_event(Toggle_Button *toggle_button)
     Text_Box *text_box = inputs[input_num].text_box;
 
     // Input is live, cancel input, reset associated text box and toggle button
-    if(inputs[input_num].live)
+    if(inputs[input_num].from != nullptr)
     {
         cancel_input(input_num);
         text_box->update_current_text(text_box->prompt_text.text);
@@ -353,14 +349,24 @@ bool Module::handle_event(Graphics_Object *g)
     // return true if successful, false otherwise
     else if(g == graphics_objects["background rect"])
     {
-        return module_selected();
+        return module_selected(0);
+    }
+    // If a toggle button that selects one of this module's other outputs is
+    // clicked and select source mode is active, attempt to set that output as
+    // the source for an input to another module instead
+    else if(SELECTING_SRC
+            && toggle_button_to_output_num.find((Toggle_Button *) g)
+               != toggle_button_to_output_num.end())
+    {
+        return module_selected(
+            toggle_button_to_output_num[(Toggle_Button *) g]);
     }
     // If this is not the output module and the remove module button is
-    // pressed, delete this module, return true
+    // pressed, remove this module, return true
     else if(module_type != OUTPUT
             && g == graphics_objects["remove module button"])
     {
-        delete this;
+        remove_module(this);
         return true;
     }
     // If a text box is interacted with, and we aren't in select source mode,
@@ -383,6 +389,74 @@ bool Module::handle_event(Graphics_Object *g)
     return false;
 }
 
+/*
+ * Restore this module's unique information from the lines of text output by
+ * get_unique_text_representation(). This is the default implementation, for
+ * module types that have no unique information to restore.
+ */
+void Module::set_unique_text_representation(std::vector<std::string> *lines)
+{}
+
+/*
+ * Return how many inputs are saved in a text representation with the given
+ * number of lines. This is the default implementation, for module types that
+ * have always had the same inputs.
+ */
+unsigned int Module::saved_inputs(unsigned int num_lines)
+{
+    return inputs.size();
+}
+
+/*
+ * Return whether or not the given input can read a signal calculated at
+ * control rate. This is the default implementation, for inputs that carry
+ * audio or gates, but derived module classes may override it for inputs that
+ * only modulate them.
+ */
+bool Module::reads_control_rate(unsigned int input_num)
+{
+    return false;
+}
+
+/*
+ * Return whether or not the given input will be read during the next block.
+ * This is the default implementation, for module types that read every input
+ * they have, but derived module classes may override it to let the modules
+ * they would ignore go dormant.
+ */
+bool Module::reads_input(unsigned int input_num)
+{
+    return true;
+}
+
+/*
+ * Return whether or not this module can skip blocks that nothing reads. This
+ * is the default implementation, for module types whose state would be wrong
+ * after skipping blocks, but derived module classes may override it.
+ */
+bool Module::can_go_dormant()
+{
+    return false;
+}
+
+/*
+ * Move this module's state on while it is dormant. This is the default
+ * implementation, for module types with no state that moves with time, but
+ * derived module classes may override it.
+ */
+void Module::skip(unsigned int num_samples)
+{}
+
+/*
+ * Return whether or not processing this module again would give the same
+ * output. This is the default implementation, for module types whose output
+ * moves on with time, but derived module classes may override it.
+ */
+bool Module::output_static()
+{
+    return false;
+}
+
 /*
  * This function determines the locations of this module's graphics objects
  * based on how many inputs are detected for this module type. This is the
@@ -464,36 +538,205 @@ void Module::initialize_unique_graphics_objects()
 }
 
 /*
- * This function calls upon this module's dependencies
- * to process samples.
+ * This function stores the sample at index i from each of the input buffers as
+ * floats in their input struct's respective value variable.
+ * This is essentially just updating the locally stored values for each parameter.
  */
-void Module::process_dependencies()
+void Module::update_input_vals(int i)
 {
-    for(unsigned int i = 0; i < inputs.size(); i ++)
+    for(unsigned int j = 0; j < inputs.size(); j ++)
     {
-        if(inputs[i].live && !inputs[i].from->processed)
+        if(inputs[j].live)
         {
-            inputs[i].from->process();
+            inputs[j].val = inputs[j].in[i];
         }
     }
 }
 
 /*
- * This function stores the sample at index i from each of the input buffers as
- * floats in their input struct's respective value variable.
- * This is essentially just updating the locally stored values for each parameter.
+ * Start moving the given input towards the given value over the smoothing
+ * time. Set it right away instead if it has nowhere to be smoothed in, if the
+ * smoothing time is 0, or if the ramp would never be processed, because audio
+ * is off or this module is not in the execution plan in use. An input already
+ * being smoothed heads for the new value from wherever it has got to.
  */
-void Module::update_input_vals(int i)
+void Module::smooth_input(int input_num, float val)
 {
-    for(unsigned int j = 0; j < inputs.size(); j ++)
+    Parameter *input = &inputs[input_num];
+    unsigned int samples = SMOOTHING_TIME * SAMPLE_RATE / 1000;
+
+    if(input->ramp == nullptr || samples == 0 || !AUDIO_ON || !scheduled)
     {
-        if(inputs[j].live)
+        jump_input(input_num, val);
+        return;
+    }
+
+    if(input->smoothing_samples == 0)
+    {
+        smoothed_inputs.push_back(input_num);
+    }
+    input->target = val;
+    input->smoothing_samples = samples;
+    input->smoothing_ratio = pow(SMOOTHING_REMAINDER, 1.0 / samples);
+    changed = true;
+}
+
+/*
+ * Set the given input to the given value right away. If it was being
+ * smoothed, it stops, and its target becomes the new value.
+ */
+void Module::jump_input(int input_num, float val)
+{
+    Parameter *input = &inputs[input_num];
+
+    if(input->smoothing_samples != 0)
+    {
+        for(unsigned int k = 0; k < smoothed_inputs.size(); k ++)
+        {
+            if(smoothed_inputs[k] == (unsigned int) input_num)
+            {
+                smoothed_inputs[k] = smoothed_inputs.back();
+                smoothed_inputs.pop_back();
+                break;
+            }
+        }
+    }
+
+    input->val = val;
+    input->target = val;
+    input->smoothing_samples = 0;
+    changed = true;
+}
+
+/*
+ * Fill the ramp of every input being smoothed for the given number of
+ * samples, then point the input at it, so that the module processes it as
+ * though it were live. Along a straight line, each block heads for the target
+ * from the current value, so that the line ends at the target. Along a
+ * one-pole curve, the distance left shrinks by the same ratio every sample.
+ * Once the smoothing time is up, the rest of the ramp is the target. An input
+ * connected to a module since it started being smoothed stops being smoothed.
+ */
+void Module::start_smoothing(unsigned int num_samples)
+{
+    for(unsigned int k = 0; k < smoothed_inputs.size();)
+    {
+        Parameter *input = &inputs[smoothed_inputs[k]];
+        unsigned int samples = std::min(input->smoothing_samples,
+                                        num_samples);
+
+        if(input->live)
+        {
+            input->smoothing_samples = 0;
+            smoothed_inputs[k] = smoothed_inputs.back();
+            smoothed_inputs.pop_back();
+            continue;
+        }
+
+        if(SMOOTHING_EXPONENTIAL)
+        {
+            curve_samples(input->target,
+                          input->target + (input->val - input->target)
+                                          * input->smoothing_ratio,
+                          input->smoothing_ratio, input->ramp, samples);
+        }
+        else
+        {
+            float increment = (input->target - input->val)
+                              / input->smoothing_samples;
+
+            ramp_samples(input->val + increment, increment, input->ramp,
+                         samples);
+        }
+        std::fill(input->ramp + samples, input->ramp + num_samples,
+                  input->target);
+
+        input->in = input->ramp;
+        input->live = true;
+        k ++;
+    }
+}
+
+/*
+ * Leave every input being smoothed at the last sample of its ramp for the
+ * given number of samples, and stop smoothing the ones that have reached
+ * their targets.
+ */
+void Module::finish_smoothing(unsigned int num_samples)
+{
+    for(unsigned int k = 0; k < smoothed_inputs.size();)
+    {
+        Parameter *input = &inputs[smoothed_inputs[k]];
+
+        input->in = nullptr;
+        input->live = false;
+
+        if(input->smoothing_samples <= num_samples)
+        {
+            input->val = input->target;
+            input->smoothing_samples = 0;
+            smoothed_inputs[k] = smoothed_inputs.back();
+            smoothed_inputs.pop_back();
+        }
+        else
         {
-            inputs[j].val = inputs[j].in->at(i);
+            input->val = input->ramp[num_samples - 1];
+            input->smoothing_samples -= num_samples;
+            k ++;
         }
     }
 }
 
+/*
+ * Set every input being smoothed to its target right away, for a module that
+ * is no longer processed, so that its ramps would never finish.
+ */
+void Module::stop_smoothing()
+{
+    while(!smoothed_inputs.empty())
+    {
+        unsigned int input_num = smoothed_inputs.back();
+
+        jump_input(input_num, inputs[input_num].target);
+    }
+}
+
+/*
+ * Return whether or not the given input reads a module whose output is
+ * silent for the whole block being processed.
+ */
+bool Module::input_silent(unsigned int input_num)
+{
+    return inputs[input_num].live && inputs[input_num].constant
+           && inputs[input_num].in[0] == 0;
+}
+
+/*
+ * Given one point for every control period at the start of the output buffer,
+ * each the last sample of its period, and the last sample of the previous
+ * block, fill the given number of samples with straight lines between them.
+ * The last period may be shorter than the rest. The periods are filled from
+ * last to first, since each period starts after the points it is drawn
+ * between, except for the first, whose point is read before it is
+ * overwritten.
+ */
+void Module::interpolate_control_points(float previous,
+                                        unsigned int num_samples)
+{
+    unsigned int num_points = (num_samples + CONTROL_PERIOD - 1)
+                              / CONTROL_PERIOD;
+
+    for(unsigned int i = num_points; i -- > 0;)
+    {
+        unsigned int start = i * CONTROL_PERIOD;
+        unsigned int length = std::min(num_samples - start, CONTROL_PERIOD);
+        float from = i == 0 ? previous : out[i - 1];
+        float increment = (out[i] - from) / length;
+
+        ramp_samples(from + increment, increment, out + start, length);
+    }
+}
+
 /*
  * Use the upper left pixel of the module to calculate the locations of all
  * graphics objects, including those unique to this module type via
@@ -593,16 +836,28 @@ void Module::update_graphics_object_locations()
 
 /*
  * Set the parameter specified by input num to the value
- * specified by val.
+ * specified by val, smoothly.
  */
 void Module::set(int input_num, float val)
 {
-    // Set the input and dependency to NULL,
-    // the float to val, and the live boolean to false
-    inputs[input_num].in = NULL;
-    inputs[input_num].val = val;
-    inputs[input_num].live = false;
+    set(input_num, val, true);
+}
+
+/*
+ * Set the parameter specified by input num to the value specified by val. If
+ * smooth is true, the parameter moves there over the smoothing time while
+ * audio is on, otherwise it jumps straight there, for example while loading a
+ * patch.
+ */
+void Module::set(int input_num, float val, bool smooth)
+{
+    bool was_live = inputs[input_num].from != nullptr;
+    Command_Queue::Command command;
+
+    // Set the dependency to NULL
     inputs[input_num].from = NULL;
+    inputs[input_num].from_output = 0;
+    inputs[input_num].saved_val = val;
 
     // Reset the input toggle button associated with this text box, if
     // applicable (some inputs do not allow live value updating)
@@ -613,6 +868,33 @@ void Module::set(int input_num, float val)
 
     adopt_input_colors();
 
+    // If this parameter was live, the execution plan no longer needs to
+    // account for its source module
+    if(was_live)
+    {
+        update_execution_plan();
+    }
+
+    // Have the audio thread set the input to val, smoothly if asked to, this
+    // is posted after the new execution plan is published so that the audio
+    // thread is guaranteed to have stopped updating the value from the source
+    // module by the time it is set, and the audio thread is given somewhere to
+    // smooth the value in first, only while audio is on, and only for inputs
+    // that can read a signal that changes gradually
+    if(smooth && AUDIO_ON && inputs[input_num].ramp == nullptr
+       && reads_control_rate(input_num))
+    {
+        ramp_buffers.push_back(std::vector<float>(BUFFER_SIZE));
+        inputs[input_num].ramp = ramp_buffers.back().data();
+    }
+
+    command.command_type = smooth ? Command_Queue::SET_VALUE
+                                  : Command_Queue::JUMP_VALUE;
+    command.module = this;
+    command.input_num = input_num;
+    command.val = val;
+    COMMAND_QUEUE.post(command);
+
     std::cout << name << " " << parameter_names.at(module_type).at(input_num)
               << " changed to " << val << std::endl;
 }
@@ -623,15 +905,23 @@ void Module::set(int input_num, float val)
  */
 void Module::set(int input_num, Module *src)
 {
-    // Set the input to the output of src, the dependency to src,
-    // the live boolean to true
-    inputs[input_num].in = &src->out;
-    inputs[input_num].live = true;
+    set(input_num, src, 0);
+}
+
+/*
+ * Set the parameter specified to be updated by the given output of the module
+ * specified, 0 for its main output.
+ */
+void Module::set(int input_num, Module *src, unsigned int src_output)
+{
+    // Set the dependency to src, the input will read from the output of src
+    // once the execution plan is recompiled
     inputs[input_num].from = src;
+    inputs[input_num].from_output = src_output;
 
     // If this is the output module, update the waveforms to display
     // the proper audio buffers
-    if(module_type == OUTPUT)
+    if(module_type == OUTPUT && graphics_objects_initialized)
     {
         Waveform *waveform;
         if(input_num == Output::OUTPUT_INPUT_L)
@@ -642,17 +932,21 @@ void Module::set(int input_num, Module *src)
         {
             waveform = (Waveform *) graphics_objects["waveform right"];
         }
-        waveform->buffer = &src->out;
+        waveform->buffer = src->get_output(src_output);
     }
 
     // Set the colors of the text box to be the colors of the source module
     adopt_input_colors();
 
+    // Recompile the execution plan so that src is processed before this module
+    update_execution_plan();
+
     // Ensure that the input toggle button associated with this input is turned
     // on
 
     std::cout << name << " " << parameter_names.at(module_type).at(input_num)
-              << " is now coming from " << src->name << std::endl;
+              << " is now coming from " << src->get_output_name(src_output)
+              << std::endl;
 }
 
 /*
@@ -662,32 +956,36 @@ void Module::set(int input_num, Module *src)
  */
 void Module::cancel_input(int input_num)
 {
-    Text_Box *text_box =
-        ((Text_Box *) graphics_objects[parameter_names.at(module_type).at(input_num) + " text box"]);
-    Toggle_Button *toggle_button =
-        ((Toggle_Button *) graphics_objects[parameter_names.at(module_type).at(input_num) + " toggle button"]);
+    Text_Box *text_box = inputs[input_num].text_box;
+    Toggle_Button *toggle_button = inputs[input_num].toggle_button;
 
-    // Set the input and dependency to NULL,
-    // and the live boolean to false
-    inputs[input_num].in = nullptr;
-    inputs[input_num].live = false;
+    // Set the dependency to NULL, the input will stop reading from it once the
+    // execution plan is recompiled
     inputs[input_num].from = nullptr;
+    inputs[input_num].from_output = 0;
 
     // Reset the input text box and input toggle button associated with this
-    // input
-    if(text_box->prompt_text.text == "input")
+    // input, if there are any (there are none when rendering without graphics)
+    if(text_box != nullptr)
     {
-        text_box->update_current_text("");
+        if(text_box->prompt_text.text == "input")
+        {
+            text_box->update_current_text("");
+        }
+        else
+        {
+            text_box->update_current_text(
+                std::to_string(inputs[input_num].val));
+        }
     }
-    else
+    if(toggle_button != nullptr)
     {
-        text_box->update_current_text(std::to_string(inputs[input_num].val));
+        toggle_button->b = false;
     }
-    toggle_button->b = false;
 
     // If this is the output module, update the waveforms to display
     // an empty audio buffer
-    if(module_type == OUTPUT)
+    if(module_type == OUTPUT && graphics_objects_initialized)
     {
         Waveform *waveform;
         if(input_num == Output::OUTPUT_INPUT_L)
@@ -703,6 +1001,9 @@ void Module::cancel_input(int input_num)
 
     adopt_input_colors();
 
+    // Recompile the execution plan without the cancelled dependency
+    update_execution_plan();
+
     std::cout << name << " " << parameter_names.at(module_type).at(input_num)
               << " input cancelled" << std::endl;
 }
@@ -725,6 +1026,41 @@ std::string Module::get_short_name()
     return name.substr(0, 3) + " " + name.substr(name.find(" ") + 1);
 }
 
+/*
+ * Return where the given output of this module points, 0 for its main output.
+ */
+float **Module::get_output(unsigned int output_num)
+{
+    return output_num == 0 ? &out : &extra_outs[output_num - 1];
+}
+
+/*
+ * Return this module's name, followed by the name of the given output unless
+ * it is the main output. For example, the bandpass output of "filter 1" is
+ * "filter 1:bp".
+ */
+std::string Module::get_output_name(unsigned int output_num)
+{
+    if(output_num == 0)
+    {
+        return name;
+    }
+    return name + ":" + extra_output_names[output_num - 1];
+}
+
+/*
+ * Return this module's short name, followed by the name of the given output
+ * unless it is the main output.
+ */
+std::string Module::get_short_output_name(unsigned int output_num)
+{
+    if(output_num == 0)
+    {
+        return get_short_name();
+    }
+    return get_short_name() + ":" + extra_output_names[output_num - 1];
+}
+
 /*
  * Return a text representation of this module. It should contain any
  * information necessary to reconstruct the module.
@@ -734,9 +1070,11 @@ std::string Module::get_text_representation()
     std::string result;
 
     result += std::to_string(module_type) + " (" + name + ")" + "\n";
+    // Each input is saved at the value last set from this thread, not
+    // wherever the audio thread has got to smoothing it
     for(unsigned int i = 0; i < inputs.size(); i ++)
     {
-        result += std::to_string(inputs[i].val) + "\n";
+        result += std::to_string(inputs[i].saved_val) + "\n";
     }
     for(unsigned int i = 0; i < inputs.size(); i ++)
         if(inputs[i].from == NULL)
@@ -745,7 +1083,8 @@ std::string Module::get_text_representation()
         }
         else
         {
-            result += inputs[i].from->name + "\n";
+            result += inputs[i].from->get_output_name(
+                          inputs[i].from_output) + "\n";
         }
 
     result += this->get_unique_text_representation();
@@ -770,7 +1109,7 @@ void Module::adopt_input_colors()
         if(it->second->graphics_object_type == TEXT_BOX)
         {
             dependency_num = text_box_to_input_num[((Text_Box *) it->second)];
-            if(inputs[dependency_num].live)
+            if(inputs[dependency_num].from != nullptr)
             {
                 ((Text_Box *) it->second)->set_colors(
                     inputs[dependency_num].from->primary_module_color,
@@ -797,10 +1136,11 @@ void Module::adopt_input_colors()
  *    with the input it is now the source for
  *  - set the current input toggle button back to none
  * However, if the type of this module is the output module, don't do anything!
- * The output module cannot be the source for any inputs. Return true if action
+ * The output module cannot be the source for any inputs. The input reads the
+ * given output of this module, 0 for its main output. Return true if action
  * was taken, false otherwise.
  */
-bool Module::module_selected()
+bool Module::module_selected(unsigned int output_num)
 {
     if(module_type == OUTPUT)
     {
@@ -819,11 +1159,11 @@ bool Module::module_selected()
     {
         int input_num = SELECTING_FOR_MODULE->toggle_button_to_input_num[CURRENT_TOGGLE_BUTTON];
 
-        SELECTING_FOR_MODULE->set(input_num, this);
+        SELECTING_FOR_MODULE->set(input_num, this, output_num);
         CURRENT_TOGGLE_BUTTON->b = true;
         SELECTING_SRC = false;
         SELECTING_FOR_MODULE->inputs[input_num].text_box->update_current_text(
-            get_short_name());
+            get_short_output_name(output_num));
         // If it's the output module, set the waveform's buffer
         if(SELECTING_FOR_MODULE->module_type == OUTPUT)
         {
@@ -833,7 +1173,7 @@ bool Module::module_selected()
             {
                 ((Waveform *)
                  MODULES[0]->graphics_objects["waveform left"])->buffer =
-                     &this->out;
+                     get_output(output_num);
             }
             // Else, update the right waveform
             else if(CURRENT_TOGGLE_BUTTON
@@ -841,7 +1181,7 @@ bool Module::module_selected()
             {
                 ((Waveform *)
                  MODULES[0]->graphics_objects["waveform right"])->buffer =
-                     &this->out;
+                     get_output(output_num);
             }
         }
         CURRENT_TOGGLE_BUTTON = nullptr;
@@ -881,8 +1221,8 @@ void Module::render()
 /*
  * Pass along a click to the specific graphics object that has been clicked.
  * Graphics objects should only respond to clicks if selecting source mode is
- * inactive, or if it is the background rectangle (clicks of the background
- * rectangle are how source selection happens).
+ * inactive, or if it is the background rectangle or a toggle button that
+ * selects another output (clicks of those are how source selection happens).
  */
 bool Module::clicked()
 {
@@ -892,8 +1232,11 @@ bool Module::clicked()
         if(it->second->mouse_over())
         {
             // Only respond to a click if it's not selecting source mode, or if
-            // a background rectangle is being clicked
-            if(!SELECTING_SRC || it->second->graphics_object_type == RECT)
+            // a background rectangle or another output is being clicked
+            if(!SELECTING_SRC || it->second->graphics_object_type == RECT
+               || toggle_button_to_output_num.find(
+                      (Toggle_Button *) it->second)
+                  != toggle_button_to_output_num.end())
             {
                 if(it->second->clicked())
                 {
@@ -11,6 +11,8 @@
  *   - Noise
  *   - Oscillator
  *   - Output
+ *   - Poly
+ *   - SAH
  */
 
 #ifndef MSS_MODULE_HPP
@@ -21,6 +23,7 @@
  ************/
 
 // Included libraries
+#include <atomic>
 #include <map>
 
 // Included SDL components
@@ -55,25 +58,56 @@ public:
         NOISE,
         OSCILLATOR,
         OUTPUT,
-        SAH
+        SAH,
+        POLY
     };
 
-    // A struct to represent a parameter for a module
+    // Signal rate enum, the rates at which a module's output may be
+    // calculated, either every sample, or once every control period with the
+    // samples in between interpolated
+    enum SignalRate
+    {
+        AUDIO_RATE = 0,
+        CONTROL_RATE
+    };
+
+    // A struct to represent a parameter for a module. The from module and
+    // the saved value belong to the main thread, everything read during
+    // processing is only changed by the audio thread, via the command queue
     struct Parameter
     {
         // Parameter value
         float val = 0;
-        // Module that is generating values for this parameter
+        // The value this parameter was last set to by the main thread, which
+        // is the value saved in patches while the audio thread moves val
+        float saved_val = 0;
+        // Module that is generating values for this parameter, and which of
+        // its outputs, 0 for its main output
         Module *from = nullptr;
+        unsigned int from_output = 0;
         // Output buffer of the from module
-        std::vector<float> *in = nullptr;
+        float *in = nullptr;
         // Whether or not this parameter is currently being updated with values
         // generated by the from module
         bool live = false;
+        // Whether or not the from module's output is the same for every sample
+        // of the block being processed, set by the execution plan before this
+        // module is processed
+        bool constant = false;
         // The text box associated with this input
         Text_Box *text_box = nullptr;
         // The toggle button associated with this input
         Toggle_Button *toggle_button = nullptr;
+        // The value this parameter is being smoothed towards, the number of
+        // samples left until it gets there, and how much closer it gets each
+        // sample along a one-pole curve
+        float target = 0;
+        unsigned int smoothing_samples = 0;
+        float smoothing_ratio = 0;
+        // BUFFER_SIZE samples of the smoothed value for the block being
+        // processed, owned by the module, or nullptr if this parameter has
+        // never been smoothed
+        float *ramp = nullptr;
     };
 
     // Maps of useful information about modules, defined in Module.cpp
@@ -88,13 +122,15 @@ public:
     std::map<Text_Box *, int> text_box_to_input_num;
     //   Map of toggle button references and their associated input numbers
     std::map<Toggle_Button *, int> toggle_button_to_input_num;
+    //   Map of toggle button references that select one of this module's
+    //   other outputs as the source for an input, and their output numbers
+    std::map<Toggle_Button *, unsigned int> toggle_button_to_output_num;
 
     // Module information
     ModuleType module_type;
     SDL_Color primary_module_color;
     SDL_Color secondary_module_color;
     int number;
-    bool processed;
     SDL_Point upper_left;
     bool graphics_objects_initialized;
     // A vector containing any graphics objects necessary for rendering this
@@ -104,18 +140,50 @@ public:
     // A vector of inputs, accessed for any processing operations that depend
     // on the output of other modules
     std::vector<Parameter> inputs;
-    // Output buffer
-    std::vector<float> out;
+    // The input numbers of the inputs being smoothed towards new values, only
+    // touched by the audio thread, with room for every input reserved up
+    // front, and the buffers the inputs are smoothed in, only touched by the
+    // main thread
+    std::vector<unsigned int> smoothed_inputs;
+    std::vector<std::vector<float>> ramp_buffers;
+    // Output buffer, BUFFER_SIZE samples long, which lives in the arena of the
+    // execution plan currently in use, see Execution_Plan
+    float *out;
+    // The buffers of any outputs this module has besides its main output,
+    // numbered from 1, each BUFFER_SIZE samples long and owned by the module,
+    // where the module outputs to, which the execution plan moves along with
+    // out when it processes the module a sample at a time, and their names
+    std::vector<std::vector<float>> extra_buffers;
+    std::vector<float *> extra_outs;
+    std::vector<std::string> extra_output_names;
+    // The rate at which the output may be calculated while the execution plan
+    // currently in use is, set by the audio thread, see Execution_Plan
+    SignalRate rate;
+    // Whether or not every sample of the output buffer was the same during
+    // the last block, set by the audio thread, see Execution_Plan
+    bool output_constant;
+    // Whether or not the execution plan currently in use processes this
+    // module, set by the audio thread, see Execution_Plan
+    bool scheduled;
+    // Whether or not an input value or a setting has changed since this
+    // module was last processed, set by whichever thread changes it, and
+    // whether or not the output buffer holds what processing this module
+    // again would output, and was reused instead during the last block, set
+    // by the audio thread, see Execution_Plan
+    std::atomic<bool> changed;
+    bool output_cached;
+    bool output_reused;
 
     // Constructor and destructor
     Module(ModuleType);
     virtual ~Module();
 
     // Virtual member functions
-    //   Process audio for the output buffer
+    //   Process audio for the given number of samples at the start of the
+    //   output buffer, usually BUFFER_SIZE
     //   Each derived module class must define its own signal processing
     //   capabilities
-    virtual void process() = 0;
+    virtual void process(unsigned int) = 0;
     //   Handle user interactions with the graphics objects that make up the
     //   visual representation of this module, return true if any action was
     //   taken, false otherwise
@@ -125,6 +193,42 @@ public:
     //   a text representation of itself
     //   This function is used to save patches as text files
     virtual std::string get_unique_text_representation() = 0;
+    //   Restore the module's unique information from the lines of text
+    //   output by get_unique_text_representation()
+    //   This function is used to load patches from text files, the default
+    //   implementation does nothing, for module types with no unique
+    //   information
+    virtual void set_unique_text_representation(std::vector<std::string> *);
+    //   Return how many inputs are saved in a text representation with the
+    //   given number of lines between its first line and DONE, resizing the
+    //   inputs to match for module types with a varying number of inputs
+    //   This function is used to load patches from text files, the default
+    //   implementation returns the number of inputs, for module types that
+    //   have always had the same inputs
+    virtual unsigned int saved_inputs(unsigned int);
+    //   Return whether or not the given input can read a signal calculated at
+    //   control rate, the default implementation returns false, for inputs
+    //   that need every sample, so module types must opt in input by input
+    virtual bool reads_control_rate(unsigned int);
+    //   Return whether or not the given input will be read during the next
+    //   block given the current parameters, the default implementation
+    //   returns true, for module types that read every input they have
+    virtual bool reads_input(unsigned int);
+    //   Return whether or not this module can skip blocks that nothing reads,
+    //   filling its output buffer with silence instead, the default
+    //   implementation returns false, for module types whose state has to keep
+    //   up with their inputs, such as envelopes and delay lines
+    virtual bool can_go_dormant();
+    //   Move this module's state on by the given number of samples while it
+    //   is dormant, without filling its output buffer, the default
+    //   implementation does nothing, for module types whose output does not
+    //   depend on how long they have been running
+    virtual void skip(unsigned int);
+    //   Return whether or not processing this module again would give the
+    //   output it just gave, as long as its inputs and settings stay the same,
+    //   the default implementation returns false, for module types whose
+    //   output moves on with time
+    virtual bool output_static();
     //   Calculate the locations of graphics objects unique to this module type
     //   This function should have a defualt implementation, but should also
     //   be possible to override
@@ -135,11 +239,29 @@ public:
     virtual void initialize_unique_graphics_objects();
 
     // Member functions
-    //   Process all modules that this module depends upon
-    void process_dependencies();
     //   Grab samples from index i in all input buffers, store them as
     //   individual floats
     void update_input_vals(int);
+    //   Move an input smoothly towards a new value, or set it right away if
+    //   it cannot be smoothed, called from the audio thread only
+    void smooth_input(int, float);
+    //   Set an input to a new value right away, abandoning any smoothing,
+    //   called from the audio thread only
+    void jump_input(int, float);
+    //   Point every input being smoothed at its ramp for the given number of
+    //   samples, and once they are processed, leave each at the end of its
+    //   ramp
+    void start_smoothing(unsigned int);
+    void finish_smoothing(unsigned int);
+    //   Set every input being smoothed to its target right away
+    void stop_smoothing();
+    //   Return whether or not an input reads nothing but silence during the
+    //   block being processed
+    bool input_silent(unsigned int);
+    //   Given the points calculated at control rate at the start of the output
+    //   buffer, the last sample of each control period, fill the given number
+    //   of samples by interpolating from the given sample before them
+    void interpolate_control_points(float, unsigned int);
     //   Initialize all graphics objects in this module
     void initialize_graphics_objects();
     //   Calculate the locations of all graphics objects in this module
@@ -150,16 +272,24 @@ public:
     void handle_text_box_event(Text_Box *);
     //   Handle user interactions with toggle button objects
     void handle_toggle_button_event(Toggle_Button *);
-    //   Set a parameter to a certain value
+    //   Set a parameter to a certain value, smoothly or not
     void set(int, float);
-    //   Set a parameter to be updated by another module's output
+    void set(int, float, bool);
+    //   Set a parameter to be updated by another module's main output, or by
+    //   the given one of its outputs
     void set(int, Module *);
+    void set(int, Module *, unsigned int);
     //   Cancel input for a certain parameter
     void cancel_input(int);
     //   Return module name
     std::string get_name();
     //   Return module short name
     std::string get_short_name();
+    //   Return where the given output of this module is, and the name and
+    //   short name of the module followed by the name of the output
+    float **get_output(unsigned int);
+    std::string get_output_name(unsigned int);
+    std::string get_short_output_name(unsigned int);
     //   Output the module as text
     //   This function is used to save patches as text files
     std::string get_text_representation();
@@ -167,8 +297,8 @@ public:
     //   modules are outputting to the inputs associated with them
     void adopt_input_colors();
     //   Do what is necessary to become the module outputting to an input on 
-    //   another module
-    bool module_selected();
+    //   another module, through the given output
+    bool module_selected(unsigned int);
     //   Render this module to the window
     void render();
     //   Handle a click
@@ -8,6 +8,8 @@
  ************/
 
 // Included libraries
+#include <algorithm>
+#include <climits>
 #include <cmath>
 #include <iostream>
 #include <string>
@@ -21,12 +23,87 @@
 #include "graphics_object_utils.hpp"
 #include "image_processing.hpp"
 #include "main.hpp"
+#include "signal_kernels.hpp"
 #include "signal_processing.hpp"
 
 // Included modules classes
 #include "Module.hpp"
 #include "Modules/Adsr.hpp"
 
+/*************
+ * CONSTANTS *
+ *************/
+
+// An exponential stage heads for a target past the amplitude it ends at, so
+// that it ends in the stage's time rather than only ever getting closer. The
+// attack overshoots by a lot, for the rise of an analog envelope, the decay
+// and release overshoot by -60 dB.
+static const double ATTACK_OVERSHOOT = .3;
+static const double DECAY_OVERSHOOT = .001;
+
+/********************
+ * HELPER FUNCTIONS *
+ ********************/
+
+/*
+ * Return the amplitude the given number of samples along a segment from the
+ * given amplitude.
+ */
+static double segment_amplitude(const Adsr::Segment &segment,
+                                double amplitude, unsigned int samples)
+{
+    if(segment.exponential)
+    {
+        return segment.target
+               + (amplitude - segment.target) * pow(segment.rate, samples);
+    }
+
+    return amplitude + segment.rate * samples;
+}
+
+/*
+ * Return whether or not the given amplitude is at or past the end of a
+ * segment.
+ */
+static bool segment_ended(const Adsr::Segment &segment, double amplitude)
+{
+    return segment.rising ? amplitude >= segment.end
+                          : amplitude <= segment.end;
+}
+
+/*
+ * Return the number of samples from the given amplitude up to and including
+ * the sample after which a segment ends, or UINT_MAX if it never ends because
+ * it moves away from its end, or not at all.
+ */
+static unsigned int segment_length(const Adsr::Segment &segment,
+                                   double amplitude)
+{
+    double samples;
+
+    if(segment_ended(segment, amplitude))
+    {
+        return 1;
+    }
+
+    if(segment.exponential)
+    {
+        samples = log((segment.end - segment.target)
+                      / (amplitude - segment.target)) / log(segment.rate);
+    }
+    else
+    {
+        samples = (segment.end - amplitude) / segment.rate;
+    }
+
+    if(std::isnan(samples) || samples < 0 || samples >= UINT_MAX)
+    {
+        return UINT_MAX;
+    }
+
+    return std::max(1.0, ceil(samples));
+}
+
 /*************************
  * ADSR MEMBER FUNCTIONS *
  *************************/
@@ -36,12 +113,16 @@
  */
 Adsr::Adsr() :
     Module(ADSR),
-    current_amplitude(0), adsr_stage(ADSR_A_STAGE)
+    current_amplitude(0), adsr_stage(ADSR_A_STAGE), curve(LINEAR),
+    linear_on(true), exponential_on(false), segment_curve(LINEAR)
 {
     inputs[ADSR_A].val = 500;
     inputs[ADSR_D].val = 500;
     inputs[ADSR_S].val = 1;
     inputs[ADSR_R].val = 500;
+
+    // Make sure the segments are calculated before they are first used
+    std::fill(segment_parameters, segment_parameters + 4, NAN);
 }
 
 /*
@@ -51,119 +132,235 @@ Adsr::~Adsr()
 {}
 
 /*
- * Process all dependencies, then fill the output buffer with a waveform given
- * the data contained within this class and the audio device information.
+ * Calculate the segments of the attack, decay, and release stages, unless
+ * they were already calculated for the current envelope times, sustain, and
+ * curve. Linear stages take their time to move from 0 to 1, 1 to the
+ * sustain, and the sustain to 0, exponential attacks and decays take theirs
+ * to move the same distances, and exponential releases take theirs to move
+ * from 1 to 0.
  */
-void Adsr::process()
+void Adsr::update_segments()
 {
-    // Process any dependencies
-    process_dependencies();
+    float parameters[4] = {inputs[ADSR_A].val, inputs[ADSR_D].val,
+                           inputs[ADSR_S].val, inputs[ADSR_R].val};
 
-    // Calculate an amplitude for each sample
-    for(unsigned short i = 0; i < out.size(); i ++)
+    if(curve == segment_curve
+       && std::equal(parameters, parameters + 4, segment_parameters))
     {
-        // Update parameters
-        update_input_vals(i);
+        return;
+    }
+    std::copy(parameters, parameters + 4, segment_parameters);
+    segment_curve = curve;
+
+    double attack_samples = parameters[0] / 1000 * SAMPLE_RATE;
+    double decay_samples = parameters[1] / 1000 * SAMPLE_RATE;
+    double sustain = parameters[2];
+    double release_samples = parameters[3] / 1000 * SAMPLE_RATE;
+    Segment &attack = segments[ADSR_A_STAGE];
+    Segment &decay = segments[ADSR_D_STAGE];
+    Segment &release = segments[ADSR_R_STAGE];
+
+    attack = {curve == EXPONENTIAL, 1 / attack_samples, 0, 1, true,
+              ADSR_D_STAGE};
+    decay = {curve == EXPONENTIAL, -(1 - sustain) / decay_samples, 0,
+             sustain, false, ADSR_S_STAGE};
+    release = {curve == EXPONENTIAL, -sustain / release_samples, 0, 0, false,
+               ADSR_IDLE_STAGE};
+
+    if(curve == EXPONENTIAL)
+    {
+        attack.target = 1 + ATTACK_OVERSHOOT;
+        attack.rate = exp(-log((1 + ATTACK_OVERSHOOT) / ATTACK_OVERSHOOT)
+                          / attack_samples);
+        decay.target = sustain - DECAY_OVERSHOOT;
+        decay.rate = exp(-log((1 - sustain + DECAY_OVERSHOOT)
+                              / DECAY_OVERSHOOT) / decay_samples);
+        release.target = -DECAY_OVERSHOOT;
+        release.rate = exp(-log((1 + DECAY_OVERSHOOT) / DECAY_OVERSHOOT)
+                           / release_samples);
+    }
+}
 
-        if(!inputs[ADSR_NOTE].live)
+/*
+ * Move the envelope along by a single sample, given whether or not a note on
+ * value is detected.
+ */
+void Adsr::advance_stage(bool note_on)
+{
+    // During the attack, decay, and release stages, the amplitude moves along
+    // the stage's segment, and the next stage begins once the segment ends
+    bool moving = note_on ? adsr_stage == ADSR_A_STAGE
+                            || adsr_stage == ADSR_D_STAGE
+                          : adsr_stage == ADSR_R_STAGE;
+
+    if(moving)
+    {
+        const Segment &segment = segments[adsr_stage];
+
+        current_amplitude = segment_amplitude(segment, current_amplitude, 1);
+        if(segment_ended(segment, current_amplitude))
         {
-            inputs[ADSR_NOTE].val = 0;
+            current_amplitude = segment.end;
+            adsr_stage = segment.next_stage;
         }
+        return;
+    }
 
-        // Set the current output sample to the current amplitude
-        out[i] = current_amplitude;
+    // Otherwise, note off during the attack, decay, or sustain stage skips
+    // ahead to the release stage, note on during the release or idle stage
+    // goes back to the attack stage, and nothing else changes anything
+    if(!note_on && adsr_stage != ADSR_R_STAGE
+       && adsr_stage != ADSR_IDLE_STAGE)
+    {
+        adsr_stage = ADSR_R_STAGE;
+    }
+    else if(note_on && (adsr_stage == ADSR_R_STAGE
+                        || adsr_stage == ADSR_IDLE_STAGE))
+    {
+        adsr_stage = ADSR_A_STAGE;
+    }
+}
 
-        // Determine whether or not a note on value is detected
-        bool note_on = inputs[ADSR_NOTE].val == 1;
+/*
+ * Fill the given part of the output buffer with the envelope, while the note
+ * stays on or off for all of it. The amplitude moves along a whole segment at
+ * a time, sustains and silence are filled in all at once, and only a sample
+ * that moves the envelope to another stage is handled on its own.
+ */
+void Adsr::process_run(float *dst, unsigned int num_samples, bool note_on)
+{
+    unsigned int i = 0;
+
+    while(i < num_samples)
+    {
+        bool moving = note_on ? adsr_stage == ADSR_A_STAGE
+                                || adsr_stage == ADSR_D_STAGE
+                              : adsr_stage == ADSR_R_STAGE;
+        bool holding = note_on ? adsr_stage == ADSR_S_STAGE
+                               : adsr_stage == ADSR_IDLE_STAGE;
 
-        // Do something different based on the current envelope stage
-        switch(adsr_stage)
+        if(moving)
         {
-        // During the attack stage, note on will result in incrementing
-        // towards full amplitude and switching to the decay stage when full
-        // amplitude is reached, note off will result in skipping ahead to
-        // the release stage
-        case ADSR_A_STAGE:
-            if(note_on)
-            {
-                double increment = 1 / ((inputs[ADSR_A].val / 1000)
-                                        * SAMPLE_RATE);
-                current_amplitude += increment;
-                if(current_amplitude >= 1)
-                {
-                    current_amplitude = 1;
-                    adsr_stage = ADSR_D_STAGE;
-                }
-            }
-            else
+            const Segment &segment = segments[adsr_stage];
+            unsigned int length = segment_length(segment, current_amplitude);
+            unsigned int samples = std::min(length, num_samples - i);
+
+            if(samples == 1)
             {
-                adsr_stage = ADSR_R_STAGE;
+                dst[i] = current_amplitude;
             }
-            break;
-        // During the decay stage, note on will result in decrementing
-        // towards sustain amplitude and switching to the sustain stage once
-        // sustain amplitude is reached, note off will result in skipping
-        // ahead to the release stage
-        case ADSR_D_STAGE:
-            if(note_on)
+            else if(segment.exponential)
             {
-                double decrement = (1 - inputs[ADSR_S].val)
-                                   / ((inputs[ADSR_D].val / 1000)
-                                      * SAMPLE_RATE);
-                current_amplitude -= decrement;
-                if(current_amplitude <= inputs[ADSR_S].val)
-                {
-                    current_amplitude = inputs[ADSR_S].val;
-                    adsr_stage = ADSR_S_STAGE;
-                }
+                curve_samples(segment.target, current_amplitude, segment.rate,
+                              dst + i, samples);
             }
             else
             {
-                adsr_stage = ADSR_R_STAGE;
+                ramp_samples(current_amplitude, segment.rate, dst + i,
+                             samples);
             }
-            break;
-        // During the sustain stage, note on does nothing, note off will
-        // result in skipping ahead to the release stage
-        case ADSR_S_STAGE:
-            if(!note_on)
+
+            if(samples == length)
             {
-                adsr_stage = ADSR_R_STAGE;
+                current_amplitude = segment.end;
+                adsr_stage = segment.next_stage;
             }
-            break;
-        // During the release stage, note on will result in switching back
-        // to the attack stage, note off will result in decrementing towards
-        // 0 amplitude, and switching to the idle stage once 0 amplitude is
-        // reached
-        case ADSR_R_STAGE:
-            if(note_on)
+            else
             {
-                adsr_stage = ADSR_A_STAGE;
+                current_amplitude = segment_amplitude(segment,
+                                                      current_amplitude,
+                                                      samples);
             }
-            else
+            i += samples;
+        }
+        else if(holding)
+        {
+            std::fill(dst + i, dst + num_samples, (float) current_amplitude);
+            i = num_samples;
+        }
+        else
+        {
+            dst[i] = current_amplitude;
+            advance_stage(note_on);
+            i ++;
+        }
+    }
+}
+
+/*
+ * Fill the output buffer with a waveform given the data contained within this
+ * class and the audio device information. If none of the envelope times are
+ * live, the segments of the stages are only calculated again when the
+ * parameters change, and the block is split into runs during which the note
+ * stays on or off, read straight from its buffer.
+ */
+void Adsr::process(unsigned int num_samples)
+{
+    if(!inputs[ADSR_A].live && !inputs[ADSR_D].live && !inputs[ADSR_S].live
+       && !inputs[ADSR_R].live)
+    {
+        float *note = nullptr;
+        unsigned int i = 0;
+
+        if(inputs[ADSR_NOTE].live)
+        {
+            note = inputs[ADSR_NOTE].in;
+        }
+        else
+        {
+            inputs[ADSR_NOTE].val = 0;
+        }
+
+        update_segments();
+
+        while(i < num_samples)
+        {
+            bool note_on = note != nullptr && note[i] == 1;
+            unsigned int j = i + 1;
+
+            if(note == nullptr)
             {
-                double decrement = inputs[ADSR_S].val
-                                   / ((inputs[ADSR_R].val / 1000)
-                                      * SAMPLE_RATE);
-                current_amplitude -= decrement;
-                if(current_amplitude <= 0)
-                {
-                    adsr_stage = ADSR_IDLE_STAGE;
-                    current_amplitude = 0;
-                }
+                j = num_samples;
             }
-            break;
-        // During the idle stage, note on will result in switching to the
-        // attack stage, note off does nothing
-        case ADSR_IDLE_STAGE:
-            if(note_on)
+            while(j < num_samples && (note[j] == 1) == note_on)
             {
-                adsr_stage = ADSR_A_STAGE;
+                j ++;
             }
-            break;
+
+            process_run(out + i, j - i, note_on);
+            i = j;
         }
+
+        update_input_vals(num_samples - 1);
+        return;
+    }
+
+    // Calculate an amplitude for each sample
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        // Update parameters
+        update_input_vals(i);
+        update_segments();
+
+        if(!inputs[ADSR_NOTE].live)
+        {
+            inputs[ADSR_NOTE].val = 0;
+        }
+
+        // Set the current output sample to the current amplitude
+        out[i] = current_amplitude;
+
+        advance_stage(inputs[ADSR_NOTE].val == 1);
     }
+}
 
-    processed = true;
+/*
+ * The note input is a gate, whose edges start and release notes, so only the
+ * envelope parameters can read a signal calculated at control rate.
+ */
+bool Adsr::reads_control_rate(unsigned int input_num)
+{
+    return input_num != ADSR_NOTE;
 }
 
 /*
@@ -185,6 +382,17 @@ bool Adsr::handle_event(Graphics_Object *g)
         reset_stage();
         return true;
     }
+    // Handle curve toggle buttons
+    else if(g == graphics_objects["linear toggle button"])
+    {
+        switch_curve(LINEAR);
+        return true;
+    }
+    else if(g == graphics_objects["exponential toggle button"])
+    {
+        switch_curve(EXPONENTIAL);
+        return true;
+    }
     // If none of the above, handle events that apply to all modules, return
     // true if an event is handled
     else if(Module::handle_event(g))
@@ -209,11 +417,11 @@ void Adsr::calculate_unique_graphics_object_locations()
     graphics_object_locations["reset stage button"] = location;
 
     // Waveform viewer location
-    location = {upper_left.x, location.y + 15, MODULE_WIDTH, 54};
+    location = {upper_left.x, location.y + 15, MODULE_WIDTH, 34};
     graphics_object_locations["waveform"] = location;
 
     // Note on/off related graphics object locations
-    location = {upper_left.x + 2, location.y + 57, 0, 0};
+    location = {upper_left.x + 2, location.y + 37, 0, 0};
     graphics_object_locations["note text"] = location;
     location = {upper_left.x, location.y + 10, MODULE_WIDTH - 8, 9};
     graphics_object_locations["note text box"] = location;
@@ -245,6 +453,15 @@ void Adsr::calculate_unique_graphics_object_locations()
     graphics_object_locations["release text box"] = location;
     location = {location.x + location.w + 1, location.y, 7, 9};
     graphics_object_locations["release toggle button"] = location;
+
+    // Curve related graphics object locations
+    location = {upper_left.x + 2, location.y + 10, 0, 0};
+    graphics_object_locations["curve text"] = location;
+    location = {upper_left.x, location.y + 10, (MODULE_WIDTH / 2) - 1, 9};
+    graphics_object_locations["linear toggle button"] = location;
+    location = {location.x + location.w + 1, location.y,
+                upper_left.x + MODULE_WIDTH - location.x - location.w - 1, 9};
+    graphics_object_locations["exponential toggle button"] = location;
 }
 
 /*
@@ -273,6 +490,10 @@ void Adsr::initialize_unique_graphics_objects()
         new Text(name + " sustain/release text",
                  graphics_object_locations["sustain/release text"],
                  secondary_module_color, "SUSTAIN & RELEASE:");
+    graphics_objects["curve text"] =
+        new Text(name + " curve text",
+                 graphics_object_locations["curve text"],
+                 secondary_module_color, "CURVE:");
 
     // Initialize waveform viewer
     graphics_objects["waveform"] =
@@ -338,6 +559,22 @@ void Adsr::initialize_unique_graphics_objects()
                           RED, primary_module_color, "I", "I", false,
                           (Graphics_Listener *) this);
 
+    // Initialize curve toggle buttons
+    graphics_objects["linear toggle button"] =
+        new Toggle_Button(name + " linear toggle button",
+                          graphics_object_locations["linear toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "LIN", "LIN", linear_on,
+                          (Graphics_Listener *) this);
+    graphics_objects["exponential toggle button"] =
+        new Toggle_Button(name + " exponential toggle button",
+                          graphics_object_locations["exponential toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "EXP", "EXP", exponential_on,
+                          (Graphics_Listener *) this);
+
     // Store pointers to these graphics objects in the necessary data
     // structures
     text_box_to_input_num[(Text_Box *) graphics_objects["note text box"]] = ADSR_NOTE;
@@ -362,10 +599,52 @@ void Adsr::initialize_unique_graphics_objects()
     inputs[ADSR_R].toggle_button = (Toggle_Button *) graphics_objects["release toggle button"];
 }
 
+/*
+ * Switch every stage to the given curve, and update the curve toggle buttons
+ * to match if there are any. A stage in progress carries on from its current
+ * amplitude along the new curve.
+ */
+void Adsr::switch_curve(AdsrCurve curve_)
+{
+    curve = curve_;
+    linear_on = curve == LINEAR;
+    exponential_on = curve == EXPONENTIAL;
+
+    std::cout << name << " is now "
+              << (curve == EXPONENTIAL ? "exponential" : "linear")
+              << std::endl;
+
+    if(graphics_objects_initialized)
+    {
+        ((Toggle_Button *) graphics_objects["linear toggle button"])->b =
+            linear_on;
+        ((Toggle_Button *) graphics_objects["exponential toggle button"])->b =
+            exponential_on;
+    }
+}
+
 std::string Adsr::get_unique_text_representation()
 {
     return std::to_string(current_amplitude) + "\n"
-           + std::to_string(adsr_stage) + "\n";
+           + std::to_string(adsr_stage) + "\n"
+           + std::to_string(curve) + "\n";
+}
+
+/*
+ * Restore this ADSR's amplitude, stage, and curve, patches saved before there
+ * was a choice of curve are linear.
+ */
+void Adsr::set_unique_text_representation(std::vector<std::string> *lines)
+{
+    if(lines->size() >= 2)
+    {
+        current_amplitude = stod((*lines)[0]);
+        adsr_stage = (AdsrStage) stoi((*lines)[1]);
+    }
+    if(lines->size() >= 3)
+    {
+        switch_curve((AdsrCurve) stoi((*lines)[2]));
+    }
 }
 
 /*
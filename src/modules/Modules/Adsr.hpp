@@ -4,7 +4,8 @@
  * or 0 as input. A 1 represents note on, resulting in a rise to initial
  * volume over the attack time, then a decay to sustain volume over the decay
  * time, and then sustain at the sustain volume. A 0 represents note off,
- * resulting in a release to no volume over the release time.
+ * resulting in a release to no volume over the release time. Each stage
+ * moves either linearly, or exponentially as an analog envelope does.
  */
 
 #ifndef MSS_ADSR_HPP
@@ -43,23 +44,65 @@ public:
         ADSR_R
     };
 
+    // ADSR curve enum
+    enum AdsrCurve
+    {
+        LINEAR = 0,
+        EXPONENTIAL
+    };
+
+    // A struct to represent how the amplitude moves during a stage, either
+    // by the rate every sample, or exponentially toward the target, leaving
+    // the rate of the distance to the target after every sample, until it
+    // reaches the end amplitude and moves on to the next stage
+    struct Segment
+    {
+        bool exponential;
+        double rate;
+        double target;
+        double end;
+        bool rising;
+        AdsrStage next_stage;
+    };
+
     // The current amplitudes
     double current_amplitude;
     // Which phase of the envelope this module is in
     AdsrStage adsr_stage;
+    // The shape of every stage
+    AdsrCurve curve;
+    bool linear_on, exponential_on;
+    // The segments of the attack, decay, and release stages, indexed by
+    // stage, and the envelope times, sustain, and curve they were calculated
+    // for
+    Segment segments[ADSR_IDLE_STAGE];
+    float segment_parameters[4];
+    AdsrCurve segment_curve;
 
     // Constructor and destructor
     Adsr();
     virtual ~Adsr();
 
     // Member functions, explained in Module.hpp
-    virtual void process();
+    virtual void process(unsigned int);
+    virtual bool reads_control_rate(unsigned int);
     virtual bool handle_event(Graphics_Object *);
     virtual void calculate_unique_graphics_object_locations();
     virtual void initialize_unique_graphics_objects();
     virtual std::string get_unique_text_representation();
+    virtual void set_unique_text_representation(std::vector<std::string> *);
 
     // Member functions particular to this module
+    //   Calculate the segments of the attack, decay, and release stages if
+    //   the envelope times, sustain, or curve have changed
+    void update_segments();
+    //   Move the envelope along by a single sample
+    void advance_stage(bool);
+    //   Fill part of the output buffer with the envelope while the note stays
+    //   on or off
+    void process_run(float *, unsigned int, bool);
+    //   Switch to the given curve
+    void switch_curve(AdsrCurve);
     //   Reset amplitude
     void reset_stage();
 };
@@ -8,6 +8,7 @@
  ************/
 
 // Included libraries
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <string>
@@ -21,6 +22,7 @@
 #include "graphics_object_utils.hpp"
 #include "image_processing.hpp"
 #include "main.hpp"
+#include "signal_kernels.hpp"
 #include "signal_processing.hpp"
 
 // Included modules classes
@@ -36,18 +38,26 @@
  */
 Delay::Delay() :
     Module(DELAY),
-    circular_buffer(std::vector<float>(BUFFER_SIZE, 0)),
-    current_sample(0),
-    previous_max_delay_time(0),
-    previous_delay_time(0)
+    write_index(0),
+    previous_delay_time(0), silent_samples(0), cleared_samples(0)
 {
+    unsigned int buffer_size = 1;
+
     inputs[DELAY_MAX_DELAY_TIME].val = 5000;
     inputs[DELAY_DELAY_TIME].val = 2000;
     inputs[DELAY_FEEDBACK_AMOUNT].val = 0;
     inputs[DELAY_WET_DRY].val = 1;
 
-    circular_buffer = std::vector<float>(inputs[DELAY_MAX_DELAY_TIME].val
-                                         / 1000.0 * SAMPLE_RATE, 0);
+    // Make room for the longest delay, and the sample after it to interpolate
+    // with
+    while(buffer_size < MAX_DELAY_TIME_CEILING / 1000.0 * SAMPLE_RATE + 2)
+    {
+        buffer_size <<= 1;
+    }
+    circular_buffer = std::vector<float>(buffer_size, 0);
+    index_mask = buffer_size - 1;
+    cleared_samples = buffer_size;
+    delayed_buffer = std::vector<float>(BUFFER_SIZE + 1, 0);
     delay_samples = inputs[DELAY_DELAY_TIME].val / 1000.0 * SAMPLE_RATE;
 }
 
@@ -59,51 +69,146 @@ Delay::~Delay()
 
 /*
  * Calculate a linearly interpolated sample from the buffer to return. This
- * sample may technically be in-between samples.
+ * sample may technically be in-between samples. The delay is never longer
+ * than the buffer, so adding the buffer's size keeps the position positive,
+ * and the mask wraps both samples around the buffer.
  */
 float Delay::calculate_wet_sample()
 {
-    float x0, x1, y0, y1, interpolated_sample;
-    float delayed_sample = current_sample - delay_samples;
-    while(delayed_sample < 0)
-    {
-        delayed_sample += circular_buffer.size();
-    }
+    double delayed_sample = write_index + (index_mask + 1) - delay_samples;
+    unsigned int x0 = (unsigned int) delayed_sample;
+    float fraction = delayed_sample - x0;
+    float y0 = circular_buffer[x0 & index_mask];
+    float y1 = circular_buffer[(x0 + 1) & index_mask];
+
+    return y0 + (y1 - y0) * fraction;
+}
 
-    x0 = ((int) delayed_sample) % circular_buffer.size();
-    x1 = ((int)(delayed_sample + 1)) % circular_buffer.size();
-    y0 = circular_buffer[x0];
-    y1 = circular_buffer[x1];
+/*
+ * Calculate a sample from the buffer to return with 4 point, 3rd order
+ * Hermite interpolation, which keeps much more of the high frequencies than
+ * linear interpolation while the delay time moves. The sample after the two
+ * being interpolated between must already be written, so the delay must be
+ * at least 2 samples long.
+ */
+float Delay::calculate_cubic_wet_sample()
+{
+    double delayed_sample = write_index + (index_mask + 1) - delay_samples;
+    unsigned int x0 = (unsigned int) delayed_sample;
+    float fraction = delayed_sample - x0;
+    float y_1 = circular_buffer[(x0 - 1) & index_mask];
+    float y0 = circular_buffer[x0 & index_mask];
+    float y1 = circular_buffer[(x0 + 1) & index_mask];
+    float y2 = circular_buffer[(x0 + 2) & index_mask];
+    float c1 = .5 * (y1 - y_1);
+    float c2 = y_1 - 2.5 * y0 + 2 * y1 - .5 * y2;
+    float c3 = .5 * (y2 - y_1) + 1.5 * (y0 - y1);
+
+    return ((c3 * fraction + c2) * fraction + c1) * fraction + y0;
+}
 
-    interpolated_sample = y0 + ((y1 - y0) * ((delayed_sample - x0)
-                                             / (x1 - x0)));
+/*
+ * Copy the given number of samples out of the circular buffer, starting at
+ * the given index, which is wrapped around the buffer first. The span wraps
+ * around the end of the buffer at most once.
+ */
+void Delay::read_span(unsigned int start, float *dst, unsigned int num_samples)
+{
+    start &= index_mask;
+    unsigned int first = std::min(num_samples, index_mask + 1 - start);
 
-    return interpolated_sample;
+    copy_samples(&circular_buffer[start], dst, first);
+    copy_samples(circular_buffer.data(), dst + first, num_samples - first);
 }
 
 /*
- * Process all dependencies, then
- * fill the output buffer with a waveform given
+ * Copy the given samples into the circular buffer at the write index, then
+ * move the write index past them.
+ */
+void Delay::write_span(const float *src, unsigned int num_samples)
+{
+    unsigned int first = std::min(num_samples, index_mask + 1 - write_index);
+
+    copy_samples(src, &circular_buffer[write_index], first);
+    copy_samples(src + first, circular_buffer.data(), num_samples - first);
+    write_index = (write_index + num_samples) & index_mask;
+}
+
+/*
+ * Fill the output buffer with a waveform given
  * the data contained within this class and the
- * audio device information.
+ * audio device information. If only the signal
+ * is live, the delay times and the wet/dry and
+ * feedback amounts are handled once per buffer.
+ * While the signal is silent, count how long the
+ * delay line has been written nothing but silence.
+ * Once everything that can be read from it is
+ * silent, its tail has played out, and there is
+ * nothing to do but keep writing silence. If the
+ * max delay time now reaches further back than
+ * was cleared when the delay line was last reset,
+ * the rest is cleared before it is read.
  */
-void Delay::process()
+void Delay::process(unsigned int num_samples)
 {
-    // Process any dependencies
-    process_dependencies();
+    bool silent = !inputs[DELAY_SIGNAL].live || input_silent(DELAY_SIGNAL);
+    unsigned int start = write_index;
+    unsigned int readable = inputs[DELAY_MAX_DELAY_TIME].live
+                            ? index_mask + 1 : max_delay_samples();
+
+    if(readable > cleared_samples)
+    {
+        clear_span(write_index - readable, readable - cleared_samples);
+        cleared_samples = readable;
+    }
+    cleared_samples = std::min(cleared_samples + num_samples, index_mask + 1);
+
+    if(silent && silent_samples >= max_delay_samples())
+    {
+        clear_span(write_index, num_samples);
+        write_index = (write_index + num_samples) & index_mask;
+        std::fill(out, out + num_samples, 0);
+
+        update_input_vals(num_samples - 1);
+        if(!inputs[DELAY_SIGNAL].live)
+        {
+            inputs[DELAY_SIGNAL].val = 0;
+        }
+        return;
+    }
+
+    process_signal(num_samples);
+
+    if(silent && written_silent((write_index - start) & index_mask))
+    {
+        silent_samples = std::min(silent_samples
+                                  + ((write_index - start) & index_mask),
+                                  index_mask + 1);
+    }
+    else
+    {
+        silent_samples = 0;
+    }
+}
 
+/*
+ * Fill the output buffer from the signal and the delay line, moving the
+ * delay line on as the signal is written to it.
+ */
+void Delay::process_signal(unsigned int num_samples)
+{
     // Update parameters
     update_input_vals(0);
 
-    // If the max delay time has changed, reset the delay buffer
-    if(inputs[DELAY_MAX_DELAY_TIME].val != previous_max_delay_time)
+    if(!inputs[DELAY_MAX_DELAY_TIME].live && !inputs[DELAY_DELAY_TIME].live
+       && !inputs[DELAY_WET_DRY].live && !inputs[DELAY_FEEDBACK_AMOUNT].live)
     {
-        reset_buffer();
-        previous_max_delay_time = inputs[DELAY_MAX_DELAY_TIME].val;
+        process_constant(num_samples);
+        return;
     }
 
     // Per sample
-    for(unsigned int i = 0; i < BUFFER_SIZE; i ++)
+    for(unsigned int i = 0; i < num_samples; i ++)
     {
         // Update parameters
         update_input_vals(i);
@@ -122,35 +227,155 @@ void Delay::process()
             previous_delay_time = inputs[DELAY_DELAY_TIME].val;
         }
 
-        if(inputs[DELAY_MAX_DELAY_TIME].val >= inputs[DELAY_DELAY_TIME].val)
+        if(max_delay_time() >= inputs[DELAY_DELAY_TIME].val)
         {
             // Apply the dry signal
             out[i] = (1 - inputs[DELAY_WET_DRY].val)
                         * inputs[DELAY_SIGNAL].val;
 
-            // Apply the linearly interpolated wet signal
-            float wet_sample = calculate_wet_sample();
+            // Apply the interpolated wet signal, using cubic interpolation
+            // when the delay time is modulated
+            float wet_sample = inputs[DELAY_DELAY_TIME].live
+                               && delay_samples >= 2
+                               ? calculate_cubic_wet_sample()
+                               : calculate_wet_sample();
             out[i] += inputs[DELAY_WET_DRY].val * wet_sample;
 
             // Update the sample in the circular buffer
-            circular_buffer[current_sample] = inputs[DELAY_FEEDBACK_AMOUNT].val
-                                              * wet_sample;
-            circular_buffer[current_sample] += inputs[DELAY_SIGNAL].val;
+            circular_buffer[write_index] = inputs[DELAY_FEEDBACK_AMOUNT].val
+                                           * wet_sample;
+            circular_buffer[write_index] += inputs[DELAY_SIGNAL].val;
 
             // Move on to the next sample
-            current_sample ++;
-            current_sample = fmod(current_sample,
-                                  ((double) circular_buffer.size()));
+            write_index = (write_index + 1) & index_mask;
         }
-        else if(inputs[DELAY_MAX_DELAY_TIME].val < inputs[DELAY_DELAY_TIME].val)
+        // The delay time is longer than the delay line allows, output
+        // silence, since the output buffer may still hold another module's
+        // output from earlier in the block
+        else
         {
-            std::cout << RED_STDOUT << name
-                      << " delay time is greater than max delay time!"
-                      << DEFAULT_STDOUT << std::endl;
+            out[i] = 0;
         }
     }
+}
+
+/*
+ * Fill the output buffer given a constant delay time,
+ * wet/dry amount, and feedback amount, reading the
+ * signal straight from its buffer.
+ */
+void Delay::process_constant(unsigned int num_samples)
+{
+    float wet_dry = inputs[DELAY_WET_DRY].val;
+    float feedback_amount = inputs[DELAY_FEEDBACK_AMOUNT].val;
+    float *signal = nullptr;
+
+    if(inputs[DELAY_SIGNAL].live)
+    {
+        signal = inputs[DELAY_SIGNAL].in;
+    }
+    else
+    {
+        inputs[DELAY_SIGNAL].val = 0;
+    }
+
+    if(inputs[DELAY_DELAY_TIME].val != previous_delay_time)
+    {
+        delay_samples = inputs[DELAY_DELAY_TIME].val / 1000.0 * SAMPLE_RATE;
+        previous_delay_time = inputs[DELAY_DELAY_TIME].val;
+    }
 
-    processed = true;
+    // The delay time is longer than the delay line allows, output silence,
+    // since the output buffer may still hold another module's output from
+    // earlier in the block
+    if(max_delay_time() < inputs[DELAY_DELAY_TIME].val)
+    {
+        std::fill(out, out + num_samples, 0);
+        update_input_vals(num_samples - 1);
+        return;
+    }
+
+    // When the delay is longer than the block, every sample read during the
+    // block was written before it
+    if(delay_samples >= num_samples + 1)
+    {
+        process_spans(signal, num_samples);
+        update_input_vals(num_samples - 1);
+        return;
+    }
+
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        float sample = signal != nullptr ? signal[i] : 0;
+
+        // Apply the dry signal, then the linearly interpolated wet signal
+        float wet_sample = calculate_wet_sample();
+        out[i] = (1 - wet_dry) * sample;
+        out[i] += wet_dry * wet_sample;
+
+        // Update the sample in the circular buffer
+        circular_buffer[write_index] = feedback_amount * wet_sample;
+        circular_buffer[write_index] += sample;
+
+        // Move on to the next sample
+        write_index = (write_index + 1) & index_mask;
+    }
+
+    update_input_vals(num_samples - 1);
+}
+
+/*
+ * Fill the output buffer a span at a time, given a constant delay time,
+ * wet/dry amount, and feedback amount, and a delay longer than the block, or
+ * a null signal for silence. The samples to interpolate between are copied
+ * out of the circular buffer in one span, and the samples to feed back are
+ * copied into it in another, so with no feedback and a whole sample delay,
+ * this costs little more than copying the block twice.
+ */
+void Delay::process_spans(const float *signal, unsigned int num_samples)
+{
+    float wet_dry = inputs[DELAY_WET_DRY].val;
+    float feedback_amount = inputs[DELAY_FEEDBACK_AMOUNT].val;
+    double delayed_sample = write_index + (index_mask + 1) - delay_samples;
+    unsigned int x0 = (unsigned int) delayed_sample;
+    float fraction = delayed_sample - x0;
+    float *delayed = delayed_buffer.data();
+
+    // Interpolate the wet signal into the output buffer
+    read_span(x0, delayed, num_samples + 1);
+    multiply_samples(delayed, 1 - fraction, out, num_samples);
+    if(fraction != 0)
+    {
+        multiply_add_samples(delayed + 1, fraction, out, num_samples);
+    }
+
+    // Feed the signal and the wet signal back into the circular buffer
+    if(signal != nullptr)
+    {
+        copy_samples(signal, delayed, num_samples);
+        multiply_add_samples(out, feedback_amount, delayed, num_samples);
+    }
+    else
+    {
+        multiply_samples(out, feedback_amount, delayed, num_samples);
+    }
+    write_span(delayed, num_samples);
+
+    // Mix the dry signal with the wet signal
+    multiply_samples(out, wet_dry, out, num_samples);
+    if(signal != nullptr)
+    {
+        multiply_add_samples(signal, 1 - wet_dry, out, num_samples);
+    }
+}
+
+/*
+ * Every input but the signal being delayed can read a signal calculated at
+ * control rate.
+ */
+bool Delay::reads_control_rate(unsigned int input_num)
+{
+    return input_num != DELAY_SIGNAL;
 }
 
 /*
@@ -166,10 +391,15 @@ bool Delay::handle_event(Graphics_Object *g)
     {
         return false;
     }
-    // Handle reset buffer button
+    // Handle reset buffer button, the audio thread is the only one that
+    // touches the delay line
     else if(g == graphics_objects["reset buffer button"])
     {
-        reset_buffer();
+        Command_Queue::Command command;
+        command.command_type = Command_Queue::RESET_BUFFER;
+        command.module = this;
+        COMMAND_QUEUE.post(command);
+        std::cout << name << " buffer reset" << std::endl;
         return true;
     }
     // If none of the above, handle events that apply to all modules, return
@@ -343,13 +573,75 @@ std::string Delay::get_unique_text_representation()
 }
 
 /*
- * Reset this delay's buffer
+ * Return the max delay time, or the ceiling if it is longer, since the delay
+ * line has no room for anything longer.
+ */
+float Delay::max_delay_time()
+{
+    return std::min(inputs[DELAY_MAX_DELAY_TIME].val,
+                    (float) MAX_DELAY_TIME_CEILING);
+}
+
+/*
+ * Return how many samples behind the write index the longest delay allowed by
+ * the max delay time reads from, including the samples either side of it that
+ * are interpolated with, no more than the whole delay line.
+ */
+unsigned int Delay::max_delay_samples()
+{
+    float max_samples = std::max(max_delay_time(), (float) 0) / 1000
+                        * SAMPLE_RATE;
+
+    return std::min((unsigned int) max_samples + 3, index_mask + 1);
+}
+
+/*
+ * Return whether or not the given number of samples written to the delay line
+ * just before the write index are all silent. They wrap around the start of
+ * the delay line at most once.
+ */
+bool Delay::written_silent(unsigned int num_samples)
+{
+    unsigned int start = (write_index - num_samples) & index_mask;
+    unsigned int first = std::min(num_samples, index_mask + 1 - start);
+
+    return (first == 0 || (circular_buffer[start] == 0
+                           && is_constant(&circular_buffer[start], first)))
+           && (first == num_samples
+               || (circular_buffer[0] == 0
+                   && is_constant(circular_buffer.data(),
+                                  num_samples - first)));
+}
+
+/*
+ * Silence the given number of samples of the delay line, starting from the
+ * given index, which is wrapped around the delay line first. The span wraps
+ * around the end of the delay line at most once.
+ */
+void Delay::clear_span(unsigned int start, unsigned int num_samples)
+{
+    start &= index_mask;
+    unsigned int first = std::min(num_samples, index_mask + 1 - start);
+
+    std::fill(&circular_buffer[start], &circular_buffer[start] + first, 0);
+    std::fill(circular_buffer.begin(),
+              circular_buffer.begin() + (num_samples - first), 0);
+}
+
+/*
+ * Reset this delay's buffer to silence, without reallocating it. Only the
+ * samples that the max delay time lets the delay read are cleared, rather than
+ * the whole delay line, which has room for the longest max delay time
+ * allowed. The rest is cleared if the max delay time grows to reach it before
+ * it is written over.
  */
 void Delay::reset_buffer()
 {
-    circular_buffer = std::vector<float>(inputs[DELAY_MAX_DELAY_TIME].val
-                                         / 1000.0 * SAMPLE_RATE, 0);
+    unsigned int readable = inputs[DELAY_MAX_DELAY_TIME].live
+                            ? index_mask + 1 : max_delay_samples();
 
-    std::cout << name << " buffer reset" << std::endl;
+    clear_span(write_index - readable, readable);
+    cleared_samples = readable;
+    silent_samples = readable;
 }
 
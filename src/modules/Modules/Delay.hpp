@@ -1,7 +1,10 @@
 /*
  * Matthew Diamond 2015
  * The delay module. This module is capable of applying a delay line to a
- * signal, complete with wet/dry and feedback amount controls.
+ * signal, complete with wet/dry and feedback amount controls. The delay line
+ * is a ring buffer whose size is a power of two, allocated when the module is
+ * created with room for the longest max delay time allowed, so that changing
+ * the max delay time never allocates while processing.
  */
 
 #ifndef MSS_DELAY_HPP
@@ -30,20 +33,34 @@ public:
         DELAY_WET_DRY
     };
 
-    // Delayed buffer
+    // The longest max delay time allowed, in milliseconds, which every delay
+    // line has room for, 2 MB of samples at 44.1 kHz
+    static const unsigned int MAX_DELAY_TIME_CEILING = 10000;
+
+    // Delay line, the index of the next sample to write to it, and the mask
+    // that wraps an index around it
     std::vector<float> circular_buffer;
-    double current_sample;
+    // The samples read from the delay line for a block, and the one after
+    std::vector<float> delayed_buffer;
+    unsigned int write_index;
+    unsigned int index_mask;
+    // The delay in samples, and the delay time it was calculated from
     double delay_samples;
-    // Previous max delay time
-    float previous_max_delay_time;
     float previous_delay_time;
+    // How many samples in a row have been written to the delay line as
+    // silence, and how many samples before the write index have been cleared
+    // or written since it was last reset, both up to the size of the delay
+    // line
+    unsigned int silent_samples;
+    unsigned int cleared_samples;
 
     // Constructor and destructor
     Delay();
     virtual ~Delay();
 
     // Member functions, explained in Module.hpp
-    virtual void process();
+    virtual void process(unsigned int);
+    virtual bool reads_control_rate(unsigned int);
     virtual bool handle_event(Graphics_Object *);
     virtual void calculate_unique_graphics_object_locations();
     virtual void initialize_unique_graphics_objects();
@@ -53,8 +70,32 @@ public:
     //   Calculate a linearly interpolated wet sample from
     //   the cirular buffer
     float calculate_wet_sample();
-    //   Reset buffer
+    //   Calculate a cubic interpolated wet sample from the circular buffer
+    float calculate_cubic_wet_sample();
+    //   Copy a span out of the circular buffer starting at the given index,
+    //   or copy a span into it at the write index and move past it
+    void read_span(unsigned int, float *, unsigned int);
+    void write_span(const float *, unsigned int);
+    //   Return the max delay time, no longer than the ceiling
+    float max_delay_time();
+    //   Return how far behind the write index samples can be read from the
+    //   delay line at the max delay time
+    unsigned int max_delay_samples();
+    //   Return whether or not the given number of samples written to the
+    //   delay line before the write index are silent
+    bool written_silent(unsigned int);
+    //   Silence the given number of samples of the delay line from the given
+    //   index
+    void clear_span(unsigned int, unsigned int);
+    //   Silence the delay line, called from the audio thread only
     void reset_buffer();
+    //   Fill the output buffer from the signal and the delay line
+    void process_signal(unsigned int);
+    //   Fill the output buffer when only the signal is live
+    void process_constant(unsigned int);
+    //   Fill the output buffer a span at a time when only the signal is live
+    //   and the delay is at least a block long
+    void process_spans(const float *, unsigned int);
 };
 
 #endif
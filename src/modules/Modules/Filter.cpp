@@ -10,6 +10,7 @@
  ************/
 
 // Included libraries
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <string>
@@ -23,12 +24,69 @@
 #include "graphics_object_utils.hpp"
 #include "image_processing.hpp"
 #include "main.hpp"
+#include "signal_kernels.hpp"
 #include "signal_processing.hpp"
 
 // Included modules classes
 #include "Module.hpp"
 #include "Modules/Filter.hpp"
 
+/*************
+ * CONSTANTS *
+ *************/
+
+// The q of each stage of a Butterworth cascade of 1, 2, or 4 stages, which has
+// the flattest passband for its slope
+static const float BUTTERWORTH_QS[3][Filter::MAX_STAGES] =
+{
+    {.7071068},
+    {.5411961, 1.306563},
+    {.5097956, .6013449, .8999762, 2.562915}
+};
+
+// How close to silence the state of every stage must be for a filter with a
+// silent signal to stop filtering it, far below anything audible
+static const float SILENT_STATE = 1e-9;
+
+// The coefficients of the biquads stay put for each span they are calculated
+// for, so they change by nothing every sample
+static const float NO_INCREMENTS[5 * Filter::MAX_STAGES] = {};
+
+/********************
+ * HELPER FUNCTIONS *
+ ********************/
+
+/*
+ * Return the q of each stage of a Butterworth cascade of the given number of
+ * stages.
+ */
+static const float *butterworth_qs(unsigned int num_stages)
+{
+    return BUTTERWORTH_QS[num_stages == 1 ? 0 : num_stages == 2 ? 1 : 2];
+}
+
+/*
+ * Return the tangent of half the angle the given cutoff frequency moves
+ * through each sample, kept below the Nyquist frequency so that the filter
+ * stays stable.
+ */
+static float cutoff_tangent(float cutoff)
+{
+    cutoff = std::min(std::max(cutoff, (float) 1), SAMPLE_RATE * (float) .49);
+    return fast_tan(M_PI * cutoff / SAMPLE_RATE);
+}
+
+/*
+ * Return the q of the last stage of a cascade, the given q of the filter
+ * relative to the q of that stage in a Butterworth cascade.
+ */
+static float last_stage_q(const float *stage_qs, unsigned int num_stages,
+                          float q)
+{
+    return stage_qs[num_stages - 1] * std::max(q, (float) .1)
+           / (float) M_SQRT1_2;
+}
+
 /***************************
  * FILTER MEMBER FUNCTIONS *
  ***************************/
@@ -38,14 +96,24 @@
  */
 Filter::Filter() :
     Module(FILTER),
-    iir_samples(std::vector<float>(6, 0)),
-    iir_coefficients(std::vector<float>(6, 1 / 16.0)),
-    y1(0), y2(0), x1(0), x2(0),
-    filter_type(LOWPASS), lowpass_on(true), bandpass_on(false),
-    highpass_on(false)
+    biquad_cutoff(0), biquad_q(0), svf_gain(0), svf_damping(0),
+    num_stages(1), processed_stages(0), topology(BIQUAD),
+    processed_topology(BIQUAD), filter_type(LOWPASS), lowpass_on(true),
+    bandpass_on(false), highpass_on(false), rung_out(false)
 {
     inputs[FILTER_FREQUENCY_CUTOFF].val = 12500;
     inputs[FILTER_Q].val = 1;
+
+    extra_buffers = std::vector<std::vector<float>>(
+        3, std::vector<float>(BUFFER_SIZE, 0));
+    for(unsigned int i = 0; i < extra_buffers.size(); i ++)
+    {
+        extra_outs.push_back(extra_buffers[i].data());
+    }
+    extra_output_names = {"lp", "bp", "hp"};
+
+    std::fill(coefficients, coefficients + 5 * MAX_STAGES, 0);
+    std::fill(history, history + 2 * MAX_STAGES, 0);
 }
 
 /*
@@ -55,75 +123,302 @@ Filter::~Filter()
 {}
 
 /*
- * Process all dependencies, then fill the output buffer with a waveform given
- * the data contained within this class and the audio device information.
+ * Fill the output buffer with the filtered input signal. Only when the number
+ * of stages or the topology changes, or the filter has rung out, does the
+ * filter start over, every stage from silence with coefficients for the
+ * current cutoff and q. Once the signal is silent and the filter has rung
+ * out, it outputs silence without filtering anything. The biquads only filter
+ * for the filter type, so for them the output of the filter type gets a copy
+ * of the main output, and the other two are silent.
  */
-void Filter::process()
+void Filter::process(unsigned int num_samples)
 {
-    // Process any dependencies
-    process_dependencies();
-
-    // Update parameters
-    update_input_vals(0);
-
-    // Once per buffer, update the coefficients
-    double w0 = (inputs[FILTER_FREQUENCY_CUTOFF].val / SAMPLE_RATE) * 2 * M_PI;
-    double alpha = sin(w0) / (2 * inputs[FILTER_Q].val);
-
-    // Use different calculations for the coefficients of each filter type
-    switch(filter_type)
-    {
-    case LOWPASS:
-        iir_coefficients[0] = (1 - cos(w0)) / 2;
-        iir_coefficients[1] = 1 - cos(w0);
-        iir_coefficients[2] = (1 - cos(w0)) / 2;
-        iir_coefficients[3] = 1 + alpha;
-        iir_coefficients[4] = -2 * cos(w0);
-        iir_coefficients[5] = 1 - alpha;
-        break;
-    case BANDPASS:
-        iir_coefficients[0] = inputs[FILTER_Q].val * alpha;
-        iir_coefficients[1] = 0;
-        iir_coefficients[2] = (inputs[FILTER_Q].val * -1) * alpha;
-        iir_coefficients[3] = 1 + alpha;
-        iir_coefficients[4] = -2 * cos(w0);
-        iir_coefficients[5] = 1 - alpha;
-        break;
-    case HIGHPASS:
-        iir_coefficients[0] = (1 + cos(w0)) / 2;
-        iir_coefficients[1] = (1 + cos(w0)) * -1;
-        iir_coefficients[2] = (1 + cos(w0)) / 2;
-        iir_coefficients[3] = 1 + alpha;
-        iir_coefficients[4] = -2 * cos(w0);
-        iir_coefficients[5] = 1 - alpha;
-        break;
-    }
-
-    // Filter the buffer with the determined coefficients
-    for(unsigned int i = 0; i < BUFFER_SIZE; i ++)
-    {
-        // Update parameters
-        update_input_vals(i);
+    bool jump = num_stages != processed_stages
+                || topology != processed_topology || rung_out;
+    const float *signal = out;
 
+    if((!inputs[FILTER_SIGNAL].live || input_silent(FILTER_SIGNAL))
+       && state_silent())
+    {
+        std::fill(history, history + 2 * MAX_STAGES, 0);
+        std::fill(out, out + num_samples, 0);
+        for(unsigned int i = 0; i < extra_outs.size(); i ++)
+        {
+            std::fill(extra_outs[i], extra_outs[i] + num_samples, 0);
+        }
+        rung_out = true;
+        update_input_vals(num_samples - 1);
         if(!inputs[FILTER_SIGNAL].live)
         {
             inputs[FILTER_SIGNAL].val = 0;
         }
+        return;
+    }
+    rung_out = false;
+
+    // With no signal, the filter rings out on silence
+    if(inputs[FILTER_SIGNAL].live)
+    {
+        signal = inputs[FILTER_SIGNAL].in;
+    }
+    else
+    {
+        std::fill(out, out + num_samples, 0);
+    }
+
+    if(jump)
+    {
+        std::fill(history, history + 2 * MAX_STAGES, 0);
+        processed_stages = num_stages;
+        processed_topology = topology;
+    }
+
+    if(topology == SVF)
+    {
+        process_svfs(signal, num_samples, jump);
+    }
+    else
+    {
+        process_biquads(signal, num_samples, jump);
+        for(unsigned int i = 0; i < extra_outs.size(); i ++)
+        {
+            if(i == (unsigned int) filter_type)
+            {
+                std::copy(out, out + num_samples, extra_outs[i]);
+            }
+            else
+            {
+                std::fill(extra_outs[i], extra_outs[i] + num_samples, 0);
+            }
+        }
+    }
+
+    if(!inputs[FILTER_SIGNAL].live)
+    {
+        inputs[FILTER_SIGNAL].val = 0;
+    }
+    update_input_vals(num_samples - 1);
+}
+
+/*
+ * Filter the given signal into the output buffer through the cascade of
+ * biquad filters. The coefficients are never moved between two sets directly,
+ * since the biquads in between can be unstable. Instead, the cutoff and q
+ * follow their inputs if they are live, or otherwise move from their values
+ * at the end of the last block to those at the end of this one, unless told
+ * to jump straight there, and the coefficients are calculated every
+ * SUB_BLOCK_SIZE samples for the cutoff and q at the last sample of each
+ * sub-block. If neither moves, the coefficients are calculated once for the
+ * whole block.
+ */
+void Filter::process_biquads(const float *signal, unsigned int num_samples,
+                             bool jump)
+{
+    const float *cutoffs = inputs[FILTER_FREQUENCY_CUTOFF].in;
+    const float *qs = inputs[FILTER_Q].in;
+    bool cutoff_live = inputs[FILTER_FREQUENCY_CUTOFF].live;
+    bool q_live = inputs[FILTER_Q].live;
+    unsigned int sub_block_size = SUB_BLOCK_SIZE;
+
+    update_input_vals(num_samples - 1);
+    float target_cutoff = inputs[FILTER_FREQUENCY_CUTOFF].val;
+    float target_q = inputs[FILTER_Q].val;
+    if(jump)
+    {
+        biquad_cutoff = target_cutoff;
+        biquad_q = target_q;
+    }
+    float cutoff_increment = (target_cutoff - biquad_cutoff) / num_samples;
+    float q_increment = (target_q - biquad_q) / num_samples;
 
-        out[i] = (iir_coefficients[0] / iir_coefficients[3])
-                    * inputs[FILTER_SIGNAL].val
-                    + (iir_coefficients[1] / iir_coefficients[3] * x1)
-                    + (iir_coefficients[2] / iir_coefficients[3] * x2)
-                    - (iir_coefficients[4] / iir_coefficients[3] * y1)
-                    - (iir_coefficients[5] / iir_coefficients[3] * y2);
+    if(!cutoff_live && !q_live && cutoff_increment == 0 && q_increment == 0)
+    {
+        sub_block_size = num_samples;
+    }
 
-        x2 = x1;
-        x1 = inputs[FILTER_SIGNAL].val;
-        y2 = y1;
-        y1 = out[i];
+    for(unsigned int i = 0; i < num_samples; i += sub_block_size)
+    {
+        unsigned int length = std::min(sub_block_size, num_samples - i);
+        unsigned int last = i + length - 1;
+
+        calculate_coefficients(cutoff_live ? cutoffs[last]
+                               : biquad_cutoff + cutoff_increment * (last + 1),
+                               q_live ? qs[last]
+                               : biquad_q + q_increment * (last + 1));
+        biquad_samples(signal + i, out + i, length, num_stages, coefficients,
+                       NO_INCREMENTS, history);
     }
 
-    processed = true;
+    biquad_cutoff = target_cutoff;
+    biquad_q = target_q;
+}
+
+/*
+ * Filter the given signal into the output buffer through a cascade of
+ * topology-preserving state variable filters, in the form given by Andrew
+ * Simper. Every stage computes its lowpass, bandpass, and highpass outputs at
+ * once, and passes the one for the filter type on to the next stage, and
+ * those of the last stage are the filter's lowpass, bandpass, and highpass
+ * outputs, which add back up to what the last stage filtered when the
+ * bandpass output is scaled by its damping, 1 / q for one stage. Unlike a
+ * biquad, a state variable filter stays well behaved when its cutoff and q
+ * change every sample, so a live cutoff or q is read at every sample, costing
+ * one tangent approximation per sample. Otherwise, the integrator gain and
+ * damping move from their values at the end of the last block to those for
+ * the cutoff and q at the end of this one, unless told to jump straight
+ * there.
+ */
+void Filter::process_svfs(const float *signal, unsigned int num_samples,
+                          bool jump)
+{
+    const float *stage_qs = butterworth_qs(num_stages);
+    const float *cutoffs = inputs[FILTER_FREQUENCY_CUTOFF].in;
+    const float *qs = inputs[FILTER_Q].in;
+    bool cutoff_live = inputs[FILTER_FREQUENCY_CUTOFF].live;
+    bool q_live = inputs[FILTER_Q].live;
+    float *integrators_1 = history;
+    float *integrators_2 = history + MAX_STAGES;
+    float dampings[MAX_STAGES];
+
+    // Every stage but the last has the damping of its Butterworth stage
+    for(unsigned int i = 0; i < num_stages; i ++)
+    {
+        dampings[i] = 1 / stage_qs[i];
+    }
+
+    update_input_vals(num_samples - 1);
+    float target_gain = cutoff_tangent(inputs[FILTER_FREQUENCY_CUTOFF].val);
+    float target_damping = 1 / last_stage_q(stage_qs, num_stages,
+                                            inputs[FILTER_Q].val);
+    if(jump)
+    {
+        svf_gain = target_gain;
+        svf_damping = target_damping;
+    }
+    float gain_increment = (target_gain - svf_gain) / num_samples;
+    float damping_increment = (target_damping - svf_damping) / num_samples;
+
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        float gain = cutoff_live ? cutoff_tangent(cutoffs[i])
+                     : svf_gain + gain_increment * (i + 1);
+        dampings[num_stages - 1] =
+            q_live ? 1 / last_stage_q(stage_qs, num_stages, qs[i])
+            : svf_damping + damping_increment * (i + 1);
+        float x = signal[i];
+        float lowpass = 0, bandpass = 0, highpass = 0;
+
+        for(unsigned int j = 0; j < num_stages; j ++)
+        {
+            float a1 = 1 / (1 + gain * (gain + dampings[j]));
+            float a2 = gain * a1;
+            float a3 = gain * a2;
+            float v3 = x - integrators_2[j];
+            float v1 = a1 * integrators_1[j] + a2 * v3;
+            float v2 = integrators_2[j] + a2 * integrators_1[j] + a3 * v3;
+            integrators_1[j] = 2 * v1 - integrators_1[j];
+            integrators_2[j] = 2 * v2 - integrators_2[j];
+
+            lowpass = v2;
+            bandpass = v1;
+            highpass = x - dampings[j] * v1 - v2;
+            switch(filter_type)
+            {
+            case LOWPASS:
+                x = lowpass;
+                break;
+            case BANDPASS:
+                x = bandpass;
+                break;
+            case HIGHPASS:
+                x = highpass;
+                break;
+            }
+        }
+
+        out[i] = x;
+        extra_outs[0][i] = lowpass;
+        extra_outs[1][i] = bandpass;
+        extra_outs[2][i] = highpass;
+    }
+
+    svf_gain = target_gain;
+    svf_damping = target_damping;
+}
+
+/*
+ * Return whether or not the state of every stage in use is close enough to
+ * silence that what the filter would output is far below anything audible.
+ */
+bool Filter::state_silent()
+{
+    for(unsigned int i = 0; i < processed_stages; i ++)
+    {
+        if(fabs(history[i]) > SILENT_STATE
+           || fabs(history[MAX_STAGES + i]) > SILENT_STATE)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Calculate the normalized coefficients of every stage for the given cutoff
+ * and q, with every unused stage's coefficients set to 0. Only the last stage
+ * of the cascade is given the q of the filter, relative to the q of a
+ * Butterworth stage, the rest keep the Butterworth q for their stage. Using
+ * the tangent of half the cutoff angle, the coefficients from the Audio EQ
+ * Cookbook need no other trigonometry, so they are cheap enough to calculate
+ * every sub-block.
+ */
+void Filter::calculate_coefficients(float cutoff, float q)
+{
+    const float *stage_qs = butterworth_qs(num_stages);
+    float k = cutoff_tangent(cutoff);
+
+    std::fill(coefficients, coefficients + 5 * MAX_STAGES, 0);
+    for(unsigned int i = 0; i < num_stages; i ++)
+    {
+        float stage_q = stage_qs[i];
+        if(i == num_stages - 1)
+        {
+            stage_q = last_stage_q(stage_qs, num_stages, q);
+        }
+        float norm = 1 / (1 + k / stage_q + k * k);
+
+        switch(filter_type)
+        {
+        case LOWPASS:
+            coefficients[i] = k * k * norm;
+            coefficients[MAX_STAGES + i] = 2 * k * k * norm;
+            coefficients[2 * MAX_STAGES + i] = k * k * norm;
+            break;
+        case BANDPASS:
+            coefficients[i] = k * norm;
+            coefficients[MAX_STAGES + i] = 0;
+            coefficients[2 * MAX_STAGES + i] = -k * norm;
+            break;
+        case HIGHPASS:
+            coefficients[i] = norm;
+            coefficients[MAX_STAGES + i] = -2 * norm;
+            coefficients[2 * MAX_STAGES + i] = norm;
+            break;
+        }
+        coefficients[3 * MAX_STAGES + i] = 2 * (k * k - 1) * norm;
+        coefficients[4 * MAX_STAGES + i] = (1 - k / stage_q + k * k) * norm;
+    }
+}
+
+/*
+ * Every input but the signal being filtered can read a signal calculated at
+ * control rate, the coefficients are only calculated once every sub-block
+ * anyway.
+ */
+bool Filter::reads_control_rate(unsigned int input_num)
+{
+    return input_num != FILTER_SIGNAL;
 }
 
 /*
@@ -139,6 +434,12 @@ bool Filter::handle_event(Graphics_Object *g)
     {
         return false;
     }
+    // While a source is being selected, the filter type toggle buttons select
+    // the outputs of their filter types instead of switching the filter type
+    else if(SELECTING_SRC)
+    {
+        return Module::handle_event(g);
+    }
     // Handle lowpass toggle button
     else if(g == graphics_objects["lowpass toggle button"])
     {
@@ -157,6 +458,33 @@ bool Filter::handle_event(Graphics_Object *g)
         switch_filter(HIGHPASS);
         return true;
     }
+    // Handle slope toggle buttons
+    else if(g == graphics_objects["12 dB toggle button"])
+    {
+        switch_num_stages(1);
+        return true;
+    }
+    else if(g == graphics_objects["24 dB toggle button"])
+    {
+        switch_num_stages(2);
+        return true;
+    }
+    else if(g == graphics_objects["48 dB toggle button"])
+    {
+        switch_num_stages(4);
+        return true;
+    }
+    // Handle topology toggle buttons
+    else if(g == graphics_objects["biquad toggle button"])
+    {
+        switch_topology(BIQUAD);
+        return true;
+    }
+    else if(g == graphics_objects["svf toggle button"])
+    {
+        switch_topology(SVF);
+        return true;
+    }
     // If none of the above, handle events that apply to all modules, return
     // true if an event is handled
     else if(Module::handle_event(g))
@@ -177,11 +505,11 @@ void Filter::calculate_unique_graphics_object_locations()
     SDL_Rect location;
 
     // Waveform viewer location
-    location = {upper_left.x, upper_left.y + 15, MODULE_WIDTH, 54};
+    location = {upper_left.x, upper_left.y + 15, MODULE_WIDTH, 34};
     graphics_object_locations["waveform"] = location;
 
     // Signal input related graphics object locations
-    location = {upper_left.x + 2, location.y + 57, 0, 0};
+    location = {upper_left.x + 2, location.y + 37, 0, 0};
     graphics_object_locations["signal text"] = location;
     location = {upper_left.x, location.y + 10, MODULE_WIDTH - 8, 9};
     graphics_object_locations["signal text box"] = location;
@@ -201,15 +529,31 @@ void Filter::calculate_unique_graphics_object_locations()
     location = {location.x + location.w + 1, location.y, 7, 9};
     graphics_object_locations["q toggle button"] = location;
 
-    // Filter type related graphics object locations
+    // Filter type/slope related graphics object locations
     location = {upper_left.x + 2, location.y + 10, 0, 0};
-    graphics_object_locations["filter type text"] = location;
-    location = {upper_left.x, location.y + 10, (MODULE_WIDTH / 3) - 1, 9};
+    graphics_object_locations["filter type/slope text"] = location;
+    location = {upper_left.x, location.y + 10, (MODULE_WIDTH / 6) - 1, 9};
     graphics_object_locations["lowpass toggle button"] = location;
     location = {location.x + location.w + 1, location.y, location.w, 9};
     graphics_object_locations["bandpass toggle button"] = location;
     location = {location.x + location.w + 1, location.y, location.w, 9};
     graphics_object_locations["highpass toggle button"] = location;
+    location = {location.x + location.w + 1, location.y, location.w, 9};
+    graphics_object_locations["12 dB toggle button"] = location;
+    location = {location.x + location.w + 1, location.y, location.w, 9};
+    graphics_object_locations["24 dB toggle button"] = location;
+    location = {location.x + location.w + 1, location.y,
+                upper_left.x + MODULE_WIDTH - location.x - location.w - 1, 9};
+    graphics_object_locations["48 dB toggle button"] = location;
+
+    // Topology related graphics object locations
+    location = {upper_left.x + 2, location.y + 10, 0, 0};
+    graphics_object_locations["topology text"] = location;
+    location = {upper_left.x, location.y + 10, (MODULE_WIDTH / 2) - 1, 9};
+    graphics_object_locations["biquad toggle button"] = location;
+    location = {location.x + location.w + 1, location.y,
+                upper_left.x + MODULE_WIDTH - location.x - location.w - 1, 9};
+    graphics_object_locations["svf toggle button"] = location;
 }
 
 /*
@@ -227,10 +571,14 @@ void Filter::initialize_unique_graphics_objects()
         new Text(name + " frequency cutoff/q text",
                  graphics_object_locations["frequency cutoff/q text"],
                  secondary_module_color, "CUTOFF (Hz) & Q (#):");
-    graphics_objects["filter type text"] =
-        new Text(name + " filter type text",
-                 graphics_object_locations["filter type text"],
-                 secondary_module_color, "FILTER TYPE:");
+    graphics_objects["filter type/slope text"] =
+        new Text(name + " filter type/slope text",
+                 graphics_object_locations["filter type/slope text"],
+                 secondary_module_color, "FILTER TYPE & SLOPE (dB):");
+    graphics_objects["topology text"] =
+        new Text(name + " topology text",
+                 graphics_object_locations["topology text"],
+                 secondary_module_color, "TOPOLOGY:");
 
     // Initialize waveform viewer
     graphics_objects["waveform"] =
@@ -309,44 +657,142 @@ void Filter::initialize_unique_graphics_objects()
                           secondary_module_color, primary_module_color,
                           primary_module_color, secondary_module_color,
                           "HP", "HP", highpass_on, (Graphics_Listener *) this);
+    toggle_button_to_output_num[(Toggle_Button *) graphics_objects["lowpass toggle button"]] = FILTER_LOWPASS_OUTPUT;
+    toggle_button_to_output_num[(Toggle_Button *) graphics_objects["bandpass toggle button"]] = FILTER_BANDPASS_OUTPUT;
+    toggle_button_to_output_num[(Toggle_Button *) graphics_objects["highpass toggle button"]] = FILTER_HIGHPASS_OUTPUT;
+
+    // Initialize slope toggle buttons
+    graphics_objects["12 dB toggle button"] =
+        new Toggle_Button(name + " 12 dB toggle button",
+                          graphics_object_locations["12 dB toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "12", "12", num_stages == 1,
+                          (Graphics_Listener *) this);
+    graphics_objects["24 dB toggle button"] =
+        new Toggle_Button(name + " 24 dB toggle button",
+                          graphics_object_locations["24 dB toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "24", "24", num_stages == 2,
+                          (Graphics_Listener *) this);
+    graphics_objects["48 dB toggle button"] =
+        new Toggle_Button(name + " 48 dB toggle button",
+                          graphics_object_locations["48 dB toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "48", "48", num_stages == 4,
+                          (Graphics_Listener *) this);
+
+    // Initialize topology toggle buttons
+    graphics_objects["biquad toggle button"] =
+        new Toggle_Button(name + " biquad toggle button",
+                          graphics_object_locations["biquad toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "BIQUAD", "BIQUAD", topology == BIQUAD,
+                          (Graphics_Listener *) this);
+    graphics_objects["svf toggle button"] =
+        new Toggle_Button(name + " svf toggle button",
+                          graphics_object_locations["svf toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "SVF", "SVF", topology == SVF,
+                          (Graphics_Listener *) this);
 }
 
 /*
- * Switch to processing input with the given filter type.
+ * Switch to processing input with the given filter type, and update the filter
+ * type toggle buttons to match if there are any. The coefficients move to the
+ * new type over the next block like any other change.
  */
 void Filter::switch_filter(FilterType filter_type_)
 {
-    lowpass_on = false;
-    bandpass_on = false;
-    highpass_on = false;
-    ((Toggle_Button *) graphics_objects["lowpass toggle button"])->b = false;
-    ((Toggle_Button *) graphics_objects["bandpass toggle button"])->b = false;
-    ((Toggle_Button *) graphics_objects["highpass toggle button"])->b = false;
-
-    switch(filter_type_)
-    {
-    case LOWPASS:
-        lowpass_on = true;
-        ((Toggle_Button *) graphics_objects["lowpass toggle button"])->b = true;
-        std::cout << name << " is now a low pass filter" << std::endl;
-        break;
-    case BANDPASS:
-        bandpass_on = true;
-        ((Toggle_Button *) graphics_objects["bandpass toggle button"])->b = true;
-        std::cout << name << " is now a bandpass filter" << std::endl;
-        break;
-    case HIGHPASS:
-        highpass_on = true;
-        ((Toggle_Button *) graphics_objects["highpass toggle button"])->b = true;
-        std::cout << name << " is now a highpass filter" << std::endl;
-        break;
+    lowpass_on = filter_type_ == LOWPASS;
+    bandpass_on = filter_type_ == BANDPASS;
+    highpass_on = filter_type_ == HIGHPASS;
+    filter_type = filter_type_;
+
+    std::cout << name << " is now a "
+              << (lowpass_on ? "low pass" : bandpass_on ? "bandpass"
+                  : "highpass")
+              << " filter" << std::endl;
+
+    if(graphics_objects_initialized)
+    {
+        ((Toggle_Button *) graphics_objects["lowpass toggle button"])->b =
+            lowpass_on;
+        ((Toggle_Button *) graphics_objects["bandpass toggle button"])->b =
+            bandpass_on;
+        ((Toggle_Button *) graphics_objects["highpass toggle button"])->b =
+            highpass_on;
     }
+}
 
-    filter_type = filter_type_;
+/*
+ * Switch to a cascade of the given number of stages, 1, 2, or 4, rounded down
+ * to one of those, and update the slope toggle buttons to match if there are
+ * any.
+ */
+void Filter::switch_num_stages(unsigned int num_stages_)
+{
+    num_stages = num_stages_ >= 4 ? 4 : num_stages_ >= 2 ? 2 : 1;
+
+    std::cout << name << " now has a slope of " << num_stages * 12
+              << " dB per octave" << std::endl;
+
+    if(graphics_objects_initialized)
+    {
+        ((Toggle_Button *) graphics_objects["12 dB toggle button"])->b =
+            num_stages == 1;
+        ((Toggle_Button *) graphics_objects["24 dB toggle button"])->b =
+            num_stages == 2;
+        ((Toggle_Button *) graphics_objects["48 dB toggle button"])->b =
+            num_stages == 4;
+    }
+}
+
+/*
+ * Switch to a cascade of stages with the given topology, and update the
+ * topology toggle buttons to match if there are any.
+ */
+void Filter::switch_topology(FilterTopology topology_)
+{
+    topology = topology_;
+
+    std::cout << name << " is now made of "
+              << (topology == SVF ? "state variable" : "biquad")
+              << " filters" << std::endl;
+
+    if(graphics_objects_initialized)
+    {
+        ((Toggle_Button *) graphics_objects["biquad toggle button"])->b =
+            topology == BIQUAD;
+        ((Toggle_Button *) graphics_objects["svf toggle button"])->b =
+            topology == SVF;
+    }
 }
 
 std::string Filter::get_unique_text_representation()
 {
-    return "";
+    return std::to_string(filter_type) + "\n"
+           + std::to_string(num_stages) + "\n"
+           + std::to_string(topology) + "\n";
 }
 
+/*
+ * Restore the filter type, number of stages, and topology, patches saved
+ * before there was a choice of topology use biquads.
+ */
+void Filter::set_unique_text_representation(std::vector<std::string> *lines)
+{
+    if(lines->size() >= 2)
+    {
+        switch_filter((FilterType) stoi((*lines)[0]));
+        switch_num_stages(stoi((*lines)[1]));
+    }
+    if(lines->size() >= 3)
+    {
+        switch_topology((FilterTopology) stoi((*lines)[2]));
+    }
+}
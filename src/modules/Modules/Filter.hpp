@@ -1,6 +1,14 @@
 /*
  * Matthew Diamond 2015
- * The filter module.
+ * The filter module. This module filters its input signal through a cascade
+ * of 1, 2, or 4 biquad filters, for slopes of 12, 24, or 48 dB per octave.
+ * When the cutoff or q moves, the coefficients are recalculated for it every
+ * few samples, so that sweeping the cutoff does not zipper. For cutoffs
+ * modulated at audio rate, the cascade can be made of state variable filters
+ * instead, which follow the cutoff and q at every sample. Besides its main
+ * output, for its filter type, the filter has a lowpass, a bandpass, and a
+ * highpass output, which the state variable filters fill all at once. This
+ * file defines the class.
  */
 
 #ifndef MSS_FILTER_HPP
@@ -27,6 +35,13 @@ public:
         HIGHPASS
     };
 
+    // Filter topology enum
+    enum FilterTopology
+    {
+        BIQUAD = 0,
+        SVF
+    };
+
     // Filter dependencies enum
     enum FilterDependencies
     {
@@ -35,26 +50,73 @@ public:
         FILTER_Q,
     };
 
-    // Vectors to track samples passing through and the impulse response
-    std::vector<float> iir_samples, iir_coefficients;
-    double y1, y2, x1, x2;
+    // Filter outputs enum, the main output followed by the output of each
+    // filter type
+    enum FilterOutputs
+    {
+        FILTER_OUTPUT = 0,
+        FILTER_LOWPASS_OUTPUT,
+        FILTER_BANDPASS_OUTPUT,
+        FILTER_HIGHPASS_OUTPUT
+    };
+
+    // The most stages in a cascade, and the number of samples the
+    // coefficients are calculated for at a time while the cutoff or q is live
+    static const unsigned int MAX_STAGES = 4;
+    static const unsigned int SUB_BLOCK_SIZE = 32;
+
+    // The normalized coefficients of every biquad stage, b0, b1, b2, a1, then
+    // a2, each with one lane per stage, and the history of every stage, which
+    // for state variable filters holds the state of both integrators
+    float coefficients[5 * MAX_STAGES];
+    float history[2 * MAX_STAGES];
+    // The cutoff and q of the biquads, and the gain of the state variable
+    // filters' integrators and the damping of their last stage, after the
+    // last block
+    float biquad_cutoff, biquad_q;
+    float svf_gain, svf_damping;
+    // The number of stages in the cascade and their topology, and those used
+    // during the last block
+    unsigned int num_stages;
+    unsigned int processed_stages;
+    FilterTopology topology;
+    FilterTopology processed_topology;
     FilterType filter_type;
     bool lowpass_on, bandpass_on, highpass_on;
+    // Whether or not the filter has rung out on a silent signal, and skipped
+    // blocks since, so that it starts over when the signal comes back
+    bool rung_out;
 
     // Constructor and destructor
     Filter();
     virtual ~Filter();
 
     // Member functions, explained in Module.hpp
-    virtual void process();
+    virtual void process(unsigned int);
+    virtual bool reads_control_rate(unsigned int);
     virtual bool handle_event(Graphics_Object *);
     virtual void calculate_unique_graphics_object_locations();
     virtual void initialize_unique_graphics_objects();
     virtual std::string get_unique_text_representation();
+    virtual void set_unique_text_representation(std::vector<std::string> *);
 
     // Member functions particular to this module
-    //   Switch to the given waveform type
+    //   Filter the given signal into the output buffer through a cascade of
+    //   biquad filters or of state variable filters, starting the
+    //   coefficients from scratch if told to
+    void process_biquads(const float *, unsigned int, bool);
+    void process_svfs(const float *, unsigned int, bool);
+    //   Return whether or not the state of every stage is close enough to
+    //   silence to stop filtering a silent signal
+    bool state_silent();
+    //   Calculate the coefficients of every stage for the given cutoff and q
+    void calculate_coefficients(float, float);
+    //   Switch to the given filter type
     void switch_filter(FilterType);
+    //   Switch to the given number of stages
+    void switch_num_stages(unsigned int);
+    //   Switch to the given filter topology
+    void switch_topology(FilterTopology);
 };
 
 #endif
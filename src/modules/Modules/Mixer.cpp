@@ -8,6 +8,7 @@
  ************/
 
 // Included libraries
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <string>
@@ -21,26 +22,49 @@
 #include "graphics_object_utils.hpp"
 #include "image_processing.hpp"
 #include "main.hpp"
+#include "module_utils.hpp"
+#include "signal_kernels.hpp"
 #include "signal_processing.hpp"
 
+// Included "other" classes
+#include "Command_Queue.hpp"
+
 // Included modules classes
 #include "Module.hpp"
 #include "Modules/Mixer.hpp"
 
+/*************************
+ * STATIC MEMBER STORAGE *
+ *************************/
+
+// Passed by reference to std::min() and std::max(), so they need storage
+const unsigned int Mixer::MAX_CHANNELS;
+const unsigned int Mixer::CHANNELS_PER_PAGE;
+
 /**************************
  * MIXER MEMBER FUNCTIONS *
  **************************/
 
 /*
- * Constructor.
+ * Constructor. The module starts out with the inputs of every channel it
+ * could have, which is kept as the capacity of the inputs, so that adding
+ * channels never moves the inputs the audio thread is reading.
  */
 Mixer::Mixer() :
     Module(MIXER),
-    auto_attenuate(false)
+    auto_attenuate(false), num_channels(CHANNELS_PER_PAGE),
+    processed_channels(CHANNELS_PER_PAGE), first_shown_channel(0)
 {
+    inputs.resize(2 * num_channels);
+
+    // Make room for every signal ahead of time, so that gathering them never
+    // allocates memory while processing
+    constant_signals.reserve(MAX_CHANNELS);
+    constant_multipliers.reserve(MAX_CHANNELS);
+
     // All multiplier floats should start at 1
     for(unsigned int i = 0; i < inputs.size(); i ++)
-        if(i % 2 == 1)
+        if(i % 2 == MIXER_SIGNAL_MULTIPLIER)
         {
             inputs[i].val = 1;
         }
@@ -53,52 +77,137 @@ Mixer::~Mixer()
 {}
 
 /*
- * Process all dependencies, then sum and attenuate all signal inputs.
+ * Sum and attenuate all signal inputs. Which channels are live is worked out
+ * once per buffer, then each live signal is added to the output buffer by a
+ * kernel, all of those with constant multipliers in a single pass.
  */
-void Mixer::process()
+void Mixer::process(unsigned int num_samples)
 {
-    short num_channels = 0;
-
-    // Process any dependencies
-    process_dependencies();
-
-    // Reset the output buffer
-    std::fill(out.begin(), out.end(), 0);
-
-    // For each sample
-    for(unsigned int i = 0; i < BUFFER_SIZE; i ++)
+    unsigned int num_inputs = 2 * processed_channels;
+    unsigned int num_live_channels = 0;
+    bool live_multipliers = false;
+    float attenuation = 1;
+
+    // Gather the live signals with constant multipliers, these are all mixed
+    // together in a single pass over the output buffer, silent signals still
+    // count towards auto attenuation, but are never mixed
+    constant_signals.clear();
+    constant_multipliers.clear();
+    for(unsigned int j = 0; j < num_inputs; j += 2)
     {
-        // Update parameters
-        update_input_vals(i);
-
-        num_channels = 0;
+        if(inputs[j].live)
+        {
+            num_live_channels ++;
 
-        // Determine how many channels are active
-        for(unsigned int j = 0; j < inputs.size(); j += 2)
-            if(inputs[j].live)
+            if(input_silent(j))
             {
-                num_channels ++;
+                continue;
             }
-
-        // For each live signal, fetch the relevant sample, multiply by the
-        // associated input multiplier, then add it to the associated sample in
-        // the output buffer
-        for(unsigned int j = 0; j < inputs.size(); j += 2)
-            if(inputs[j].live)
+            else if(!inputs[j + 1].live)
             {
-                out[i] += inputs[j].val * inputs[j + 1].val;
+                constant_signals.push_back(inputs[j].in);
+                constant_multipliers.push_back(inputs[j + 1].val);
             }
+            else
+            {
+                live_multipliers = true;
+            }
+        }
+    }
+
+    // If auto attenuation is enabled, divide the signal by the number of
+    // signals active, which without any live multipliers is done along with
+    // the constant multipliers
+    if(auto_attenuate && num_live_channels != 0)
+    {
+        attenuation = 1.0f / num_live_channels;
+    }
+    if(!live_multipliers)
+    {
+        for(unsigned int j = 0; j < constant_multipliers.size(); j ++)
+        {
+            constant_multipliers[j] *= attenuation;
+        }
+    }
+
+    mix_samples(constant_signals.data(), constant_multipliers.data(),
+                constant_signals.size(), out, num_samples);
 
-        // If auto attenuation is enabled, divide the signal by the number of
-        // signals active
-        if(auto_attenuate)
-            if(num_channels != 0)
+    // Then multiply each live signal with a live multiplier by that multiplier
+    // and add it to the output buffer
+    if(live_multipliers)
+    {
+        for(unsigned int j = 0; j < num_inputs; j += 2)
+        {
+            if(inputs[j].live && inputs[j + 1].live && !input_silent(j))
             {
-                out[i] /= num_channels;
+                multiply_add_samples(inputs[j].in, inputs[j + 1].in, out,
+                                     num_samples);
             }
+        }
+
+        if(attenuation != 1)
+        {
+            multiply_samples(out, attenuation, out, num_samples);
+        }
     }
 
-    processed = true;
+    // Only the inputs of the channels processed are updated, the main thread
+    // may be adding inputs for more
+    for(unsigned int j = 0; j < num_inputs; j ++)
+    {
+        if(inputs[j].live)
+        {
+            inputs[j].val = inputs[j].in[num_samples - 1];
+        }
+    }
+}
+
+/*
+ * The signal multipliers can read a signal calculated at control rate, the
+ * signals being mixed cannot.
+ */
+bool Mixer::reads_control_rate(unsigned int input_num)
+{
+    return input_num % 2 == MIXER_SIGNAL_MULTIPLIER;
+}
+
+/*
+ * Only the channels processed are read. The signal of a channel is not read
+ * if its multiplier is constant at 0, and the multiplier is not read if there
+ * is no signal.
+ */
+bool Mixer::reads_input(unsigned int input_num)
+{
+    unsigned int signal = input_num - input_num % 2;
+
+    if(signal / 2 >= processed_channels)
+    {
+        return false;
+    }
+    else if(input_num % 2 == MIXER_SIGNAL_MULTIPLIER)
+    {
+        return inputs[signal].live;
+    }
+
+    return inputs[signal + 1].live || inputs[signal + 1].val != 0;
+}
+
+/*
+ * A mixer keeps no state between blocks, so it can go dormant.
+ */
+bool Mixer::can_go_dormant()
+{
+    return true;
+}
+
+/*
+ * A mixer's output only depends on its inputs, so it is the same as long as
+ * they are.
+ */
+bool Mixer::output_static()
+{
+    return true;
 }
 
 /*
@@ -120,6 +229,34 @@ bool Mixer::handle_event(Graphics_Object *g)
         toggle_auto_attenuation();
         return true;
     }
+    // Handle channel page buttons
+    else if(g == graphics_objects["previous channels button"])
+    {
+        if(first_shown_channel >= CHANNELS_PER_PAGE)
+        {
+            show_channels(first_shown_channel - CHANNELS_PER_PAGE);
+        }
+        return true;
+    }
+    else if(g == graphics_objects["next channels button"])
+    {
+        show_channels(first_shown_channel + CHANNELS_PER_PAGE);
+        return true;
+    }
+    // Handle add and remove channels buttons
+    else if(g == graphics_objects["remove channels button"])
+    {
+        if(num_channels > CHANNELS_PER_PAGE)
+        {
+            switch_num_channels(num_channels - CHANNELS_PER_PAGE);
+        }
+        return true;
+    }
+    else if(g == graphics_objects["add channels button"])
+    {
+        switch_num_channels(num_channels + CHANNELS_PER_PAGE);
+        return true;
+    }
     // If none of the above, handle events that apply to all modules, return
     // true if an event is handled
     else if(Module::handle_event(g))
@@ -143,12 +280,21 @@ void Mixer::calculate_unique_graphics_object_locations()
     location = {upper_left.x, upper_left.y + 15, MODULE_WIDTH, 34};
     graphics_object_locations["waveform"] = location;
 
-    // Signals text graphics object location
+    // Signals text and channel related graphics object locations
     location = {upper_left.x + 2, location.y + 37, 0, 0};
     graphics_object_locations["signals text"] = location;
-
-    // Signal and signal multipler related graphics object locations
-    for(int i = 1; i <= 5; i ++)
+    location = {upper_left.x + MODULE_WIDTH - 32, location.y, 7, 9};
+    graphics_object_locations["previous channels button"] = location;
+    location = {location.x + location.w + 1, location.y, 7, 9};
+    graphics_object_locations["next channels button"] = location;
+    location = {location.x + location.w + 1, location.y, 7, 9};
+    graphics_object_locations["remove channels button"] = location;
+    location = {location.x + location.w + 1, location.y, 7, 9};
+    graphics_object_locations["add channels button"] = location;
+
+    // Signal and signal multipler related graphics object locations, one row
+    // for each channel shown
+    for(unsigned int i = 1; i <= CHANNELS_PER_PAGE; i ++)
     {
         location = {upper_left.x, location.y + 10, (MODULE_WIDTH / 2) - 9, 9};
         graphics_object_locations["signal " + std::to_string(i) + " text box"] = location;
@@ -174,178 +320,69 @@ void Mixer::calculate_unique_graphics_object_locations()
  */
 void Mixer::initialize_unique_graphics_objects()
 {
+    std::string row;
+
     // Initialize text objects
     graphics_objects["signals text"] =
         new Text(name + " signals text",
                  graphics_object_locations["signals text"],
-                 secondary_module_color, "SIGNALS & MULTIPLIERS:");
+                 secondary_module_color, "SIGNALS:");
     graphics_objects["auto attenuate text"] =
         new Text(name + " auto attenuate text",
                  graphics_object_locations["auto attenuate text"],
                  secondary_module_color, "AUTO ATTENUATE:");
 
+    // Initialize channel page and add and remove channels buttons
+    graphics_objects["previous channels button"] =
+        new Button(name + " previous channels button",
+                   graphics_object_locations["previous channels button"],
+                   secondary_module_color, primary_module_color, "<", this);
+    graphics_objects["next channels button"] =
+        new Button(name + " next channels button",
+                   graphics_object_locations["next channels button"],
+                   secondary_module_color, primary_module_color, ">", this);
+    graphics_objects["remove channels button"] =
+        new Button(name + " remove channels button",
+                   graphics_object_locations["remove channels button"],
+                   secondary_module_color, primary_module_color, "-", this);
+    graphics_objects["add channels button"] =
+        new Button(name + " add channels button",
+                   graphics_object_locations["add channels button"],
+                   secondary_module_color, primary_module_color, "+", this);
+
     // Initialize waveform viewer
     graphics_objects["waveform"] =
         new Waveform(name + " waveform",
                      graphics_object_locations["waveform"],
                      primary_module_color, secondary_module_color, &out);
 
-    // Initialize text boxes
-    graphics_objects["signal 1 text box"] =
-        new Text_Box(name + " signal 1 text box",
-                     graphics_object_locations["signal 1 text box"],
-                     secondary_module_color, primary_module_color,
-                     "input", (Graphics_Listener *) this);
-    graphics_objects["signal 1 multiplier text box"] =
-        new Text_Box(name + " signal 1 multiplier text box",
-                     graphics_object_locations["signal 1 multiplier text box"],
-                     secondary_module_color, primary_module_color,
-                     "# or input", (Graphics_Listener *) this);
-    graphics_objects["signal 2 text box"] =
-        new Text_Box(name + " signal 2 text box",
-                     graphics_object_locations["signal 2 text box"],
-                     secondary_module_color, primary_module_color,
-                     "input", (Graphics_Listener *) this);
-    graphics_objects["signal 2 multiplier text box"] =
-        new Text_Box(name + " signal 2 multiplier text box",
-                     graphics_object_locations["signal 2 multiplier text box"],
-                     secondary_module_color, primary_module_color,
-                     "# or input", (Graphics_Listener *) this);
-    graphics_objects["signal 3 text box"] =
-        new Text_Box(name + " signal 3 text box",
-                     graphics_object_locations["signal 3 text box"],
-                     secondary_module_color, primary_module_color,
-                     "input", (Graphics_Listener *) this);
-    graphics_objects["signal 3 multiplier text box"] =
-        new Text_Box(name + " signal 3 multiplier text box",
-                     graphics_object_locations["signal 3 multiplier text box"],
-                     secondary_module_color, primary_module_color,
-                     "# or input", (Graphics_Listener *) this);
-    graphics_objects["signal 4 text box"] =
-        new Text_Box(name + " signal 4 text box",
-                     graphics_object_locations["signal 4 text box"],
-                     secondary_module_color, primary_module_color,
-                     "input", (Graphics_Listener *) this);
-    graphics_objects["signal 4 multiplier text box"] =
-        new Text_Box(name + " signal 4 multiplier text box",
-                     graphics_object_locations["signal 4 multiplier text box"],
-                     secondary_module_color, primary_module_color,
-                     "# or input", (Graphics_Listener *) this);
-    graphics_objects["signal 5 text box"] =
-        new Text_Box(name + " signal 5 text box",
-                     graphics_object_locations["signal 5 text box"],
-                     secondary_module_color, primary_module_color,
-                     "input", (Graphics_Listener *) this);
-    graphics_objects["signal 5 multiplier text box"] =
-        new Text_Box(name + " signal 5 multiplier text box",
-                     graphics_object_locations["signal 5 multiplier text box"],
-                     secondary_module_color, primary_module_color,
-                     "# or input", (Graphics_Listener *) this);
-
-    // Initialize toggle buttons
-    graphics_objects["signal 1 toggle button"] =
-        new Toggle_Button(name + " signal 1 toggle button",
-                          graphics_object_locations["signal 1 toggle button"],
-                          secondary_module_color, secondary_module_color,
-                          RED, primary_module_color, "I", "I", false,
-                          (Graphics_Listener *) this);
-    graphics_objects["signal 1 multiplier toggle button"] =
-        new Toggle_Button(name + " signal 1 multiplier toggle button",
-                          graphics_object_locations["signal 1 multiplier toggle button"],
-                          secondary_module_color, secondary_module_color,
-                          RED, primary_module_color, "I", "I", false,
-                          (Graphics_Listener *) this);
-    graphics_objects["signal 2 toggle button"] =
-        new Toggle_Button(name + " signal 2 toggle button",
-                          graphics_object_locations["signal 2 toggle button"],
-                          secondary_module_color, secondary_module_color,
-                          RED, primary_module_color, "I", "I", false,
-                          (Graphics_Listener *) this);
-    graphics_objects["signal 2 multiplier toggle button"] =
-        new Toggle_Button(name + " signal 2 multiplier toggle button",
-                          graphics_object_locations["signal 2 multiplier toggle button"],
-                          secondary_module_color, secondary_module_color,
-                          RED, primary_module_color, "I", "I", false,
-                          (Graphics_Listener *) this);
-    graphics_objects["signal 3 toggle button"] =
-        new Toggle_Button(name + " signal 3 toggle button",
-                          graphics_object_locations["signal 3 toggle button"],
-                          secondary_module_color, secondary_module_color,
-                          RED, primary_module_color, "I", "I", false,
-                          (Graphics_Listener *) this);
-    graphics_objects["signal 3 multiplier toggle button"] =
-        new Toggle_Button(name + " signal 3 multiplier toggle button",
-                          graphics_object_locations["signal 3 multiplier toggle button"],
-                          secondary_module_color, secondary_module_color,
-                          RED, primary_module_color, "I", "I", false,
-                          (Graphics_Listener *) this);
-    graphics_objects["signal 4 toggle button"] =
-        new Toggle_Button(name + " signal 4 toggle button",
-                          graphics_object_locations["signal 4 toggle button"],
-                          secondary_module_color, secondary_module_color,
-                          RED, primary_module_color, "I", "I", false,
-                          (Graphics_Listener *) this);
-    graphics_objects["signal 4 multiplier toggle button"] =
-        new Toggle_Button(name + " signal 4 multiplier toggle button",
-                          graphics_object_locations["signal 4 multiplier toggle button"],
-                          secondary_module_color, secondary_module_color,
-                          RED, primary_module_color, "I", "I", false,
-                          (Graphics_Listener *) this);
-    graphics_objects["signal 5 toggle button"] =
-        new Toggle_Button(name + " signal 5 toggle button",
-                          graphics_object_locations["signal 5 toggle button"],
-                          secondary_module_color, secondary_module_color,
-                          RED, primary_module_color, "I", "I", false,
-                          (Graphics_Listener *) this);
-    graphics_objects["signal 5 multiplier toggle button"] =
-        new Toggle_Button(name + " signal 5 multiplier toggle button",
-                          graphics_object_locations["signal 5 multiplier toggle button"],
-                          secondary_module_color, secondary_module_color,
-                          RED, primary_module_color, "I", "I", false,
-                          (Graphics_Listener *) this);
-
-    // Store pointers to these graphics objects in the necessary data
-    // structures
-    text_box_to_input_num[(Text_Box *) graphics_objects["signal 1 text box"]] = MIXER_SIGNAL_1;
-    toggle_button_to_input_num[(Toggle_Button *) graphics_objects["signal 1 toggle button"]] = MIXER_SIGNAL_1;
-    inputs[MIXER_SIGNAL_1].text_box = (Text_Box *) graphics_objects["signal 1 text box"];
-    inputs[MIXER_SIGNAL_1].toggle_button = (Toggle_Button *) graphics_objects["signal 1 toggle button"];
-    text_box_to_input_num[(Text_Box *) graphics_objects["signal 1 multiplier text box"]] = MIXER_SIGNAL_1_MULTIPLIER;
-    toggle_button_to_input_num[(Toggle_Button *) graphics_objects["signal 1 multiplier toggle button"]] = MIXER_SIGNAL_1_MULTIPLIER;
-    inputs[MIXER_SIGNAL_1_MULTIPLIER].text_box = (Text_Box *) graphics_objects["signal 1 multiplier text box"];
-    inputs[MIXER_SIGNAL_1_MULTIPLIER].toggle_button = (Toggle_Button *) graphics_objects["signal 1 multiplier toggle button"];
-    text_box_to_input_num[(Text_Box *) graphics_objects["signal 2 text box"]] = MIXER_SIGNAL_2;
-    toggle_button_to_input_num[(Toggle_Button *) graphics_objects["signal 2 toggle button"]] = MIXER_SIGNAL_2;
-    inputs[MIXER_SIGNAL_2].text_box = (Text_Box *) graphics_objects["signal 2 text box"];
-    inputs[MIXER_SIGNAL_2].toggle_button = (Toggle_Button *) graphics_objects["signal 2 toggle button"];
-    text_box_to_input_num[(Text_Box *) graphics_objects["signal 2 multiplier text box"]] = MIXER_SIGNAL_2_MULTIPLIER;
-    toggle_button_to_input_num[(Toggle_Button *) graphics_objects["signal 2 multiplier toggle button"]] = MIXER_SIGNAL_2_MULTIPLIER;
-    inputs[MIXER_SIGNAL_2_MULTIPLIER].text_box = (Text_Box *) graphics_objects["signal 2 multiplier text box"];
-    inputs[MIXER_SIGNAL_2_MULTIPLIER].toggle_button = (Toggle_Button *) graphics_objects["signal 2 multiplier toggle button"];
-    text_box_to_input_num[(Text_Box *) graphics_objects["signal 3 text box"]] = MIXER_SIGNAL_3;
-    toggle_button_to_input_num[(Toggle_Button *) graphics_objects["signal 3 toggle button"]] = MIXER_SIGNAL_3;
-    inputs[MIXER_SIGNAL_3].text_box = (Text_Box *) graphics_objects["signal 3 text box"];
-    inputs[MIXER_SIGNAL_3].toggle_button = (Toggle_Button *) graphics_objects["signal 3 toggle button"];
-    text_box_to_input_num[(Text_Box *) graphics_objects["signal 3 multiplier text box"]] = MIXER_SIGNAL_3_MULTIPLIER;
-    toggle_button_to_input_num[(Toggle_Button *) graphics_objects["signal 3 multiplier toggle button"]] = MIXER_SIGNAL_3_MULTIPLIER;
-    inputs[MIXER_SIGNAL_3_MULTIPLIER].text_box = (Text_Box *) graphics_objects["signal 3 multiplier text box"];
-    inputs[MIXER_SIGNAL_3_MULTIPLIER].toggle_button = (Toggle_Button *) graphics_objects["signal 3 multiplier toggle button"];
-    text_box_to_input_num[(Text_Box *) graphics_objects["signal 4 text box"]] = MIXER_SIGNAL_4;
-    toggle_button_to_input_num[(Toggle_Button *) graphics_objects["signal 4 toggle button"]] = MIXER_SIGNAL_4;
-    inputs[MIXER_SIGNAL_4].text_box = (Text_Box *) graphics_objects["signal 4 text box"];
-    inputs[MIXER_SIGNAL_4].toggle_button = (Toggle_Button *) graphics_objects["signal 4 toggle button"];
-    text_box_to_input_num[(Text_Box *) graphics_objects["signal 4 multiplier text box"]] = MIXER_SIGNAL_4_MULTIPLIER;
-    toggle_button_to_input_num[(Toggle_Button *) graphics_objects["signal 4 multiplier toggle button"]] = MIXER_SIGNAL_4_MULTIPLIER;
-    inputs[MIXER_SIGNAL_4_MULTIPLIER].text_box = (Text_Box *) graphics_objects["signal 4 multiplier text box"];
-    inputs[MIXER_SIGNAL_4_MULTIPLIER].toggle_button = (Toggle_Button *) graphics_objects["signal 4 multiplier toggle button"];
-    text_box_to_input_num[(Text_Box *) graphics_objects["signal 5 text box"]] = MIXER_SIGNAL_5;
-    toggle_button_to_input_num[(Toggle_Button *) graphics_objects["signal 5 toggle button"]] = MIXER_SIGNAL_5;
-    inputs[MIXER_SIGNAL_5].text_box = (Text_Box *) graphics_objects["signal 5 text box"];
-    inputs[MIXER_SIGNAL_5].toggle_button = (Toggle_Button *) graphics_objects["signal 5 toggle button"];
-    text_box_to_input_num[(Text_Box *) graphics_objects["signal 5 multiplier text box"]] = MIXER_SIGNAL_5_MULTIPLIER;
-    toggle_button_to_input_num[(Toggle_Button *) graphics_objects["signal 5 multiplier toggle button"]] = MIXER_SIGNAL_5_MULTIPLIER;
-    inputs[MIXER_SIGNAL_5_MULTIPLIER].text_box = (Text_Box *) graphics_objects["signal 5 multiplier text box"];
-    inputs[MIXER_SIGNAL_5_MULTIPLIER].toggle_button = (Toggle_Button *) graphics_objects["signal 5 multiplier toggle button"];
+    // Initialize the text boxes and toggle buttons of each row
+    for(unsigned int i = 1; i <= CHANNELS_PER_PAGE; i ++)
+    {
+        row = "signal " + std::to_string(i);
+        graphics_objects[row + " text box"] =
+            new Text_Box(name + " " + row + " text box",
+                         graphics_object_locations[row + " text box"],
+                         secondary_module_color, primary_module_color,
+                         "input", (Graphics_Listener *) this);
+        graphics_objects[row + " multiplier text box"] =
+            new Text_Box(name + " " + row + " multiplier text box",
+                         graphics_object_locations[row + " multiplier text box"],
+                         secondary_module_color, primary_module_color,
+                         "# or input", (Graphics_Listener *) this);
+        graphics_objects[row + " toggle button"] =
+            new Toggle_Button(name + " " + row + " toggle button",
+                              graphics_object_locations[row + " toggle button"],
+                              secondary_module_color, secondary_module_color,
+                              RED, primary_module_color, "I", "I", false,
+                              (Graphics_Listener *) this);
+        graphics_objects[row + " multiplier toggle button"] =
+            new Toggle_Button(name + " " + row + " multiplier toggle button",
+                              graphics_object_locations[row + " multiplier toggle button"],
+                              secondary_module_color, secondary_module_color,
+                              RED, primary_module_color, "I", "I", false,
+                              (Graphics_Listener *) this);
+    }
 
     // Initialize filter type toggle buttons
     graphics_objects["auto attenuate toggle button"] =
@@ -353,14 +390,161 @@ void Mixer::initialize_unique_graphics_objects()
                           graphics_object_locations["auto attenuate toggle button"],
                           secondary_module_color, primary_module_color,
                           primary_module_color, secondary_module_color,
-                          "ON", "OFF", false, (Graphics_Listener *) this);
+                          "ON", "OFF", auto_attenuate,
+                          (Graphics_Listener *) this);
+
+    // Store pointers to these graphics objects in the necessary data
+    // structures
+    attach_shown_channels();
+}
+
+/*
+ * Point the text boxes and toggle buttons of each row at the inputs of the
+ * channel it shows, and show what each of those inputs is set to. The inputs
+ * of every other channel have no text box or toggle button.
+ */
+void Mixer::attach_shown_channels()
+{
+    text_box_to_input_num.clear();
+    toggle_button_to_input_num.clear();
+    for(unsigned int i = 0; i < inputs.size(); i ++)
+    {
+        inputs[i].text_box = nullptr;
+        inputs[i].toggle_button = nullptr;
+    }
+
+    for(unsigned int i = 0; i < 2 * CHANNELS_PER_PAGE; i ++)
+    {
+        unsigned int input_num = 2 * first_shown_channel + i;
+        std::string object = "signal " + std::to_string(i / 2 + 1)
+                             + (i % 2 == MIXER_SIGNAL ? "" : " multiplier");
+        Text_Box *text_box = (Text_Box *) graphics_objects[object + " text box"];
+        Toggle_Button *toggle_button =
+            (Toggle_Button *) graphics_objects[object + " toggle button"];
+
+        text_box_to_input_num[text_box] = input_num;
+        toggle_button_to_input_num[toggle_button] = input_num;
+        inputs[input_num].text_box = text_box;
+        inputs[input_num].toggle_button = toggle_button;
+
+        if(inputs[input_num].from != nullptr)
+        {
+            text_box->update_current_text(
+                inputs[input_num].from->get_short_output_name(
+                    inputs[input_num].from_output));
+        }
+        else if(i % 2 == MIXER_SIGNAL)
+        {
+            text_box->update_current_text("");
+        }
+        else
+        {
+            text_box->update_current_text(
+                std::to_string(inputs[input_num].val));
+        }
+        toggle_button->b = inputs[input_num].from != nullptr;
+    }
+
+    ((Text *) graphics_objects["signals text"])->update_text(
+        "SIGNALS " + std::to_string(first_shown_channel + 1) + "-"
+        + std::to_string(first_shown_channel + CHANNELS_PER_PAGE) + "/"
+        + std::to_string(num_channels) + ":");
+
+    adopt_input_colors();
 }
 
+/*
+ * Show the page of channels starting at the given channel, or the last page
+ * if there are not that many channels. A source being selected for one of the
+ * channels shown is forgotten, since its toggle button is about to show
+ * another channel.
+ */
+void Mixer::show_channels(unsigned int first_channel)
+{
+    first_shown_channel = std::min(first_channel,
+                                   num_channels - CHANNELS_PER_PAGE);
+
+    if(SELECTING_FOR_MODULE == this)
+    {
+        SELECTING_SRC = false;
+        CURRENT_TOGGLE_BUTTON = nullptr;
+        SELECTING_FOR_MODULE = nullptr;
+    }
+
+    if(graphics_objects_initialized)
+    {
+        attach_shown_channels();
+    }
+}
+
+/*
+ * Switch to the given number of channels, rounded up to a whole number of
+ * pages, from one page up to the most channels a mixer can have. The inputs of
+ * channels being added are created before the audio thread is told to process
+ * them, and the inputs of channels being removed stop reading from other
+ * modules and are only removed once the audio thread has been told to stop
+ * processing them. Removing inputs never frees memory, so the audio thread is
+ * never left reading inputs that are gone.
+ */
+void Mixer::switch_num_channels(unsigned int num_channels_)
+{
+    Command_Queue::Command command;
+
+    num_channels_ = (num_channels_ + CHANNELS_PER_PAGE - 1)
+                    / CHANNELS_PER_PAGE * CHANNELS_PER_PAGE;
+    num_channels_ = std::max(CHANNELS_PER_PAGE,
+                             std::min(num_channels_, MAX_CHANNELS));
+
+    // Cancel the inputs of channels being removed, all in one execution plan
+    defer_execution_plan_updates();
+    for(unsigned int i = 2 * num_channels_; i < inputs.size(); i ++)
+    {
+        if(inputs[i].from != nullptr)
+        {
+            cancel_input(i);
+        }
+    }
+    resume_execution_plan_updates();
+
+    // Create the inputs of channels being added, multipliers start at 1
+    for(unsigned int i = inputs.size(); i < 2 * num_channels_; i ++)
+    {
+        inputs.push_back(Parameter());
+        if(i % 2 == MIXER_SIGNAL_MULTIPLIER)
+        {
+            inputs[i].val = 1;
+            inputs[i].saved_val = 1;
+        }
+    }
+
+    num_channels = num_channels_;
+    command.command_type = Command_Queue::SET_NUM_CHANNELS;
+    command.module = this;
+    command.input_num = num_channels;
+    COMMAND_QUEUE.post(command);
+
+    inputs.resize(2 * num_channels);
+
+    std::cout << name << " now has " << num_channels << " channels"
+              << std::endl;
+
+    show_channels(first_shown_channel);
+}
+
+/*
+ * Turn auto attenuation on or off, and update the auto attenuate toggle
+ * button to match if there is one.
+ */
 void Mixer::toggle_auto_attenuation()
 {
     auto_attenuate = !auto_attenuate;
+    changed = true;
 
-    ((Toggle_Button *) graphics_objects["auto attenuate toggle button"])->toggle();
+    if(graphics_objects_initialized)
+    {
+        ((Toggle_Button *) graphics_objects["auto attenuate toggle button"])->b =
+            auto_attenuate;
+    }
 
     std::cout << name << " auto attenuation is now "
               << (auto_attenuate ? "on" : "off") << std::endl;
@@ -368,6 +552,31 @@ void Mixer::toggle_auto_attenuation()
 
 std::string Mixer::get_unique_text_representation()
 {
-    return "";
+    return std::to_string(auto_attenuate) + "\n";
+}
+
+/*
+ * Restore whether or not auto attenuation is used, patches saved before it
+ * was saved do not use it.
+ */
+void Mixer::set_unique_text_representation(std::vector<std::string> *lines)
+{
+    if(lines->size() >= 1 && (stoi((*lines)[0]) != 0) != auto_attenuate)
+    {
+        toggle_auto_attenuation();
+    }
 }
 
+/*
+ * Switch to the number of channels in a text representation with the given
+ * number of lines, and return the number of inputs of those channels. Each
+ * channel takes four lines, the values and sources of its signal and
+ * multiplier, and there are fewer than four unique lines, so patches saved
+ * before the number of channels could change have five.
+ */
+unsigned int Mixer::saved_inputs(unsigned int num_lines)
+{
+    switch_num_channels(num_lines / 4);
+
+    return inputs.size();
+}
@@ -1,8 +1,10 @@
 /*
  * Matthew Diamond 2015
- * The mixer module. This module attenuates and then sums a few signals. It is
- * capable of automatically attenuating based on how many channels are active
- * if desired.
+ * The mixer module. This module attenuates and then sums any number of
+ * signals, up to a few dozen, each with its own multiplier. It is capable of
+ * automatically attenuating based on how many channels are active if desired.
+ * Channels are added and removed a page at a time, and one page of channels
+ * is shown at once.
  */
 
 #ifndef MSS_MIXER_HPP
@@ -21,35 +23,61 @@
 class Mixer: public Module
 {
 public:
-    // Mixer dependencies enum
+    // The most channels a mixer can have, and the number of channels shown
+    // at once, a mixer always has a whole number of pages of channels
+    static const unsigned int MAX_CHANNELS = 60;
+    static const unsigned int CHANNELS_PER_PAGE = 5;
+
+    // Mixer dependencies enum, the inputs of each channel, channel c's inputs
+    // are numbered from 2c
     enum MixerDependencies
     {
-        MIXER_SIGNAL_1 = 0,
-        MIXER_SIGNAL_1_MULTIPLIER,
-        MIXER_SIGNAL_2,
-        MIXER_SIGNAL_2_MULTIPLIER,
-        MIXER_SIGNAL_3,
-        MIXER_SIGNAL_3_MULTIPLIER,
-        MIXER_SIGNAL_4,
-        MIXER_SIGNAL_4_MULTIPLIER,
-        MIXER_SIGNAL_5,
-        MIXER_SIGNAL_5_MULTIPLIER
+        MIXER_SIGNAL = 0,
+        MIXER_SIGNAL_MULTIPLIER
     };
 
     // A boolean to represent whether or not auto attenuation should be used
     bool auto_attenuate;
+    // The number of channels, changed by the main thread, and the number of
+    // channels processed, changed by the audio thread via the command queue
+    // once the inputs of every channel to process exist
+    unsigned int num_channels;
+    unsigned int processed_channels;
+    // The first channel shown
+    unsigned int first_shown_channel;
+    // The live signals with constant multipliers, and those multipliers,
+    // gathered once per buffer to be mixed together
+    std::vector<const float *> constant_signals;
+    std::vector<float> constant_multipliers;
 
     // Constructor and destructor
     Mixer();
     virtual ~Mixer();
 
     // Member functions, explained in Module.hpp
-    virtual void process();
+    virtual void process(unsigned int);
+    virtual bool reads_control_rate(unsigned int);
+    virtual bool reads_input(unsigned int);
+    virtual bool can_go_dormant();
+    virtual bool output_static();
     virtual bool handle_event(Graphics_Object *);
     virtual void calculate_unique_graphics_object_locations();
     virtual void initialize_unique_graphics_objects();
     virtual std::string get_unique_text_representation();
+    virtual void set_unique_text_representation(std::vector<std::string> *);
+    virtual unsigned int saved_inputs(unsigned int);
+
+    // Member functions particular to this module
+    //   Turn auto attenuation on or off
     void toggle_auto_attenuation();
+    //   Switch to the given number of channels, rounded up to a whole number
+    //   of pages
+    void switch_num_channels(unsigned int);
+    //   Show the page of channels starting at the given channel
+    void show_channels(unsigned int);
+    //   Point the text boxes and toggle buttons at the inputs of the channels
+    //   shown
+    void attach_shown_channels();
 };
 
 #endif
@@ -8,6 +8,7 @@
  ************/
 
 // Included libraries
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <string>
@@ -21,6 +22,7 @@
 #include "graphics_object_utils.hpp"
 #include "image_processing.hpp"
 #include "main.hpp"
+#include "signal_kernels.hpp"
 #include "signal_processing.hpp"
 
 // Included modules classes
@@ -51,33 +53,104 @@ Multiplier::~Multiplier()
 {}
 
 /*
- * Process all dependencies, then multiply the original signal by 1 - the
- * control values, and multiply the original signal by the control values
- * scaled. One done, sum the two to get the final output signal for the
- * multiplier module.
+ * Multiply the original signal by 1 - the control values, and multiply the
+ * original signal by the control values scaled. One done, sum the two to get
+ * the final output signal for the multiplier module. Which inputs are live is
+ * checked once per block, so that the common cases skip fetching input values
+ * sample by sample.
  */
-void Multiplier::process()
+void Multiplier::process(unsigned int num_samples)
 {
-    // Process any dependencies
-    process_dependencies();
-
+    // With no signal, there is nothing to multiply
     if(!inputs[MULTIPLIER_SIGNAL].live)
     {
         inputs[MULTIPLIER_SIGNAL].val = 0;
+        std::fill(out, out + num_samples, 0);
     }
+    // A silent signal stays silent whatever it is multiplied by
+    else if(input_silent(MULTIPLIER_SIGNAL))
+    {
+        std::fill(out, out + num_samples, 0);
 
-    for(unsigned short i = 0; i < out.size(); i ++)
+        update_input_vals(num_samples - 1);
+    }
+    // With a constant multiplier and dry/wet amount, the signal is just
+    // scaled by a single gain for the whole block
+    else if(!inputs[MULTIPLIER_MULTIPLIER].live
+            && !inputs[MULTIPLIER_DRY_WET].live)
+    {
+        float gain = (1 - inputs[MULTIPLIER_DRY_WET].val)
+                     + (inputs[MULTIPLIER_MULTIPLIER].val
+                        * inputs[MULTIPLIER_DRY_WET].val);
+
+        multiply_samples(inputs[MULTIPLIER_SIGNAL].in, gain, out, num_samples);
+
+        update_input_vals(num_samples - 1);
+    }
+    // Otherwise, calculate every sample from the current input values
+    else
     {
-        update_input_vals(i);
+        for(unsigned int i = 0; i < num_samples; i ++)
+        {
+            update_input_vals(i);
+
+            out[i] = (inputs[MULTIPLIER_SIGNAL].val
+                      * (1 - inputs[MULTIPLIER_DRY_WET].val))
+                     + (inputs[MULTIPLIER_SIGNAL].val
+                        * inputs[MULTIPLIER_MULTIPLIER].val
+                        * inputs[MULTIPLIER_DRY_WET].val);
+        }
+    }
+}
+
+/*
+ * Every input but the signal being multiplied can read a signal calculated at
+ * control rate.
+ */
+bool Multiplier::reads_control_rate(unsigned int input_num)
+{
+    return input_num != MULTIPLIER_SIGNAL;
+}
 
-        out[i] = (inputs[MULTIPLIER_SIGNAL].val
-                     * (1 - inputs[MULTIPLIER_DRY_WET].val))
-                    + (inputs[MULTIPLIER_SIGNAL].val
-                       * inputs[MULTIPLIER_MULTIPLIER].val
-                       * inputs[MULTIPLIER_DRY_WET].val);
+/*
+ * The signal is not read if it is multiplied by a constant gain of 0, and the
+ * other inputs are not read if there is no signal. The multiplier is not read
+ * either if the dry/wet amount is constant at 0.
+ */
+bool Multiplier::reads_input(unsigned int input_num)
+{
+    switch(input_num)
+    {
+    case MULTIPLIER_SIGNAL:
+        return inputs[MULTIPLIER_MULTIPLIER].live
+               || inputs[MULTIPLIER_DRY_WET].live
+               || (1 - inputs[MULTIPLIER_DRY_WET].val)
+                  + (inputs[MULTIPLIER_MULTIPLIER].val
+                     * inputs[MULTIPLIER_DRY_WET].val) != 0;
+    case MULTIPLIER_MULTIPLIER:
+        return inputs[MULTIPLIER_SIGNAL].live
+               && (inputs[MULTIPLIER_DRY_WET].live
+                   || inputs[MULTIPLIER_DRY_WET].val != 0);
+    default:
+        return inputs[MULTIPLIER_SIGNAL].live;
     }
+}
+
+/*
+ * A multiplier keeps no state between blocks, so it can go dormant.
+ */
+bool Multiplier::can_go_dormant()
+{
+    return true;
+}
 
-    processed = true;
+/*
+ * A multiplier's output only depends on its inputs, so it is the same as long as
+ * they are.
+ */
+bool Multiplier::output_static()
+{
+    return true;
 }
 
 /*
@@ -34,7 +34,11 @@ public:
     virtual ~Multiplier();
 
     // Member functions, explained in Module.hpp
-    virtual void process();
+    virtual void process(unsigned int);
+    virtual bool reads_control_rate(unsigned int);
+    virtual bool reads_input(unsigned int);
+    virtual bool can_go_dormant();
+    virtual bool output_static();
     virtual bool handle_event(Graphics_Object *);
     virtual void calculate_unique_graphics_object_locations();
     virtual void initialize_unique_graphics_objects();
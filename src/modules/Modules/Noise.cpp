@@ -8,6 +8,7 @@
  ************/
 
 // Included libraries
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <string>
@@ -21,24 +22,50 @@
 #include "graphics_object_utils.hpp"
 #include "image_processing.hpp"
 #include "main.hpp"
+#include "signal_kernels.hpp"
 #include "signal_processing.hpp"
 
 // Included modules classes
 #include "Module.hpp"
 #include "Modules/Noise.hpp"
 
+/*************
+ * CONSTANTS *
+ *************/
+
+// Pink noise is the sum of white noise through six one pole filters, a sample
+// of delay, and no filter at all, with these poles and gains, from Paul
+// Kellet's refined method. Pink and brown noise are then scaled to keep
+// almost every sample from -1 to 1.
+static const float PINK_POLES[Noise::PINK_FILTERS - 1] =
+    {.99886, .99332, .96900, .86650, .55000, -.7616};
+static const float PINK_GAINS[Noise::PINK_FILTERS + 1] =
+    {.0555179, .0750759, .1538520, .3104856, .5329522, -.0168980, .115926,
+     .5362};
+static const float PINK_SCALE = .11;
+static const float BROWN_LEAK = 1.02;
+static const float BROWN_SCALE = 3.5;
+
 /**************************
  * NOISE MEMBER FUNCTIONS *
  **************************/
 
 /*
- * Constructor.
+ * Constructor. Every noise module is seeded differently, in the order they
+ * are created.
  */
 Noise::Noise() :
-    Module(NOISE)
+    Module(NOISE),
+    generator_state(NOISE_STATE_SIZE), brown_state(0), noise_type(WHITE),
+    white_on(true), pink_on(false), brown_on(false)
 {
+    static uint64_t seed = 0;
+
     inputs[NOISE_RANGE_LOW].val = -1;
     inputs[NOISE_RANGE_HIGH].val = 1;
+
+    seed_noise(generator_state.data(), seed ++);
+    std::fill(pink_state, pink_state + PINK_FILTERS, 0);
 }
 
 /*
@@ -48,31 +75,105 @@ Noise::~Noise()
 {}
 
 /*
- * Produce a random number in the range [-1, 1].
+ * Filter the white noise in the output buffer into pink noise, which has
+ * equal power in every octave.
  */
-double Noise::produce_white_noise_sample()
+void Noise::filter_pink_noise(unsigned int num_samples)
 {
-    return scale_sample(((float) rand() / RAND_MAX) * 2, 0, 2, -1, 1);
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        float white = out[i];
+        float pink = PINK_GAINS[PINK_FILTERS] * white
+                     + pink_state[PINK_FILTERS - 1];
+
+        for(unsigned int j = 0; j < PINK_FILTERS - 1; j ++)
+        {
+            pink_state[j] = PINK_POLES[j] * pink_state[j]
+                            + PINK_GAINS[j] * white;
+            pink += pink_state[j];
+        }
+        pink_state[PINK_FILTERS - 1] = PINK_GAINS[PINK_FILTERS - 1] * white;
+
+        out[i] = pink * PINK_SCALE;
+    }
+
+    clip_samples(out, num_samples, -1, 1);
+}
+
+/*
+ * Filter the white noise in the output buffer into brown noise, which loses
+ * 6 dB of power every octave. The integrator leaks a little every sample so
+ * that it never wanders off.
+ */
+void Noise::filter_brown_noise(unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        brown_state = (brown_state + .02f * out[i]) / BROWN_LEAK;
+        out[i] = brown_state * BROWN_SCALE;
+    }
+
+    clip_samples(out, num_samples, -1, 1);
 }
 
 /*
  * Fill the output buffer with samples depending on the type
- * of noise selected.
+ * of noise selected. If neither end of the range is live, the range is
+ * constant for the whole block, so white noise is generated straight into it,
+ * and other noise is scaled into it all at once.
  */
-void Noise::process()
+void Noise::process(unsigned int num_samples)
 {
-    process_dependencies();
+    bool range_live = inputs[NOISE_RANGE_LOW].live
+                      || inputs[NOISE_RANGE_HIGH].live;
 
-    for(unsigned short i = 0; i < out.size(); i ++)
+    if(noise_type == WHITE && !range_live)
+    {
+        noise_samples(generator_state.data(), inputs[NOISE_RANGE_LOW].val,
+                      inputs[NOISE_RANGE_HIGH].val, out, num_samples);
+        return;
+    }
+
+    noise_samples(generator_state.data(), -1, 1, out, num_samples);
+    if(noise_type == PINK)
+    {
+        filter_pink_noise(num_samples);
+    }
+    else if(noise_type == BROWN)
+    {
+        filter_brown_noise(num_samples);
+    }
+
+    if(!range_live)
+    {
+        scale_samples(out, num_samples, -1, 1, inputs[NOISE_RANGE_LOW].val,
+                      inputs[NOISE_RANGE_HIGH].val);
+        return;
+    }
+
+    for(unsigned int i = 0; i < num_samples; i ++)
     {
         update_input_vals(i);
 
-        out[i] = produce_white_noise_sample();
         out[i] = scale_sample(out[i], -1, 1, inputs[NOISE_RANGE_LOW].val,
-                                 inputs[NOISE_RANGE_HIGH].val);
+                              inputs[NOISE_RANGE_HIGH].val);
     }
+}
 
-    processed = true;
+/*
+ * Both range inputs can read a signal calculated at control rate.
+ */
+bool Noise::reads_control_rate(unsigned int input_num)
+{
+    return true;
+}
+
+/*
+ * Noise sounds the same whenever it resumes, so a noise module can go dormant.
+ */
+bool Noise::can_go_dormant()
+{
+    return true;
 }
 
 /*
@@ -88,6 +189,22 @@ bool Noise::handle_event(Graphics_Object *g)
     {
         return false;
     }
+    // Handle noise type toggle buttons
+    else if(g == graphics_objects["white toggle button"])
+    {
+        switch_noise_type(WHITE);
+        return true;
+    }
+    else if(g == graphics_objects["pink toggle button"])
+    {
+        switch_noise_type(PINK);
+        return true;
+    }
+    else if(g == graphics_objects["brown toggle button"])
+    {
+        switch_noise_type(BROWN);
+        return true;
+    }
     // If none of the above, handle events that apply to all modules, return
     // true if an event is handled
     else if(Module::handle_event(g))
@@ -108,11 +225,11 @@ void Noise::calculate_unique_graphics_object_locations()
     SDL_Rect location;
 
     // Waveform viewer location
-    location = {upper_left.x, upper_left.y + 15, MODULE_WIDTH, 74};
+    location = {upper_left.x, upper_left.y + 15, MODULE_WIDTH, 54};
     graphics_object_locations["waveform"] = location;
 
     // Range low related graphics object locations
-    location = {upper_left.x + 2, location.y + 77, 0, 0};
+    location = {upper_left.x + 2, location.y + 57, 0, 0};
     graphics_object_locations["range low text"] = location;
     location = {upper_left.x, location.y + 10, MODULE_WIDTH - 8, 9};
     graphics_object_locations["range low text box"] = location;
@@ -126,6 +243,17 @@ void Noise::calculate_unique_graphics_object_locations()
     graphics_object_locations["range high text box"] = location;
     location = {location.x + location.w + 1, location.y, 7, 9};
     graphics_object_locations["range high toggle button"] = location;
+
+    // Noise type related graphics object locations
+    location = {upper_left.x + 2, location.y + 10, 0, 0};
+    graphics_object_locations["noise type text"] = location;
+    location = {upper_left.x, location.y + 10, (MODULE_WIDTH / 3) - 1, 9};
+    graphics_object_locations["white toggle button"] = location;
+    location = {location.x + location.w + 1, location.y, location.w, 9};
+    graphics_object_locations["pink toggle button"] = location;
+    location = {location.x + location.w + 1, location.y,
+                upper_left.x + MODULE_WIDTH - location.x - location.w - 1, 9};
+    graphics_object_locations["brown toggle button"] = location;
 }
 
 /*
@@ -136,13 +264,17 @@ void Noise::initialize_unique_graphics_objects()
 {
     // Initialize text objects
     graphics_objects["range low text"] =
-        new Text(name + " ranges text",
-                 graphics_object_locations["ranges text"],
+        new Text(name + " range low text",
+                 graphics_object_locations["range low text"],
                  secondary_module_color, "RANGE LOW (#):");
     graphics_objects["range high text"] =
         new Text(name + " range high text",
                  graphics_object_locations["range high text"],
                  secondary_module_color, "RANGE HIGH (#):");
+    graphics_objects["noise type text"] =
+        new Text(name + " noise type text",
+                 graphics_object_locations["noise type text"],
+                 secondary_module_color, "NOISE TYPE:");
 
     // Initialize waveform viewer
     graphics_objects["waveform"] =
@@ -186,10 +318,69 @@ void Noise::initialize_unique_graphics_objects()
     toggle_button_to_input_num[(Toggle_Button *) graphics_objects["range high toggle button"]] = NOISE_RANGE_HIGH;
     inputs[NOISE_RANGE_HIGH].text_box = (Text_Box *) graphics_objects["range high text box"];
     inputs[NOISE_RANGE_HIGH].toggle_button = (Toggle_Button *) graphics_objects["range high toggle button"];
+
+    // Initialize noise type toggle buttons
+    graphics_objects["white toggle button"] =
+        new Toggle_Button(name + " white toggle button",
+                          graphics_object_locations["white toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "WHITE", "WHITE", white_on,
+                          (Graphics_Listener *) this);
+    graphics_objects["pink toggle button"] =
+        new Toggle_Button(name + " pink toggle button",
+                          graphics_object_locations["pink toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "PINK", "PINK", pink_on, (Graphics_Listener *) this);
+    graphics_objects["brown toggle button"] =
+        new Toggle_Button(name + " brown toggle button",
+                          graphics_object_locations["brown toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "BROWN", "BROWN", brown_on,
+                          (Graphics_Listener *) this);
+}
+
+/*
+ * Switch to outputting the given noise type, and update the noise type toggle
+ * buttons to match if there are any.
+ */
+void Noise::switch_noise_type(NoiseType noise_type_)
+{
+    white_on = noise_type_ == WHITE;
+    pink_on = noise_type_ == PINK;
+    brown_on = noise_type_ == BROWN;
+    noise_type = noise_type_;
+
+    std::cout << name << " is now outputting "
+              << (white_on ? "white" : pink_on ? "pink" : "brown")
+              << " noise" << std::endl;
+
+    if(graphics_objects_initialized)
+    {
+        ((Toggle_Button *) graphics_objects["white toggle button"])->b =
+            white_on;
+        ((Toggle_Button *) graphics_objects["pink toggle button"])->b =
+            pink_on;
+        ((Toggle_Button *) graphics_objects["brown toggle button"])->b =
+            brown_on;
+    }
 }
 
 std::string Noise::get_unique_text_representation()
 {
-    return "";
+    return std::to_string(noise_type) + "\n";
+}
+
+/*
+ * Restore the noise type.
+ */
+void Noise::set_unique_text_representation(std::vector<std::string> *lines)
+{
+    if(lines->size() >= 1)
+    {
+        switch_noise_type((NoiseType) stoi((*lines)[0]));
+    }
 }
 
@@ -1,7 +1,9 @@
 /*
  * Matthew Diamond 2015
  * The noise module. This module is capable of generating different types of
- * noise.
+ * noise. White noise comes from random number generators that belong to the
+ * module, pink noise is white noise through a set of one pole filters, and
+ * brown noise is white noise through a leaky integrator.
  */
 
 #ifndef MSS_NOISE_HPP
@@ -20,6 +22,14 @@
 class Noise: public Module
 {
 public:
+    // Noise type enum
+    enum NoiseType
+    {
+        WHITE = 0,
+        PINK,
+        BROWN
+    };
+
     // Noise dependencies enum
     enum NoiseDependencies
     {
@@ -27,22 +37,38 @@ public:
         NOISE_RANGE_HIGH
     };
 
+    // The number of filters that make pink noise out of white noise
+    static const unsigned int PINK_FILTERS = 7;
+
+    // The state of this module's random number generators
+    std::vector<Uint32> generator_state;
+    // The state of the pink noise filters and of the brown noise integrator
+    float pink_state[PINK_FILTERS];
+    float brown_state;
+    NoiseType noise_type;
+    bool white_on, pink_on, brown_on;
+
     // Constructor and destructor
     Noise();
     virtual ~Noise();
 
     // Member functions, explained in Module.hpp
-    virtual void process();
+    virtual void process(unsigned int);
+    virtual bool reads_control_rate(unsigned int);
+    virtual bool can_go_dormant();
     virtual bool handle_event(Graphics_Object *);
     virtual void calculate_unique_graphics_object_locations();
     virtual void initialize_unique_graphics_objects();
     virtual std::string get_unique_text_representation();
+    virtual void set_unique_text_representation(std::vector<std::string> *);
 
     // Member functions particular to this module
-    //   Produce samples for the various types of waveforms given a phase
-    double produce_white_noise_sample();
-    //   Switch to outputting the given waveform type
-    void switch_noise_type(int);
+    //   Filter white noise from -1 to 1 in the output buffer in place into
+    //   pink or brown noise
+    void filter_pink_noise(unsigned int);
+    void filter_brown_noise(unsigned int);
+    //   Switch to outputting the given noise type
+    void switch_noise_type(NoiseType);
 };
 
 #endif
@@ -8,6 +8,7 @@
  ************/
 
 // Included libraries
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <string>
@@ -21,12 +22,21 @@
 #include "graphics_object_utils.hpp"
 #include "image_processing.hpp"
 #include "main.hpp"
+#include "populate_wavetables.hpp"
+#include "signal_kernels.hpp"
 #include "signal_processing.hpp"
 
 // Included modules classes
 #include "Module.hpp"
 #include "Modules/Oscillator.hpp"
 
+/*************
+ * CONSTANTS *
+ *************/
+
+// The number of fixed point phase steps in one period
+static const double FIXED_PHASE_PERIOD = 4294967296.0;
+
 /*******************************
  * OSCILLATOR MEMBER FUNCTIONS *
  *******************************/
@@ -36,7 +46,8 @@
  */
 Oscillator::Oscillator() :
     Module(OSCILLATOR),
-    phase(0), previous_phase_offset(0),
+    phase(0), previous_phase_offset(0), phase_buffer(BUFFER_SIZE, 0),
+    last_sample(NAN),
     waveform_type(SIN), sin_on(true), tri_on(false),
     saw_on(false), sqr_on(false)
 {
@@ -114,17 +125,255 @@ double Oscillator::produce_sqr_sample(double phase)
 }
 
 /*
- * Process all dependencies, then fill the output buffer with a waveform given
- * the data contained within this class and the audio device information.
+ * Given a phase from 0 to 1, calculate and return a sample of the current
+ * waveform type, scaled to the current range.
+ */
+float Oscillator::produce_control_point(double phase)
+{
+    double sample = 0;
+
+    switch(waveform_type)
+    {
+    case SIN :
+        sample = produce_sin_sample(phase);
+        break;
+    case TRI :
+        sample = produce_tri_sample(phase);
+        break;
+    case SAW:
+        sample = produce_saw_sample(phase);
+        break;
+    case SQR:
+        sample = produce_sqr_sample(phase);
+        break;
+    }
+
+    if(inputs[OSCILLATOR_RANGE_LOW].val != -1
+       || inputs[OSCILLATOR_RANGE_HIGH].val != 1)
+        sample = scale_sample(sample, -1, 1,
+                              inputs[OSCILLATOR_RANGE_LOW].val,
+                              inputs[OSCILLATOR_RANGE_HIGH].val);
+
+    return sample;
+}
+
+/*
+ * Given a phase from 0 to 1, or any other number, which wraps around to that
+ * range, return the same phase in fixed point.
  */
-void Oscillator::process()
+Uint32 Oscillator::to_fixed_phase(double phase)
 {
-    // Process any dependencies
-    process_dependencies();
+    // The cast to 64 bits and then 32 wraps a phase of exactly 1 around to 0
+    return (Uint32) (Uint64) ((phase - floor(phase)) * FIXED_PHASE_PERIOD);
+}
 
+/*
+ * Given a fixed point phase, return the same phase from 0 to 1.
+ */
+double Oscillator::from_fixed_phase(Uint32 phase)
+{
+    return phase / FIXED_PHASE_PERIOD;
+}
+
+/*
+ * Given a wavetable and a fixed point phase, interpolate between the two
+ * nearest entries in the wavetable and return the result. The top bits of the
+ * phase index the wavetable, and the rest are how far it is to the next entry.
+ */
+float Oscillator::read_wavetable(const float *wavetable, Uint32 phase)
+{
+    const unsigned int fraction_bits = 32 - WAVETABLE_BITS;
+    Uint32 index = phase >> fraction_bits;
+    float fraction = (phase & ((1 << fraction_bits) - 1))
+                     * (1.0f / (1 << fraction_bits));
+
+    return wavetable[index]
+           + fraction * (wavetable[index + 1] - wavetable[index]);
+}
+
+/*
+ * Given a saw wave wavetable and a fixed point phase, calculate and return a
+ * band-limited pulse wave sample. A saw wave minus the same saw wave delayed
+ * by the pulse width is a pulse wave, offset by the pulse width.
+ */
+float Oscillator::read_sqr_wavetable(const float *wavetable, Uint32 phase)
+{
+    float pulse_width = inputs[OSCILLATOR_PULSE_WIDTH].val;
+
+    if(pulse_width < 0)
+    {
+        pulse_width = 0;
+    }
+    else if(pulse_width > 1)
+    {
+        pulse_width = 1;
+    }
+
+    return read_wavetable(wavetable, phase - to_fixed_phase(pulse_width))
+           - read_wavetable(wavetable, phase)
+           + 2 * pulse_width - 1;
+}
+
+/*
+ * Given the highest frequency in a block, return the wavetable that the block
+ * should be read from.
+ */
+const float *Oscillator::select_wavetable(double frequency)
+{
+    return find_wavetable(waveform_type == SQR ? SAW : waveform_type,
+                          frequency);
+}
+
+/*
+ * Given the number of samples in a block, return the highest frequency in it.
+ */
+float Oscillator::find_highest_frequency(unsigned int num_samples)
+{
+    float highest_frequency = fabs(inputs[OSCILLATOR_FREQUENCY].val);
+
+    if(inputs[OSCILLATOR_FREQUENCY].live)
+    {
+        for(unsigned short i = 0; i < num_samples; i ++)
+        {
+            if(fabs(inputs[OSCILLATOR_FREQUENCY].in[i]) > highest_frequency)
+            {
+                highest_frequency = fabs(inputs[OSCILLATOR_FREQUENCY].in[i]);
+            }
+        }
+    }
+
+    return highest_frequency;
+}
+
+/*
+ * Return whether or not the given number of samples are calculated at control
+ * rate, which they are if this oscillator may be, and it stays below the
+ * lowest wavetable frequency with a waveform that has no jumps for the
+ * interpolation to smear, a sine or a triangle.
+ */
+bool Oscillator::at_control_rate(unsigned int num_samples)
+{
+    return rate == CONTROL_RATE
+           && (waveform_type == SIN || waveform_type == TRI)
+           && find_highest_frequency(num_samples) < WAVETABLE_MIN_FREQUENCY;
+}
+
+/*
+ * Fill the output buffer with a waveform given the data contained within this
+ * class and the audio device information. If this oscillator is calculated at
+ * control rate for the whole block, only a point every control period is
+ * calculated.
+ * Otherwise, if none of the inputs are live, the parameters are constant for
+ * the whole block, so the block is filled without fetching them sample by
+ * sample.
+ */
+void Oscillator::process(unsigned int num_samples)
+{
     double phase_offset_diff;
+    bool live = false;
+
+    for(unsigned int j = 0; j < inputs.size(); j ++)
+    {
+        live = live || inputs[j].live;
+    }
+
+    if(at_control_rate(num_samples))
+    {
+        process_control(num_samples);
+    }
+    else if(live)
+    {
+        process_live(num_samples);
+    }
+    else
+    {
+        // The phase offset can only have changed since the last block
+        phase_offset_diff = inputs[OSCILLATOR_PHASE_OFFSET].val
+                            - previous_phase_offset;
+        previous_phase_offset = inputs[OSCILLATOR_PHASE_OFFSET].val;
+
+        process_constant(num_samples, phase_offset_diff);
+    }
+
+    last_sample = out[num_samples - 1];
+}
+
+/*
+ * Fill the output buffer given constant parameters, with the difference in
+ * phase offset since the last block applied to the first sample only. The
+ * phase wraps around on its own as it overflows.
+ */
+void Oscillator::process_constant(unsigned int num_samples,
+                                  double phase_offset_diff)
+{
+    Uint32 phase_increment =
+        to_fixed_phase((double) inputs[OSCILLATOR_FREQUENCY].val
+                       / SAMPLE_RATE);
+    Uint32 phase_offset = to_fixed_phase(phase_offset_diff);
+    bool use_wavetable = fabs(inputs[OSCILLATOR_FREQUENCY].val)
+                         >= WAVETABLE_MIN_FREQUENCY;
+    const float *wavetable =
+        select_wavetable(inputs[OSCILLATOR_FREQUENCY].val);
+
+    if(use_wavetable && waveform_type != SQR)
+    {
+        for(unsigned short i = 0; i < num_samples; i ++)
+        {
+            out[i] = read_wavetable(wavetable, phase);
+            phase += phase_increment + phase_offset;
+            phase_offset = 0;
+        }
+    }
+    else if(use_wavetable)
+    {
+        for(unsigned short i = 0; i < num_samples; i ++)
+        {
+            out[i] = read_sqr_wavetable(wavetable, phase);
+            phase += phase_increment + phase_offset;
+            phase_offset = 0;
+        }
+    }
+    else
+    {
+        for(unsigned short i = 0; i < num_samples; i ++)
+        {
+            phase_buffer[i] = phase;
+            phase += phase_increment + phase_offset;
+            phase_offset = 0;
+        }
+        produce_samples(num_samples);
+    }
+
+    // If the oscillator has an abnormal range, scale the block to that range
+    if(inputs[OSCILLATOR_RANGE_LOW].val != -1
+       || inputs[OSCILLATOR_RANGE_HIGH].val != 1)
+        scale_samples(out, num_samples, -1, 1,
+                      inputs[OSCILLATOR_RANGE_LOW].val,
+                      inputs[OSCILLATOR_RANGE_HIGH].val);
+}
+
+/*
+ * Fill the output buffer given at least one live parameter, fetching every
+ * parameter sample by sample. If the frequency stays below the lowest
+ * wavetable frequency for the whole block, the phase of every sample is
+ * worked out first, and the whole block is generated from them at once.
+ * Otherwise every sample is read from the wavetable for the highest frequency
+ * in the block, even those below the lowest wavetable frequency, so that no
+ * sample is calculated from scratch.
+ */
+void Oscillator::process_live(unsigned int num_samples)
+{
+    double phase_offset_diff;
+    float highest_frequency = find_highest_frequency(num_samples);
+    bool use_wavetable;
+    const float *wavetable;
+
+    // Read the whole block from the wavetable for its highest frequency
+    use_wavetable = highest_frequency >= WAVETABLE_MIN_FREQUENCY;
+    wavetable = select_wavetable(highest_frequency);
+
     // Calculate an amplitude for each sample
-    for(unsigned short i = 0; i < out.size(); i ++)
+    for(unsigned short i = 0; i < num_samples; i ++)
     {
         update_input_vals(i);
 
@@ -133,58 +382,240 @@ void Oscillator::process()
         previous_phase_offset = inputs[OSCILLATOR_PHASE_OFFSET].val;
 
         // Calculate and store the current samples amplitude
-        // based on phase
-        if(inputs[OSCILLATOR_FREQUENCY].val < 1
-           && inputs[OSCILLATOR_FREQUENCY].val > -1)
+        // based on phase, or just store the phase if the whole block is
+        // generated afterwards
+        if(!use_wavetable)
         {
-            switch(waveform_type)
-            {
-            case SIN :
-                out[i] = produce_sin_sample(phase);
-                break;
-            case TRI :
-                out[i] = produce_tri_sample(phase);
-                break;
-            case SAW:
-                out[i] = produce_saw_sample(phase);
-                break;
-            case SQR:
-                out[i] = produce_sqr_sample(phase);
-                break;
-            }
+            phase_buffer[i] = phase;
+        }
+        else if(waveform_type == SQR)
+        {
+            out[i] = read_sqr_wavetable(wavetable, phase);
         }
-        else if(waveform_type != SQR || inputs[OSCILLATOR_PULSE_WIDTH].val == .5)
-            out[i] = WAVETABLES[waveform_type][(int)(phase
-                                                        * SAMPLE_RATE)];
         else
         {
-            out[i] = produce_sqr_sample(phase);
+            out[i] = read_wavetable(wavetable, phase);
         }
 
-        // If the oscillator has an abnormal range, scale the sample to
-        // that range
-        if(inputs[OSCILLATOR_RANGE_LOW].val != -1
-           || inputs[OSCILLATOR_RANGE_HIGH].val != 1)
+        // Increment the current phase according to the frequency, sample rate,
+        // and difference in phase offset since the last sample was
+        // calculated, it wraps around on its own as it overflows
+        phase += to_fixed_phase(((double) inputs[OSCILLATOR_FREQUENCY].val
+                                 / SAMPLE_RATE) + phase_offset_diff);
+    }
+
+    if(!use_wavetable)
+    {
+        produce_samples(num_samples);
+    }
+
+    // If the oscillator has an abnormal range, scale each sample to that
+    // range
+    if(inputs[OSCILLATOR_RANGE_LOW].live || inputs[OSCILLATOR_RANGE_HIGH].live)
+    {
+        for(unsigned short i = 0; i < num_samples; i ++)
+        {
             out[i] = scale_sample(out[i], -1, 1,
-                                     inputs[OSCILLATOR_RANGE_LOW].val,
-                                     inputs[OSCILLATOR_RANGE_HIGH].val);
+                                  inputs[OSCILLATOR_RANGE_LOW].live
+                                  ? inputs[OSCILLATOR_RANGE_LOW].in[i]
+                                  : inputs[OSCILLATOR_RANGE_LOW].val,
+                                  inputs[OSCILLATOR_RANGE_HIGH].live
+                                  ? inputs[OSCILLATOR_RANGE_HIGH].in[i]
+                                  : inputs[OSCILLATOR_RANGE_HIGH].val);
+        }
+    }
+    else if(inputs[OSCILLATOR_RANGE_LOW].val != -1
+            || inputs[OSCILLATOR_RANGE_HIGH].val != 1)
+        scale_samples(out, num_samples, -1, 1,
+                      inputs[OSCILLATOR_RANGE_LOW].val,
+                      inputs[OSCILLATOR_RANGE_HIGH].val);
+}
 
-        // Increment the current phase according to the frequency, sample rate,
-        // and difference in phase offset since the last sample was calculated
-        phase += ((double) inputs[OSCILLATOR_FREQUENCY].val
-                          / SAMPLE_RATE) + phase_offset_diff;
-        // Wrap around if the phase goes above 1 or below 0
-        while(phase > 1)
+/*
+ * Fill the output buffer at control rate. The parameters are read at the last
+ * sample of each control period, and the phase moves on by the whole period
+ * at once, so that a point is only calculated for that last sample. The
+ * phase moves exactly as it would sample by sample while the parameters are
+ * constant. Then the samples in between the points are interpolated.
+ */
+void Oscillator::process_control(unsigned int num_samples)
+{
+    unsigned int num_points = (num_samples + CONTROL_PERIOD - 1)
+                              / CONTROL_PERIOD;
+
+    // Before the first block, there is no previous sample to interpolate
+    // from, so start from where it would have been, a sample before the
+    // current phase
+    if(std::isnan(last_sample))
+    {
+        last_sample = produce_control_point(
+            from_fixed_phase(phase
+                             - to_fixed_phase((double)
+                                              inputs[OSCILLATOR_FREQUENCY].val
+                                              / SAMPLE_RATE)));
+    }
+
+    for(unsigned int i = 0; i < num_points; i ++)
+    {
+        unsigned int length = std::min(num_samples - i * CONTROL_PERIOD,
+                                       CONTROL_PERIOD);
+        Uint32 phase_increment;
+        double point_phase;
+
+        update_input_vals(i * CONTROL_PERIOD + length - 1);
+
+        // The difference in phase offset applies from the first sample of the
+        // period, which the point always comes after
+        phase_increment = to_fixed_phase((double)
+                                         inputs[OSCILLATOR_FREQUENCY].val
+                                         / SAMPLE_RATE);
+        phase += to_fixed_phase(inputs[OSCILLATOR_PHASE_OFFSET].val
+                                - previous_phase_offset);
+        previous_phase_offset = inputs[OSCILLATOR_PHASE_OFFSET].val;
+        point_phase = from_fixed_phase(phase + phase_increment * (length - 1));
+        phase += phase_increment * length;
+
+        out[i] = produce_control_point(point_phase);
+    }
+
+    interpolate_control_points(last_sample, num_samples);
+}
+
+/*
+ * Generate the given number of samples of the current waveform type at once,
+ * from the phases in the phase buffer, using the pulse width input sample by
+ * sample if it is live.
+ */
+void Oscillator::produce_samples(unsigned int num_samples)
+{
+    switch(waveform_type)
+    {
+    case SIN :
+        sin_samples(&phase_buffer[0], out, num_samples);
+        break;
+    case TRI :
+        tri_samples(&phase_buffer[0], out, num_samples);
+        break;
+    case SAW:
+        saw_samples(&phase_buffer[0], out, num_samples);
+        break;
+    case SQR:
+        if(inputs[OSCILLATOR_PULSE_WIDTH].live)
+        {
+            sqr_samples(&phase_buffer[0], inputs[OSCILLATOR_PULSE_WIDTH].in,
+                        out, num_samples);
+        }
+        else
+        {
+            sqr_samples(&phase_buffer[0], inputs[OSCILLATOR_PULSE_WIDTH].val,
+                        out, num_samples);
+        }
+        break;
+    }
+}
+
+/*
+ * Every input can read a signal calculated at control rate, an oscillator
+ * modulated fast enough for that to matter is not calculated at control rate
+ * in the first place.
+ */
+bool Oscillator::reads_control_rate(unsigned int input_num)
+{
+    return true;
+}
+
+/*
+ * An oscillator keeps its phase moving while it is dormant, so that it is in
+ * the same place when it wakes up as if it had been processed all along. It
+ * can only do that if its frequency and phase offset do not come from other
+ * modules, which may be dormant as well, so only then can it go dormant.
+ */
+bool Oscillator::can_go_dormant()
+{
+    return inputs[OSCILLATOR_FREQUENCY].from == nullptr
+           && inputs[OSCILLATOR_PHASE_OFFSET].from == nullptr;
+}
+
+/*
+ * Move the phase on by the given number of samples exactly as process() would,
+ * without calculating any samples. The last sample, which a block calculated
+ * at control rate interpolates from, is taken as the point at the phase of the
+ * last sample skipped, which is exact at control rate and within the
+ * band-limiting of the wavetables otherwise.
+ */
+void Oscillator::skip(unsigned int num_samples)
+{
+    Uint32 last_phase = phase;
+    bool live = false;
+
+    for(unsigned int j = 0; j < inputs.size(); j ++)
+    {
+        live = live || inputs[j].live;
+    }
+
+    if(at_control_rate(num_samples))
+    {
+        for(unsigned int i = 0; i < num_samples; i += CONTROL_PERIOD)
         {
-            phase -= 1;
+            unsigned int length = std::min(num_samples - i, CONTROL_PERIOD);
+            Uint32 phase_increment;
+
+            update_input_vals(i + length - 1);
+
+            phase_increment = to_fixed_phase((double)
+                                             inputs[OSCILLATOR_FREQUENCY].val
+                                             / SAMPLE_RATE);
+            phase += to_fixed_phase(inputs[OSCILLATOR_PHASE_OFFSET].val
+                                    - previous_phase_offset);
+            previous_phase_offset = inputs[OSCILLATOR_PHASE_OFFSET].val;
+            last_phase = phase + phase_increment * (length - 1);
+            phase += phase_increment * length;
         }
-        while(phase < 0)
+    }
+    else if(live)
+    {
+        for(unsigned int i = 0; i < num_samples; i ++)
         {
-            phase += 1;
+            double phase_offset_diff;
+
+            update_input_vals(i);
+
+            phase_offset_diff = inputs[OSCILLATOR_PHASE_OFFSET].val
+                                - previous_phase_offset;
+            previous_phase_offset = inputs[OSCILLATOR_PHASE_OFFSET].val;
+
+            last_phase = phase;
+            phase += to_fixed_phase(((double) inputs[OSCILLATOR_FREQUENCY].val
+                                     / SAMPLE_RATE) + phase_offset_diff);
         }
     }
+    else
+    {
+        Uint32 phase_increment =
+            to_fixed_phase((double) inputs[OSCILLATOR_FREQUENCY].val
+                           / SAMPLE_RATE);
 
-    processed = true;
+        phase += to_fixed_phase(inputs[OSCILLATOR_PHASE_OFFSET].val
+                                - previous_phase_offset);
+        previous_phase_offset = inputs[OSCILLATOR_PHASE_OFFSET].val;
+        last_phase = phase + phase_increment * (num_samples - 1);
+        phase += phase_increment * num_samples;
+    }
+
+    last_sample = produce_control_point(from_fixed_phase(last_phase));
+}
+
+/*
+ * An oscillator at 0 Hz, such as one used as a DC offset, has a phase that
+ * stays put, so once it has settled on a single value for a whole block, with
+ * a phase offset that is not moving, it gives that value again every block.
+ */
+bool Oscillator::output_static()
+{
+    return find_highest_frequency(BUFFER_SIZE) == 0
+           && (!inputs[OSCILLATOR_PHASE_OFFSET].live
+               || inputs[OSCILLATOR_PHASE_OFFSET].constant)
+           && is_constant(out, BUFFER_SIZE);
 }
 
 /*
@@ -448,7 +879,8 @@ void Oscillator::initialize_unique_graphics_objects()
 }
 
 /*
- * Switch to outputting the given waveform type.
+ * Switch to outputting the given waveform type, and update the waveform
+ * toggle buttons to match if there are any.
  */
 void Oscillator::switch_waveform(WaveformType waveform_type_)
 {
@@ -456,48 +888,41 @@ void Oscillator::switch_waveform(WaveformType waveform_type_)
     tri_on = false;
     saw_on = false;
     sqr_on = false;
-    ((Toggle_Button *) graphics_objects["sin toggle button"])->b =
-        false;
-    ((Toggle_Button *) graphics_objects["tri toggle button"])->b =
-        false;
-    ((Toggle_Button *) graphics_objects["saw toggle button"])->b =
-        false;
-    ((Toggle_Button *) graphics_objects["sqr toggle button"])->b =
-        false;
 
     switch(waveform_type_)
     {
     case SIN:
         waveform_type = SIN;
         sin_on = true;
-        ((Toggle_Button *) graphics_objects["sin toggle button"])->b =
-            true;
         std::cout << name << " is now outputting a sine wave" << std::endl;
         break;
     case TRI:
         waveform_type = TRI;
         tri_on = true;
-        ((Toggle_Button *) graphics_objects["tri toggle button"])->b =
-            true;
         std::cout << name << " is now outputting a triangle wave" << std::endl;
         break;
     case SAW:
         waveform_type = SAW;
         saw_on = true;
-        ((Toggle_Button *) graphics_objects["saw toggle button"])->b =
-            true;
         std::cout << name << " is now outputting a sawtooth wave" << std::endl;
         break;
     case SQR:
         waveform_type = SQR;
         sqr_on = true;
-        ((Toggle_Button *) graphics_objects["sqr toggle button"])->b =
-            true;
         std::cout << name << " is now outputting a square wave" << std::endl;
         break;
     }
 
     waveform_type = waveform_type_;
+    changed = true;
+
+    if(graphics_objects_initialized)
+    {
+        ((Toggle_Button *) graphics_objects["sin toggle button"])->b = sin_on;
+        ((Toggle_Button *) graphics_objects["tri toggle button"])->b = tri_on;
+        ((Toggle_Button *) graphics_objects["saw toggle button"])->b = saw_on;
+        ((Toggle_Button *) graphics_objects["sqr toggle button"])->b = sqr_on;
+    }
 }
 
 /*
@@ -505,14 +930,28 @@ void Oscillator::switch_waveform(WaveformType waveform_type_)
  */
 void Oscillator::reset_phase()
 {
-    phase = inputs[OSCILLATOR_PHASE_OFFSET].val;
+    phase = to_fixed_phase(inputs[OSCILLATOR_PHASE_OFFSET].val);
+    changed = true;
 
     std::cout << name << " phase reset" << std::endl;
 }
 
 std::string Oscillator::get_unique_text_representation()
 {
-    return std::to_string(phase) + "\n"
+    return std::to_string(from_fixed_phase(phase)) + "\n"
            + std::to_string(waveform_type) + "\n";
 }
 
+/*
+ * Restore this oscillator's phase and waveform type.
+ */
+void Oscillator::set_unique_text_representation(std::vector<std::string> *lines)
+{
+    if(lines->size() >= 2)
+    {
+        phase = to_fixed_phase(stod((*lines)[0]));
+        changed = true;
+        switch_waveform((WaveformType) stoi((*lines)[1]));
+    }
+}
+
@@ -4,7 +4,12 @@
  * triangle, and sawtooth wave given a frequency and pulse width. It can then
  * be modulated with some other oscillator. The resulting waveform can then
  * be processed or output. This module fills its output buffer with the
- * generated signal. This file defines the class.
+ * generated signal. Above 40 Hz, waveforms are read from band-limited
+ * wavetables, one for each octave, so that they do not alias. Below that,
+ * they are calculated exactly, so that a square wave used as a gate is always
+ * exactly 1 or -1. Below that frequency, a sine or triangle oscillator that
+ * only modulates other modules is calculated at control rate. This file
+ * defines the class.
  */
 
 #ifndef MSS_OSCILLATOR_HPP
@@ -42,10 +47,18 @@ public:
         OSCILLATOR_RANGE_HIGH
     };
 
-    // The current phase of the oscillator
-    double phase;
+    // The current phase of the oscillator in fixed point, where the whole
+    // range of the integer is one period, so that it wraps around on its own
+    // as it overflows
+    Uint32 phase;
     // A record of the previous phase offset value
     double previous_phase_offset;
+    // The phase of every sample in the block, for generating a whole block
+    // at once
+    std::vector<Uint32> phase_buffer;
+    // The last sample of the previous block, which the next block starts
+    // from when it is calculated at control rate, NaN before the first block
+    float last_sample;
     // Booleans to represent whether or not each of the waveforms is enabled
     WaveformType waveform_type;
     // Whether or not each waveform is in use
@@ -56,11 +69,16 @@ public:
     virtual ~Oscillator();
 
     // Member functions, explained in Module.hpp
-    virtual void process();
+    virtual void process(unsigned int);
+    virtual bool reads_control_rate(unsigned int);
+    virtual bool can_go_dormant();
+    virtual void skip(unsigned int);
+    virtual bool output_static();
     virtual bool handle_event(Graphics_Object *);
     virtual void calculate_unique_graphics_object_locations();
     virtual void initialize_unique_graphics_objects();
     virtual std::string get_unique_text_representation();
+    virtual void set_unique_text_representation(std::vector<std::string> *);
 
     // Member functions particular to this module
     //   Produce samples for the various types of waveforms given a phase
@@ -68,6 +86,32 @@ public:
     double produce_tri_sample(double);
     double produce_saw_sample(double);
     double produce_sqr_sample(double);
+    //   Produce a sample of the current waveform type in the current range
+    //   given a phase, for a point calculated at control rate
+    float produce_control_point(double);
+    //   Convert a phase from 0 to 1 to fixed point and back
+    static Uint32 to_fixed_phase(double);
+    static double from_fixed_phase(Uint32);
+    //   Generate a whole block from the phase buffer
+    void produce_samples(unsigned int);
+    //   Produce band-limited samples given a wavetable and a fixed point
+    //   phase, pulse waves are made from the saw wave wavetable
+    static float read_wavetable(const float *, Uint32);
+    float read_sqr_wavetable(const float *, Uint32);
+    //   Find the wavetable to use for a block given the highest frequency in
+    //   it
+    const float *select_wavetable(double);
+    //   Return the highest frequency in a block
+    float find_highest_frequency(unsigned int);
+    //   Return whether or not a block is calculated at control rate
+    bool at_control_rate(unsigned int);
+    //   Fill the output buffer when every parameter is constant for the
+    //   block, or when at least one of them is live
+    void process_constant(unsigned int, double);
+    void process_live(unsigned int);
+    //   Fill the output buffer with a point calculated once every control
+    //   period and the samples interpolated in between
+    void process_control(unsigned int);
     //   Switch to outputting the given waveform type
     void switch_waveform(WaveformType);
     //   Reset phase
@@ -46,13 +46,12 @@ Output::~Output()
 {}
 
 /*
- * This function simply calls upon dependencies for processing. The output
- * module depends on all other modules.
+ * The output module does no processing of its own. The modules it depends upon
+ * are processed by the execution plan, and its inputs are read directly by the
+ * audio callback.
  */
-void Output::process()
-{
-    process_dependencies();
-}
+void Output::process(unsigned int num_samples)
+{}
 
 /*
  * Handle user interactions with graphics objects. First call the module class
@@ -1,9 +1,9 @@
 /*
  * Matthew Diamond 2015
  * The output module. All audio requested by the callback function comes through
- * here. This module simply processes the modules it depends upon, then makes
- * available full audio buffers to the audio callback function. This file
- * defines the class.
+ * here. The modules this module depends upon determine the execution plan, and
+ * its inputs make available full audio buffers to the audio callback function.
+ * This file defines the class.
  */
 
 #ifndef MSS_OUTPUT_HPP
@@ -34,7 +34,7 @@ public:
     virtual ~Output();
 
     // Member functions, explained in Module.hpp
-    virtual void process();
+    virtual void process(unsigned int);
     virtual bool handle_event(Graphics_Object *);
     virtual void calculate_unique_graphics_object_locations();
     virtual void initialize_unique_graphics_objects();
@@ -0,0 +1,860 @@
+/*
+ * Matthew Diamond 2016
+ * Member functions for the Poly class.
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Included SDL components
+#include "SDL.h"
+#include "SDL_ttf.h"
+
+// Included files
+#include "graphics_object_utils.hpp"
+#include "image_processing.hpp"
+#include "main.hpp"
+#include "populate_wavetables.hpp"
+#include "signal_processing.hpp"
+
+// Included modules classes
+#include "Module.hpp"
+#include "Modules/Oscillator.hpp"
+#include "Modules/Poly.hpp"
+
+/********************
+ * HELPER FUNCTIONS *
+ ********************/
+
+/*
+ * Return how far a voice's fixed point phase moves each sample at the given
+ * frequency. Negative frequencies wrap around to the same motion backwards.
+ */
+static Uint32 calculate_phase_increment(float frequency)
+{
+    return Oscillator::to_fixed_phase((double) frequency / SAMPLE_RATE);
+}
+
+/*
+ * Return the value of an input for a whole block, the first sample of its
+ * source if it is live.
+ */
+static float block_val(Module::Parameter *input)
+{
+    return input->live ? input->in[0] : input->val;
+}
+
+/*************************
+ * POLY MEMBER FUNCTIONS *
+ *************************/
+
+/*
+ * Constructor.
+ */
+Poly::Poly() :
+    Module(POLY),
+    note_events(0), input_note_on(false), attack_samples(0), decay_samples(0),
+    sustain(0), release_samples(0), waveform_type(Oscillator::SAW),
+    sin_on(false), tri_on(false), saw_on(true), sqr_on(false),
+    num_voices(8), processed_voices(8)
+{
+    inputs[POLY_FREQUENCY].val = 440;
+    inputs[POLY_A].val = 10;
+    inputs[POLY_D].val = 200;
+    inputs[POLY_S].val = .5;
+    inputs[POLY_R].val = 300;
+    inputs[POLY_FREQUENCY_CUTOFF].val = 5000;
+    inputs[POLY_Q].val = .707;
+
+    reset_voices();
+}
+
+/*
+ * Destructor.
+ */
+Poly::~Poly()
+{}
+
+/*
+ * Fill the output buffer with the sum of every voice. Notes from the note
+ * on/off input are started and released at the exact sample the input
+ * changes, and the voice playing it follows the frequency input. Every other
+ * parameter is read once per block. If no voice is sounding and no note
+ * starts during the block, the output is just silence.
+ */
+void Poly::process(unsigned int num_samples)
+{
+    unsigned int voices = num_voices;
+    float *frequency = nullptr;
+    float *note = nullptr;
+    bool sounding = false;
+
+    if(inputs[POLY_FREQUENCY].live)
+    {
+        frequency = inputs[POLY_FREQUENCY].in;
+    }
+    if(inputs[POLY_NOTE].live)
+    {
+        note = inputs[POLY_NOTE].in;
+    }
+    else
+    {
+        inputs[POLY_NOTE].val = 0;
+    }
+
+    // Silence any voices no longer in use since the number of voices went
+    // down
+    for(unsigned int v = voices; v < processed_voices; v ++)
+    {
+        enter_stage(v, VOICE_IDLE_STAGE);
+    }
+    processed_voices = voices;
+
+    update_envelope_parameters();
+
+    // Once per block, calculate the lowpass filter coefficients shared by
+    // every voice, keeping the cutoff below the Nyquist frequency so that
+    // the filter stays stable
+    float cutoff = std::min(std::max(block_val(&inputs[POLY_FREQUENCY_CUTOFF]),
+                                     (float) 1), SAMPLE_RATE * (float) .45);
+    float q = std::max(block_val(&inputs[POLY_Q]), (float) .1);
+    double w0 = (cutoff / SAMPLE_RATE) * 2 * M_PI;
+    double alpha = sin(w0) / (2 * q);
+    b0 = ((1 - cos(w0)) / 2) / (1 + alpha);
+    b1 = (1 - cos(w0)) / (1 + alpha);
+    b2 = b0;
+    a1 = (-2 * cos(w0)) / (1 + alpha);
+    a2 = (1 - alpha) / (1 + alpha);
+
+    // A constant frequency applies to the input note for the whole block
+    if(frequency == nullptr)
+    {
+        Uint32 phase_increment =
+            calculate_phase_increment(inputs[POLY_FREQUENCY].val);
+        for(unsigned int v = 0; v < voices; v ++)
+        {
+            if(notes[v] == INPUT_NOTE)
+            {
+                phase_increments[v] = phase_increment;
+            }
+        }
+    }
+
+    // Once per block, pick the wavetable each voice reads from, the input
+    // note reads the wavetable for its highest frequency in the block
+    float input_frequency = fabs(inputs[POLY_FREQUENCY].val);
+    for(unsigned int i = 0; frequency != nullptr && i < num_samples; i ++)
+    {
+        if(fabs(frequency[i]) > input_frequency)
+        {
+            input_frequency = fabs(frequency[i]);
+        }
+    }
+    for(unsigned int v = 0; v < voices; v ++)
+    {
+        if(notes[v] == INPUT_NOTE)
+        {
+            frequencies[v] = input_frequency;
+        }
+        wavetables[v] = find_wavetable(waveform_type, frequencies[v]);
+    }
+
+    for(unsigned int v = 0; v < voices; v ++)
+    {
+        sounding = sounding || stages[v] != VOICE_IDLE_STAGE;
+    }
+    for(unsigned int i = 0; note != nullptr && !sounding && i < num_samples;
+        i ++)
+    {
+        sounding = note[i] == 1;
+    }
+
+    if(!sounding)
+    {
+        std::fill(out, out + num_samples, 0);
+        std::fill(z1, z1 + voices, 0);
+        std::fill(z2, z2 + voices, 0);
+        input_note_on = false;
+    }
+    // The number of voices is known at compile time in each of these, so that
+    // the compiler can process them side by side
+    else if(voices == 4)
+    {
+        process_voices<4>(num_samples, frequency, note);
+    }
+    else if(voices == 8)
+    {
+        process_voices<8>(num_samples, frequency, note);
+    }
+    else
+    {
+        process_voices<MAX_VOICES>(num_samples, frequency, note);
+    }
+
+    update_input_vals(num_samples - 1);
+}
+
+/*
+ * Fill the output buffer with the sum of the given number of voices, given
+ * the frequency and note on/off input buffers if they are live. For each
+ * sample, every voice is computed side by side, with nothing but arithmetic
+ * on the arrays of voice state, so that the compiler can process several
+ * voices at once. Only a voice reaching the end of an envelope stage, counted
+ * down in samples, needs any further attention.
+ */
+template<unsigned int VOICES>
+void Poly::process_voices(unsigned int num_samples, float *frequency,
+                          float *note)
+{
+    const unsigned int fraction_bits = 32 - WAVETABLE_BITS;
+    const Uint32 fraction_mask = (1 << fraction_bits) - 1;
+    const float fraction_scale = 1.0f / (1 << fraction_bits);
+    float b0_ = b0, b1_ = b1, b2_ = b2, a1_ = a1, a2_ = a2;
+
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        float samples[VOICES];
+        float sum = 0;
+        int finished = 0;
+
+        // Start or release the input note if the note on/off input changed
+        if(note != nullptr && (note[i] == 1) != input_note_on)
+        {
+            input_note_on = !input_note_on;
+            if(input_note_on)
+            {
+                note_on(INPUT_NOTE, frequency != nullptr ? frequency[i]
+                                    : inputs[POLY_FREQUENCY].val);
+            }
+            else
+            {
+                note_off(INPUT_NOTE);
+            }
+        }
+        else if(note == nullptr && input_note_on)
+        {
+            input_note_on = false;
+            note_off(INPUT_NOTE);
+        }
+
+        if(frequency != nullptr)
+        {
+            Uint32 phase_increment = calculate_phase_increment(frequency[i]);
+            for(unsigned int v = 0; v < VOICES; v ++)
+            {
+                phase_increments[v] = notes[v] == INPUT_NOTE ? phase_increment
+                                      : phase_increments[v];
+            }
+        }
+
+        // Read each voice's wavetable, interpolating between entries
+        for(unsigned int v = 0; v < VOICES; v ++)
+        {
+            const float *wavetable = wavetables[v];
+            Uint32 index = phases[v] >> fraction_bits;
+            float fraction = (phases[v] & fraction_mask) * fraction_scale;
+
+            samples[v] = wavetable[index]
+                         + fraction * (wavetable[index + 1] - wavetable[index]);
+        }
+
+        // Apply the envelope and the filter, then move the phase and the
+        // envelope along by a sample, the phase wraps around on its own as it
+        // overflows
+        for(unsigned int v = 0; v < VOICES; v ++)
+        {
+            float x = samples[v] * amplitudes[v];
+            float y = b0_ * x + z1[v];
+
+            z1[v] = b1_ * x - a1_ * y + z2[v];
+            z2[v] = b2_ * x - a2_ * y;
+            samples[v] = y;
+
+            phases[v] += phase_increments[v];
+            amplitudes[v] += amplitude_increments[v];
+            stage_samples[v] -= 1;
+            finished |= stage_samples[v] <= 0;
+        }
+
+        for(unsigned int v = 0; v < VOICES; v ++)
+        {
+            sum += samples[v];
+        }
+        out[i] = sum;
+
+        if(finished)
+        {
+            finish_stages();
+        }
+    }
+}
+
+/*
+ * Read the envelope parameters for this block. If any of them changed since
+ * the last block, the voices in the attack and decay stages carry on from
+ * their current amplitudes at the new rates. Voices already released keep
+ * the rate they were released at.
+ */
+void Poly::update_envelope_parameters()
+{
+    float attack_samples_ = std::max((block_val(&inputs[POLY_A]) / 1000)
+                                     * SAMPLE_RATE, (float) 1);
+    float decay_samples_ = std::max((block_val(&inputs[POLY_D]) / 1000)
+                                    * SAMPLE_RATE, (float) 1);
+    float sustain_ = std::min(std::max(block_val(&inputs[POLY_S]), (float) 0),
+                              (float) 1);
+    float release_samples_ = std::max((block_val(&inputs[POLY_R]) / 1000)
+                                      * SAMPLE_RATE, (float) 1);
+
+    if(attack_samples_ == attack_samples && decay_samples_ == decay_samples
+       && sustain_ == sustain && release_samples_ == release_samples)
+    {
+        return;
+    }
+
+    attack_samples = attack_samples_;
+    decay_samples = decay_samples_;
+    sustain = sustain_;
+    release_samples = release_samples_;
+
+    for(unsigned int v = 0; v < processed_voices; v ++)
+    {
+        if(stages[v] == VOICE_A_STAGE || stages[v] == VOICE_D_STAGE)
+        {
+            enter_stage(v, stages[v]);
+        }
+    }
+}
+
+/*
+ * Move a voice to a new envelope stage, working out how far its amplitude
+ * moves each sample, where the stage ends, and how many samples away that is.
+ * The sustain and idle stages never end on their own. If the voice is already
+ * past the end of the stage, move straight on to the next one.
+ */
+void Poly::enter_stage(unsigned int v, VoiceStage stage)
+{
+    stages[v] = stage;
+    amplitude_increments[v] = 0;
+    amplitude_targets[v] = amplitudes[v];
+    stage_samples[v] = std::numeric_limits<float>::max();
+
+    switch(stage)
+    {
+    case VOICE_A_STAGE:
+        if(amplitudes[v] >= 1)
+        {
+            amplitudes[v] = 1;
+            enter_stage(v, VOICE_D_STAGE);
+            break;
+        }
+        amplitude_increments[v] = 1 / attack_samples;
+        amplitude_targets[v] = 1;
+        stage_samples[v] = (1 - amplitudes[v]) * attack_samples;
+        break;
+    case VOICE_D_STAGE:
+        if(amplitudes[v] <= sustain)
+        {
+            enter_stage(v, VOICE_S_STAGE);
+            break;
+        }
+        amplitude_increments[v] = -(1 - sustain) / decay_samples;
+        amplitude_targets[v] = sustain;
+        stage_samples[v] = (amplitudes[v] - sustain) / (1 - sustain)
+                           * decay_samples;
+        break;
+    case VOICE_S_STAGE:
+        break;
+    case VOICE_R_STAGE:
+        if(amplitudes[v] <= 0)
+        {
+            enter_stage(v, VOICE_IDLE_STAGE);
+            break;
+        }
+        amplitude_increments[v] = -amplitudes[v] / release_samples;
+        amplitude_targets[v] = 0;
+        stage_samples[v] = release_samples;
+        break;
+    case VOICE_IDLE_STAGE:
+        amplitudes[v] = 0;
+        amplitude_targets[v] = 0;
+        z1[v] = 0;
+        z2[v] = 0;
+        break;
+    }
+}
+
+/*
+ * Move every voice that reached the end of its envelope stage on to the next
+ * stage, starting from exactly the amplitude at which the stage ends.
+ */
+void Poly::finish_stages()
+{
+    for(unsigned int v = 0; v < processed_voices; v ++)
+    {
+        if(stage_samples[v] <= 0)
+        {
+            amplitudes[v] = amplitude_targets[v];
+            switch(stages[v])
+            {
+            case VOICE_A_STAGE:
+                enter_stage(v, VOICE_D_STAGE);
+                break;
+            case VOICE_D_STAGE:
+                enter_stage(v, VOICE_S_STAGE);
+                break;
+            case VOICE_R_STAGE:
+                enter_stage(v, VOICE_IDLE_STAGE);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+/*
+ * Find the voice to play a note on. A voice already playing the same note is
+ * played again, otherwise an idle voice is used. If there are none, steal the
+ * voice that was released the longest ago, or if no voice has been released,
+ * the voice whose note started the longest ago.
+ */
+unsigned int Poly::find_voice(int note)
+{
+    unsigned int oldest_released = MAX_VOICES;
+    unsigned int oldest = 0;
+
+    for(unsigned int v = 0; v < processed_voices; v ++)
+    {
+        if(stages[v] != VOICE_IDLE_STAGE && notes[v] == note)
+        {
+            return v;
+        }
+    }
+
+    for(unsigned int v = 0; v < processed_voices; v ++)
+    {
+        if(stages[v] == VOICE_IDLE_STAGE)
+        {
+            return v;
+        }
+        else if(stages[v] == VOICE_R_STAGE
+                && (oldest_released == MAX_VOICES
+                    || note_events - note_releases[v]
+                       > note_events - note_releases[oldest_released]))
+        {
+            oldest_released = v;
+        }
+
+        if(note_events - note_starts[v] > note_events - note_starts[oldest])
+        {
+            oldest = v;
+        }
+    }
+
+    return oldest_released != MAX_VOICES ? oldest_released : oldest;
+}
+
+/*
+ * Start playing a note at the given frequency. A voice that was idle starts
+ * from the beginning of its waveform, a stolen voice carries on from its
+ * current phase and amplitude so that stealing it does not click.
+ */
+void Poly::note_on(int note, float frequency)
+{
+    unsigned int v = find_voice(note);
+
+    if(stages[v] == VOICE_IDLE_STAGE)
+    {
+        phases[v] = 0;
+    }
+
+    notes[v] = note;
+    note_starts[v] = ++ note_events;
+    phase_increments[v] = calculate_phase_increment(frequency);
+    frequencies[v] = fabs(frequency);
+    wavetables[v] = find_wavetable(waveform_type, frequency);
+    enter_stage(v, VOICE_A_STAGE);
+}
+
+/*
+ * Release every voice playing the given note.
+ */
+void Poly::note_off(int note)
+{
+    for(unsigned int v = 0; v < processed_voices; v ++)
+    {
+        if(notes[v] == note && stages[v] != VOICE_R_STAGE
+           && stages[v] != VOICE_IDLE_STAGE)
+        {
+            note_releases[v] = ++ note_events;
+            enter_stage(v, VOICE_R_STAGE);
+        }
+    }
+}
+
+/*
+ * The note input is a gate, whose edges start and release notes, so every
+ * other input can read a signal calculated at control rate.
+ */
+bool Poly::reads_control_rate(unsigned int input_num)
+{
+    return input_num != POLY_NOTE;
+}
+
+/*
+ * Handle user interactions with graphics objects. First call the module class
+ * version of this function to handle events that might happen to any module.
+ * If nothing happens in the module class version of the function, then handle
+ * events specific to this module type here.
+ */
+bool Poly::handle_event(Graphics_Object *g)
+{
+    // If g is null, take no action, return false
+    if(g == nullptr)
+    {
+        return false;
+    }
+    // Handle waveform type toggle buttons
+    else if(g == graphics_objects["sin toggle button"])
+    {
+        switch_waveform(Oscillator::SIN);
+        return true;
+    }
+    else if(g == graphics_objects["tri toggle button"])
+    {
+        switch_waveform(Oscillator::TRI);
+        return true;
+    }
+    else if(g == graphics_objects["saw toggle button"])
+    {
+        switch_waveform(Oscillator::SAW);
+        return true;
+    }
+    else if(g == graphics_objects["sqr toggle button"])
+    {
+        switch_waveform(Oscillator::SQR);
+        return true;
+    }
+    // Handle number of voices toggle buttons
+    else if(g == graphics_objects["4 voices toggle button"])
+    {
+        switch_num_voices(4);
+        return true;
+    }
+    else if(g == graphics_objects["8 voices toggle button"])
+    {
+        switch_num_voices(8);
+        return true;
+    }
+    else if(g == graphics_objects["16 voices toggle button"])
+    {
+        switch_num_voices(16);
+        return true;
+    }
+    // If none of the above, handle events that apply to all modules, return
+    // true if an event is handled
+    else if(Module::handle_event(g))
+    {
+        return true;
+    }
+
+    // If none of the above, return false
+    return false;
+}
+
+/*
+ * Calculate the locations of graphics objects unique to this module type, add
+ * them to the map of graphics object locations.
+ */
+void Poly::calculate_unique_graphics_object_locations()
+{
+    SDL_Rect location;
+
+    // Waveform viewer location
+    location = {upper_left.x, upper_left.y + 15, MODULE_WIDTH, 34};
+    graphics_object_locations["waveform"] = location;
+
+    // Frequency/note on/off related graphics object locations
+    location = {upper_left.x + 2, location.y + 37, 0, 0};
+    graphics_object_locations["frequency/note text"] = location;
+    location = {upper_left.x, location.y + 10, (MODULE_WIDTH / 2) - 9, 9};
+    graphics_object_locations["frequency text box"] = location;
+    location = {location.x + location.w + 1, location.y, 7, 9};
+    graphics_object_locations["frequency toggle button"] = location;
+    location = {location.x + location.w + 1, location.y, (MODULE_WIDTH / 2) - 8, 9};
+    graphics_object_locations["note text box"] = location;
+    location = {location.x + location.w + 1, location.y, 7, 9};
+    graphics_object_locations["note toggle button"] = location;
+
+    // Attack/decay related graphics object locations
+    location = {upper_left.x + 2, location.y + 10, 0, 0};
+    graphics_object_locations["a/d text"] = location;
+    location = {upper_left.x, location.y + 10, (MODULE_WIDTH / 2) - 9, 9};
+    graphics_object_locations["a text box"] = location;
+    location = {location.x + location.w + 1, location.y, 7, 9};
+    graphics_object_locations["a toggle button"] = location;
+    location = {location.x + location.w + 1, location.y, (MODULE_WIDTH / 2) - 8, 9};
+    graphics_object_locations["d text box"] = location;
+    location = {location.x + location.w + 1, location.y, 7, 9};
+    graphics_object_locations["d toggle button"] = location;
+
+    // Sustain/release related graphics object locations
+    location = {upper_left.x + 2, location.y + 10, 0, 0};
+    graphics_object_locations["s/r text"] = location;
+    location = {upper_left.x, location.y + 10, (MODULE_WIDTH / 2) - 9, 9};
+    graphics_object_locations["s text box"] = location;
+    location = {location.x + location.w + 1, location.y, 7, 9};
+    graphics_object_locations["s toggle button"] = location;
+    location = {location.x + location.w + 1, location.y, (MODULE_WIDTH / 2) - 8, 9};
+    graphics_object_locations["r text box"] = location;
+    location = {location.x + location.w + 1, location.y, 7, 9};
+    graphics_object_locations["r toggle button"] = location;
+
+    // Frequency cutoff/q related graphics object locations
+    location = {upper_left.x + 2, location.y + 10, 0, 0};
+    graphics_object_locations["frequency cutoff/q text"] = location;
+    location = {upper_left.x, location.y + 10, (MODULE_WIDTH / 2) - 9, 9};
+    graphics_object_locations["frequency cutoff text box"] = location;
+    location = {location.x + location.w + 1, location.y, 7, 9};
+    graphics_object_locations["frequency cutoff toggle button"] = location;
+    location = {location.x + location.w + 1, location.y, (MODULE_WIDTH / 2) - 8, 9};
+    graphics_object_locations["q text box"] = location;
+    location = {location.x + location.w + 1, location.y, 7, 9};
+    graphics_object_locations["q toggle button"] = location;
+
+    // Waveform type/number of voices related graphics object locations
+    location = {upper_left.x + 2, location.y + 10, 0, 0};
+    graphics_object_locations["waveform type/voices text"] = location;
+    location = {upper_left.x, location.y + 10, (MODULE_WIDTH / 7) - 1, 9};
+    graphics_object_locations["sin toggle button"] = location;
+    location = {location.x + location.w + 1, location.y, location.w, 9};
+    graphics_object_locations["tri toggle button"] = location;
+    location = {location.x + location.w + 1, location.y, location.w, 9};
+    graphics_object_locations["saw toggle button"] = location;
+    location = {location.x + location.w + 1, location.y, location.w, 9};
+    graphics_object_locations["sqr toggle button"] = location;
+    location = {location.x + location.w + 1, location.y, location.w, 9};
+    graphics_object_locations["4 voices toggle button"] = location;
+    location = {location.x + location.w + 1, location.y, location.w, 9};
+    graphics_object_locations["8 voices toggle button"] = location;
+    location = {location.x + location.w + 1, location.y,
+                upper_left.x + MODULE_WIDTH - location.x - location.w - 1, 9};
+    graphics_object_locations["16 voices toggle button"] = location;
+}
+
+/*
+ * Initialize graphics objects unique to this module type, add them to the
+ * map of graphics objects.
+ */
+void Poly::initialize_unique_graphics_objects()
+{
+    std::vector<std::string> text_box_names = {"frequency", "note", "a", "d",
+                                               "s", "r", "frequency cutoff",
+                                               "q"};
+
+    // Initialize text objects
+    graphics_objects["frequency/note text"] =
+        new Text(name + " frequency/note text",
+                 graphics_object_locations["frequency/note text"],
+                 secondary_module_color, "FREQUENCY & NOTE ON/OFF:");
+    graphics_objects["a/d text"] =
+        new Text(name + " a/d text",
+                 graphics_object_locations["a/d text"],
+                 secondary_module_color, "ATTACK & DECAY (ms):");
+    graphics_objects["s/r text"] =
+        new Text(name + " s/r text",
+                 graphics_object_locations["s/r text"],
+                 secondary_module_color, "SUSTAIN & RELEASE (ms):");
+    graphics_objects["frequency cutoff/q text"] =
+        new Text(name + " frequency cutoff/q text",
+                 graphics_object_locations["frequency cutoff/q text"],
+                 secondary_module_color, "CUTOFF & Q:");
+    graphics_objects["waveform type/voices text"] =
+        new Text(name + " waveform type/voices text",
+                 graphics_object_locations["waveform type/voices text"],
+                 secondary_module_color, "WAVEFORM TYPE & VOICES:");
+
+    // Initialize waveform viewer
+    graphics_objects["waveform"] =
+        new Waveform(name + " waveform",
+                     graphics_object_locations["waveform"],
+                     primary_module_color, secondary_module_color, &out);
+
+    // Initialize text boxes and toggle buttons for every input, and store
+    // pointers to them in the necessary data structures
+    for(unsigned int i = 0; i < text_box_names.size(); i ++)
+    {
+        std::string text_box = text_box_names[i] + " text box";
+        std::string toggle_button = text_box_names[i] + " toggle button";
+
+        graphics_objects[text_box] =
+            new Text_Box(name + " " + text_box,
+                         graphics_object_locations[text_box],
+                         secondary_module_color, primary_module_color,
+                         "# or input", (Graphics_Listener *) this);
+        graphics_objects[toggle_button] =
+            new Toggle_Button(name + " " + toggle_button,
+                              graphics_object_locations[toggle_button],
+                              secondary_module_color, secondary_module_color,
+                              RED, primary_module_color, "I", "I", false,
+                              (Graphics_Listener *) this);
+
+        text_box_to_input_num[(Text_Box *) graphics_objects[text_box]] = i;
+        toggle_button_to_input_num[(Toggle_Button *) graphics_objects[toggle_button]] = i;
+        inputs[i].text_box = (Text_Box *) graphics_objects[text_box];
+        inputs[i].toggle_button = (Toggle_Button *) graphics_objects[toggle_button];
+    }
+
+    // Initialize waveform type toggle buttons
+    graphics_objects["sin toggle button"] =
+        new Toggle_Button(name + " sin toggle button",
+                          graphics_object_locations["sin toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "SIN", "SIN", sin_on, (Graphics_Listener *) this);
+    graphics_objects["tri toggle button"] =
+        new Toggle_Button(name + " tri toggle button",
+                          graphics_object_locations["tri toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "TRI", "TRI", tri_on, (Graphics_Listener *) this);
+    graphics_objects["saw toggle button"] =
+        new Toggle_Button(name + " saw toggle button",
+                          graphics_object_locations["saw toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "SAW", "SAW", saw_on, (Graphics_Listener *) this);
+    graphics_objects["sqr toggle button"] =
+        new Toggle_Button(name + " sqr toggle button",
+                          graphics_object_locations["sqr toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "SQR", "SQR", sqr_on, (Graphics_Listener *) this);
+
+    // Initialize number of voices toggle buttons
+    graphics_objects["4 voices toggle button"] =
+        new Toggle_Button(name + " 4 voices toggle button",
+                          graphics_object_locations["4 voices toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "4", "4", num_voices == 4,
+                          (Graphics_Listener *) this);
+    graphics_objects["8 voices toggle button"] =
+        new Toggle_Button(name + " 8 voices toggle button",
+                          graphics_object_locations["8 voices toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "8", "8", num_voices == 8,
+                          (Graphics_Listener *) this);
+    graphics_objects["16 voices toggle button"] =
+        new Toggle_Button(name + " 16 voices toggle button",
+                          graphics_object_locations["16 voices toggle button"],
+                          secondary_module_color, primary_module_color,
+                          primary_module_color, secondary_module_color,
+                          "16", "16", num_voices == 16,
+                          (Graphics_Listener *) this);
+}
+
+/*
+ * Switch every voice to the given waveform type, and update the waveform
+ * toggle buttons to match if there are any.
+ */
+void Poly::switch_waveform(Oscillator::WaveformType waveform_type_)
+{
+    sin_on = waveform_type_ == Oscillator::SIN;
+    tri_on = waveform_type_ == Oscillator::TRI;
+    saw_on = waveform_type_ == Oscillator::SAW;
+    sqr_on = waveform_type_ == Oscillator::SQR;
+    waveform_type = waveform_type_;
+
+    std::cout << name << " is now playing "
+              << (sin_on ? "sine" : tri_on ? "triangle"
+                  : saw_on ? "sawtooth" : "square")
+              << " waves" << std::endl;
+
+    if(graphics_objects_initialized)
+    {
+        ((Toggle_Button *) graphics_objects["sin toggle button"])->b = sin_on;
+        ((Toggle_Button *) graphics_objects["tri toggle button"])->b = tri_on;
+        ((Toggle_Button *) graphics_objects["saw toggle button"])->b = saw_on;
+        ((Toggle_Button *) graphics_objects["sqr toggle button"])->b = sqr_on;
+    }
+}
+
+/*
+ * Switch to playing notes on the given number of voices, a multiple of LANES
+ * no greater than MAX_VOICES, and update the number of voices toggle buttons
+ * to match if there are any. Voices no longer in use are silenced by the
+ * audio thread at the start of the next block.
+ */
+void Poly::switch_num_voices(unsigned int num_voices_)
+{
+    num_voices = num_voices_ - num_voices_ % LANES;
+    if(num_voices < LANES)
+    {
+        num_voices = LANES;
+    }
+    else if(num_voices > MAX_VOICES)
+    {
+        num_voices = MAX_VOICES;
+    }
+
+    std::cout << name << " now has " << num_voices << " voices" << std::endl;
+
+    if(graphics_objects_initialized)
+    {
+        ((Toggle_Button *) graphics_objects["4 voices toggle button"])->b =
+            num_voices == 4;
+        ((Toggle_Button *) graphics_objects["8 voices toggle button"])->b =
+            num_voices == 8;
+        ((Toggle_Button *) graphics_objects["16 voices toggle button"])->b =
+            num_voices == 16;
+    }
+}
+
+/*
+ * Silence every voice.
+ */
+void Poly::reset_voices()
+{
+    for(unsigned int v = 0; v < MAX_VOICES; v ++)
+    {
+        phases[v] = 0;
+        phase_increments[v] = 0;
+        frequencies[v] = 0;
+        wavetables[v] = find_wavetable(waveform_type, 0);
+        notes[v] = NO_NOTE;
+        note_starts[v] = 0;
+        note_releases[v] = 0;
+        enter_stage(v, VOICE_IDLE_STAGE);
+    }
+}
+
+std::string Poly::get_unique_text_representation()
+{
+    return std::to_string(waveform_type) + "\n"
+           + std::to_string(num_voices) + "\n";
+}
+
+/*
+ * Restore the waveform type and number of voices.
+ */
+void Poly::set_unique_text_representation(std::vector<std::string> *lines)
+{
+    if(lines->size() >= 2)
+    {
+        switch_waveform((Oscillator::WaveformType) stoi((*lines)[0]));
+        switch_num_voices(stoi((*lines)[1]));
+    }
+}
+
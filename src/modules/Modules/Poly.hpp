@@ -0,0 +1,143 @@
+/*
+ * Matthew Diamond 2016
+ * The poly module. This module plays up to 16 notes at once, each with its
+ * own voice made up of an oscillator, an ADSR envelope, and a lowpass filter,
+ * the same chain that would otherwise take three modules per note. The state
+ * of every voice is kept in arrays with one lane per voice, so that the voices
+ * are computed side by side. Notes come from the note on/off and frequency
+ * inputs, and from the computer keyboard. When every voice is in use, a new
+ * note steals the voice that has been released the longest, or if none have
+ * been released, the voice that has been playing the longest. This file
+ * defines the class.
+ */
+
+#ifndef MSS_POLY_HPP
+#define MSS_POLY_HPP
+
+/************
+ * INCLUDES *
+ ************/
+
+// No includes necessary
+
+/*************************
+ * POLY CLASS DEFINITION *
+ *************************/
+
+class Poly: public Module
+{
+public:
+    // The most voices a poly module can have, the number of voices is always
+    // a multiple of LANES so that voices can be computed side by side
+    static const unsigned int MAX_VOICES = 16;
+    static const unsigned int LANES = 4;
+    // The note played by the note on/off and frequency inputs, and the note
+    // of a voice that has never played, keyboard notes are numbered from 0 to
+    // 127
+    static const int INPUT_NOTE = -1;
+    static const int NO_NOTE = -2;
+
+    // Voice stage enum
+    enum VoiceStage
+    {
+        VOICE_A_STAGE = 0,
+        VOICE_D_STAGE,
+        VOICE_S_STAGE,
+        VOICE_R_STAGE,
+        VOICE_IDLE_STAGE
+    };
+
+    // Poly dependencies enum
+    enum PolyDependencies
+    {
+        POLY_FREQUENCY = 0,
+        POLY_NOTE,
+        POLY_A,
+        POLY_D,
+        POLY_S,
+        POLY_R,
+        POLY_FREQUENCY_CUTOFF,
+        POLY_Q
+    };
+
+    // The state of every voice, one lane per voice
+    //   Oscillator phase in fixed point, how far it moves each sample, the
+    //   frequency it was last played at, and the wavetable for that frequency
+    Uint32 phases[MAX_VOICES];
+    Uint32 phase_increments[MAX_VOICES];
+    float frequencies[MAX_VOICES];
+    const float *wavetables[MAX_VOICES];
+    //   Envelope stage and amplitude, how far the amplitude moves each sample,
+    //   the amplitude at which the stage ends, and the number of samples
+    //   until then
+    VoiceStage stages[MAX_VOICES];
+    float amplitudes[MAX_VOICES];
+    float amplitude_increments[MAX_VOICES];
+    float amplitude_targets[MAX_VOICES];
+    float stage_samples[MAX_VOICES];
+    //   Lowpass filter history
+    float z1[MAX_VOICES];
+    float z2[MAX_VOICES];
+    // Lowpass filter coefficients shared by every voice, calculated once per
+    // block
+    float b0, b1, b2, a1, a2;
+    //   The note each voice is playing, and when that note started and was
+    //   released, counted in notes started and released so far
+    int notes[MAX_VOICES];
+    unsigned int note_starts[MAX_VOICES];
+    unsigned int note_releases[MAX_VOICES];
+    unsigned int note_events;
+    // Whether or not the note on/off input was on after the last sample
+    bool input_note_on;
+    // The envelope times in samples and the sustain amplitude used during the
+    // last block
+    float attack_samples, decay_samples, sustain, release_samples;
+    // The waveform played by every voice
+    Oscillator::WaveformType waveform_type;
+    // Whether or not each waveform is in use
+    bool sin_on, tri_on, saw_on, sqr_on;
+    // The number of voices notes may be played on, 4, 8, or 16, and the number
+    // of voices processed during the last block
+    unsigned int num_voices;
+    unsigned int processed_voices;
+
+    // Constructor and destructor
+    Poly();
+    virtual ~Poly();
+
+    // Member functions, explained in Module.hpp
+    virtual void process(unsigned int);
+    virtual bool reads_control_rate(unsigned int);
+    virtual bool handle_event(Graphics_Object *);
+    virtual void calculate_unique_graphics_object_locations();
+    virtual void initialize_unique_graphics_objects();
+    virtual std::string get_unique_text_representation();
+    virtual void set_unique_text_representation(std::vector<std::string> *);
+
+    // Member functions particular to this module
+    //   Fill the output buffer with the sum of the given number of voices
+    template<unsigned int VOICES>
+    void process_voices(unsigned int, float *, float *);
+    //   Start or release a note, called from the audio thread only
+    void note_on(int, float);
+    void note_off(int);
+    //   Find the voice to play a new note on
+    unsigned int find_voice(int);
+    //   Move a voice to a new envelope stage
+    void enter_stage(unsigned int, VoiceStage);
+    //   Move every voice that reached the end of its envelope stage on to the
+    //   next stage
+    void finish_stages();
+    //   Read the envelope parameters for a block, and update the voices in
+    //   the attack and decay stages if they changed
+    void update_envelope_parameters();
+    //   Switch every voice to the given waveform type
+    void switch_waveform(Oscillator::WaveformType);
+    //   Switch to the given number of voices
+    void switch_num_voices(unsigned int);
+    //   Silence every voice
+    void reset_voices();
+};
+
+#endif
+
@@ -8,6 +8,7 @@
  ************/
 
 // Included libraries
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <string>
@@ -21,6 +22,7 @@
 #include "graphics_object_utils.hpp"
 #include "image_processing.hpp"
 #include "main.hpp"
+#include "signal_kernels.hpp"
 #include "signal_processing.hpp"
 
 // Included modules classes
@@ -35,7 +37,8 @@
  * Constructor.
  */
 Sah::Sah() :
-    Module(SAH)
+    Module(SAH),
+    sample(0), samples_to_next_sample(0), previous_trigger(0)
 {
     inputs[SAH_SIGNAL].val = 0;
     inputs[SAH_HOLD_TIME].val = 500;
@@ -48,39 +51,134 @@ Sah::~Sah()
 {}
 
 /*
- * Process all dependencies, then start sampling and holding.
+ * Start sampling and holding. While the trigger signal is live, a sample is
+ * taken at each of its rising edges, and otherwise once the hold time has
+ * passed. Unless the hold time is live, the output only changes at those
+ * boundaries, so the held sample is filled in up to each one at once.
  */
-void Sah::process()
+void Sah::process(unsigned int num_samples)
 {
-    // Process any dependencies
-    process_dependencies();
+    float *signal = nullptr;
 
-    for(unsigned int i = 0; i < BUFFER_SIZE; i ++)
+    if(inputs[SAH_SIGNAL].live)
     {
-        update_input_vals(i);
+        signal = inputs[SAH_SIGNAL].in;
+    }
 
-        if(!inputs[SAH_SIGNAL].live)
+    if(inputs[SAH_TRIGGER].live)
+    {
+        process_triggered(signal, num_samples);
+    }
+    else if(!inputs[SAH_HOLD_TIME].live)
+    {
+        previous_trigger = 0;
+        process_held(signal, num_samples);
+    }
+    else
+    {
+        previous_trigger = 0;
+        for(unsigned int i = 0; i < num_samples; i ++)
         {
-            inputs[SAH_SIGNAL].val = 0;
+            update_input_vals(i);
+
+            if(!inputs[SAH_SIGNAL].live)
+            {
+                inputs[SAH_SIGNAL].val = 0;
+            }
+
+            // If the hold time has passed, update the sample to hold, and
+            // start counting down the hold time again
+            if(samples_to_next_sample <= 0)
+            {
+                sample = inputs[SAH_SIGNAL].val;
+                samples_to_next_sample = inputs[SAH_HOLD_TIME].val / 1000.0
+                                         * SAMPLE_RATE;
+            }
+
+            // Set the output samples to the currently held sample,
+            // then count down a single sample
+            out[i] = sample;
+            samples_to_next_sample -= 1;
         }
 
-        // If the amount of time until the next sample has passed, update the
-        // sample to hold, update the hold time, then update the time to next
-        // sample
-        if(time_to_next_sample <= 0)
+        return;
+    }
+
+    if(signal == nullptr)
+    {
+        inputs[SAH_SIGNAL].val = 0;
+    }
+    update_input_vals(num_samples - 1);
+}
+
+/*
+ * Fill the output buffer with the held sample, taking a new sample every time
+ * the constant hold time passes. The next sample is taken at the first sample
+ * at which no hold time is left, so the held sample is filled in up to there
+ * in one go.
+ */
+void Sah::process_held(const float *signal, unsigned int num_samples)
+{
+    double hold_samples = inputs[SAH_HOLD_TIME].val / 1000.0 * SAMPLE_RATE;
+    unsigned int i = 0;
+
+    while(i < num_samples)
+    {
+        unsigned int held = num_samples - i;
+
+        if(samples_to_next_sample <= 0)
         {
-            sample = inputs[SAH_SIGNAL].val;
-            time_to_next_sample = inputs[SAH_HOLD_TIME].val;
+            sample = signal != nullptr ? signal[i] : 0;
+            samples_to_next_sample = hold_samples;
         }
 
-        // Set the output samples to the currently held sample,
-        // then decrement the time to next sample by a single sample
-        // in ms
-        out[i] = sample;
-        time_to_next_sample -= ((double) 1000.0 / (double) SAMPLE_RATE);
+        if(ceil(samples_to_next_sample) < held)
+        {
+            held = std::max(1.0, ceil(samples_to_next_sample));
+        }
+
+        std::fill(out + i, out + i + held, (float) sample);
+        samples_to_next_sample -= held;
+        i += held;
     }
+}
 
-    processed = true;
+/*
+ * Fill the output buffer with the held sample, taking a new sample at every
+ * rising edge of the trigger signal, found by scanning ahead for the next
+ * one, so the held sample is filled in up to there in one go. Edges are
+ * detected across blocks with the last sample of the trigger signal.
+ */
+void Sah::process_triggered(const float *signal, unsigned int num_samples)
+{
+    const float *trigger = inputs[SAH_TRIGGER].in;
+    unsigned int i = 0;
+
+    while(i < num_samples)
+    {
+        unsigned int edge = i + find_rising_edge(
+            trigger + i, i == 0 ? previous_trigger : trigger[i - 1],
+            num_samples - i);
+
+        std::fill(out + i, out + edge, (float) sample);
+        if(edge < num_samples)
+        {
+            sample = signal != nullptr ? signal[edge] : 0;
+            out[edge] = sample;
+        }
+        i = edge + 1;
+    }
+
+    previous_trigger = trigger[num_samples - 1];
+}
+
+/*
+ * The trigger input needs every sample to find its rising edges, the signal
+ * and hold time can read a signal calculated at control rate.
+ */
+bool Sah::reads_control_rate(unsigned int input_num)
+{
+    return input_num != SAH_TRIGGER;
 }
 
 /*
@@ -126,11 +224,11 @@ void Sah::calculate_unique_graphics_object_locations()
     graphics_object_locations["reset sampler button"] = location;
 
     // Waveform viewer location
-    location = {upper_left.x, upper_left.y + 15, MODULE_WIDTH, 74};
+    location = {upper_left.x, upper_left.y + 15, MODULE_WIDTH, 54};
     graphics_object_locations["waveform"] = location;
 
     // Input signal related graphics object locations
-    location = {upper_left.x + 2, location.y + 77, 0, 0};
+    location = {upper_left.x + 2, location.y + 57, 0, 0};
     graphics_object_locations["signal text"] = location;
     location = {upper_left.x, location.y + 10, MODULE_WIDTH - 8, 9};
     graphics_object_locations["signal text box"] = location;
@@ -144,6 +242,14 @@ void Sah::calculate_unique_graphics_object_locations()
     graphics_object_locations["hold time text box"] = location;
     location = {location.x + location.w + 1, location.y, 7, 9};
     graphics_object_locations["hold time toggle button"] = location;
+
+    // Trigger related graphics object locations
+    location = {upper_left.x + 2, location.y + 10, 0, 0};
+    graphics_object_locations["trigger text"] = location;
+    location = {upper_left.x, location.y + 10, MODULE_WIDTH - 8, 9};
+    graphics_object_locations["trigger text box"] = location;
+    location = {location.x + location.w + 1, location.y, 7, 9};
+    graphics_object_locations["trigger toggle button"] = location;
 }
 
 /*
@@ -167,6 +273,10 @@ void Sah::initialize_unique_graphics_objects()
         new Text(name + " hold time text",
                  graphics_object_locations["hold time text"],
                  secondary_module_color, "HOLD TIME (ms):");
+    graphics_objects["trigger text"] =
+        new Text(name + " trigger text",
+                 graphics_object_locations["trigger text"],
+                 secondary_module_color, "TRIGGER:");
 
     // Initialize waveform viewer
     graphics_objects["waveform"] =
@@ -185,6 +295,11 @@ void Sah::initialize_unique_graphics_objects()
                      graphics_object_locations["hold time text box"],
                      secondary_module_color, primary_module_color,
                      "# or input", (Graphics_Listener *) this);
+    graphics_objects["trigger text box"] =
+        new Text_Box(name + " trigger text box",
+                     graphics_object_locations["trigger text box"],
+                     secondary_module_color, primary_module_color,
+                     "input", (Graphics_Listener *) this);
 
     // Initialize toggle buttons
     graphics_objects["signal toggle button"] =
@@ -199,6 +314,12 @@ void Sah::initialize_unique_graphics_objects()
                           secondary_module_color, secondary_module_color,
                           RED, primary_module_color, "I", "I", false,
                           (Graphics_Listener *) this);
+    graphics_objects["trigger toggle button"] =
+        new Toggle_Button(name + " trigger toggle button",
+                          graphics_object_locations["trigger toggle button"],
+                          secondary_module_color, secondary_module_color,
+                          RED, primary_module_color, "I", "I", false,
+                          (Graphics_Listener *) this);
 
     // Store pointers to these graphics objects in the necessary data
     // structures
@@ -210,6 +331,10 @@ void Sah::initialize_unique_graphics_objects()
     toggle_button_to_input_num[(Toggle_Button *) graphics_objects["hold time toggle button"]] = SAH_HOLD_TIME;
     inputs[SAH_HOLD_TIME].text_box = (Text_Box *) graphics_objects["hold time text box"];
     inputs[SAH_HOLD_TIME].toggle_button = (Toggle_Button *) graphics_objects["hold time toggle button"];
+    text_box_to_input_num[(Text_Box *) graphics_objects["trigger text box"]] = SAH_TRIGGER;
+    toggle_button_to_input_num[(Toggle_Button *) graphics_objects["trigger toggle button"]] = SAH_TRIGGER;
+    inputs[SAH_TRIGGER].text_box = (Text_Box *) graphics_objects["trigger text box"];
+    inputs[SAH_TRIGGER].toggle_button = (Toggle_Button *) graphics_objects["trigger toggle button"];
 }
 
 /*
@@ -217,7 +342,7 @@ void Sah::initialize_unique_graphics_objects()
  */
 void Sah::reset_sampler()
 {
-    time_to_next_sample = 0;
+    samples_to_next_sample = 0;
 
     std::cout << name << " sampler reset" << std::endl;
 }
@@ -227,3 +352,12 @@ std::string Sah::get_unique_text_representation()
     return "";
 }
 
+/*
+ * Return how many inputs are saved in a text representation with the given
+ * number of lines, patches saved before there was a trigger input only have
+ * the signal and hold time.
+ */
+unsigned int Sah::saved_inputs(unsigned int num_lines)
+{
+    return std::min((unsigned int) inputs.size(), num_lines / 2);
+}
@@ -1,9 +1,8 @@
 /*
  * Matthew Diamond 2015
- * The multiplier module. This module applies control values
- * to another signal. Essentially, it just multiplies two signals,
- * but it is also possible to specify an amount to apply for the
- * control values signal.
+ * The sample and hold module. This module samples a signal and holds that
+ * value for the hold time, or, while a trigger signal is connected, until the
+ * next rising edge of the trigger signal.
  */
 
 #ifndef MSS_SAH_HPP
@@ -26,24 +25,35 @@ public:
     enum SahDependencies
     {
         SAH_SIGNAL = 0,
-        SAH_HOLD_TIME
+        SAH_HOLD_TIME,
+        SAH_TRIGGER
     };
 
+    // The sample being held, the number of samples until the next one is
+    // taken, and the last sample of the trigger signal
     double sample;
-    double time_to_next_sample;
+    double samples_to_next_sample;
+    float previous_trigger;
 
     // Constructor and destructor
     Sah();
     virtual ~Sah();
 
     // Member functions, explained in Module.hpp
-    virtual void process();
+    virtual void process(unsigned int);
+    virtual bool reads_control_rate(unsigned int);
     virtual bool handle_event(Graphics_Object *);
     virtual void calculate_unique_graphics_object_locations();
     virtual void initialize_unique_graphics_objects();
     virtual std::string get_unique_text_representation();
+    virtual unsigned int saved_inputs(unsigned int);
 
     // Member functions particular to this module
+    //   Fill the output buffer, given the signal to sample if it is live,
+    //   holding each sample for a constant hold time, or until the next
+    //   rising edge of the trigger signal
+    void process_held(const float *, unsigned int);
+    void process_triggered(const float *, unsigned int);
     //   Reset phase
     void reset_sampler();
 };
@@ -8,8 +8,11 @@
  ************/
 
 // Included libraries
+#include <algorithm>
 #include <cmath>
+#include <complex>
 #include <iostream>
+#include <utility>
 #include <vector>
 
 // Included SDL components
@@ -18,6 +21,7 @@
 
 // Included files
 #include "main.hpp"
+#include "populate_wavetables.hpp"
 
 // Included modules classes
 #include "Modules/Oscillator.hpp"
@@ -27,84 +31,128 @@
  ********************/
 
 /*
- * Populate the sine wave wavetable with a 1 second long, 1 Hz waveform.
+ * Return the highest frequency that the wavetable for the given octave is used
+ * for. The lowest octave is used for everything up to an octave above the
+ * lowest frequency that oscillators read wavetables at, and each octave after
+ * it for frequencies up to twice as high.
  */
-void populate_sin()
+double octave_top(unsigned int octave)
 {
-    for(unsigned int i = 0; i < WAVETABLES[Oscillator::SIN].size(); i ++)
-    {
-        WAVETABLES[Oscillator::SIN][i] = sin(((float) i / SAMPLE_RATE) * (2 * M_PI));
-    }
+    return WAVETABLE_MIN_FREQUENCY * pow(2, octave + 1);
 }
 
 /*
- * Populate the triangle wave wavetable with a 1 second long, 1 Hz waveform.
+ * Return the amplitude of the sine wave at the given harmonic in the given
+ * waveform type, matching the shape of the waveforms produced by the
+ * oscillator module at low frequencies.
  */
-void populate_tri()
+double harmonic_amplitude(unsigned int waveform_type, unsigned int harmonic)
 {
-    for(unsigned int i = 0; i < WAVETABLES[Oscillator::TRI].size(); i ++)
+    switch(waveform_type)
     {
-        float one_fourth = (WAVETABLES[Oscillator::TRI].size() / 4);
-        float half = (WAVETABLES[Oscillator::TRI].size() / 2);
-        float three_fourths = one_fourth * 3;
-
-        if(i < one_fourth)
-        {
-            WAVETABLES[Oscillator::TRI][i] = i / one_fourth;
-        }
-        else if(i < half)
-        {
-            WAVETABLES[Oscillator::TRI][i] = (1 - ((i - one_fourth) / (one_fourth)));
-        }
-        else if(i < three_fourths)
-        {
-            WAVETABLES[Oscillator::TRI][i] = ((i - half) / one_fourth) * -1;
-        }
-        else
-        {
-            WAVETABLES[Oscillator::TRI][i] = ((1 - ((i - three_fourths) /
-                                                    (one_fourth))) * -1);
-        }
+    case Oscillator::SIN:
+        return harmonic == 1 ? 1 : 0;
+    case Oscillator::TRI:
+        if(harmonic % 2 == 0)
+            return 0;
+        return ((harmonic / 2) % 2 == 0 ? 8 : -8)
+               / (M_PI * M_PI * harmonic * harmonic);
+    case Oscillator::SAW:
+        return -2 / (M_PI * harmonic);
+    case Oscillator::SQR:
+        if(harmonic % 2 == 0)
+            return 0;
+        return 4 / (M_PI * harmonic);
     }
+
+    return 0;
 }
 
 /*
- * Populate the saw wave wavetable with a 1 second long, 1 Hz waveform.
+ * Transform a spectrum in place into the signal it describes using the
+ * radix-2 fast Fourier transform, without dividing by the number of bins,
+ * which must be a power of two.
  */
-void populate_saw()
+void inverse_fft(std::vector<std::complex<double>> *bins)
 {
-    for(unsigned int i = 0; i < WAVETABLES[Oscillator::SAW].size(); i ++)
+    unsigned int num_bins = bins->size();
+
+    // Put the bins in bit reversed order
+    for(unsigned int i = 1, j = 0; i < num_bins; i ++)
     {
-        float half = (WAVETABLES[Oscillator::SAW].size() / 2);
+        unsigned int bit = num_bins >> 1;
+        for(; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
 
-        if(i < half)
+        if(i < j)
         {
-            WAVETABLES[Oscillator::SAW][i] = -1 * (1 - (i / half));
+            std::swap((*bins)[i], (*bins)[j]);
         }
-        else
+    }
+
+    // Combine pairs of transforms into transforms twice as long
+    for(unsigned int length = 2; length <= num_bins; length <<= 1)
+    {
+        std::complex<double> step = std::polar(1.0, 2 * M_PI / length);
+        for(unsigned int i = 0; i < num_bins; i += length)
         {
-            WAVETABLES[Oscillator::SAW][i] = -1 * (0 - ((i - half) / half));
+            std::complex<double> twiddle(1, 0);
+            for(unsigned int j = 0; j < length / 2; j ++)
+            {
+                std::complex<double> even = (*bins)[i + j];
+                std::complex<double> odd = (*bins)[i + j + length / 2]
+                                           * twiddle;
+                (*bins)[i + j] = even + odd;
+                (*bins)[i + j + length / 2] = even - odd;
+                twiddle *= step;
+            }
         }
     }
 }
 
 /*
- * Populate the square wave wavetable with a 1 second long, 1 Hz waveform.
+ * Populate the wavetables for the given waveform type. The wavetable for each
+ * octave holds only the harmonics that stay below the Nyquist frequency at
+ * the top of that octave.
  */
-void populate_sqr()
+void populate_waveform(unsigned int waveform_type)
 {
-    for(unsigned int i = 0; i < WAVETABLES[Oscillator::SQR].size(); i ++)
+    std::vector<std::complex<double>> bins(WAVETABLE_SIZE);
+
+    for(unsigned int octave = 0; octave < WAVETABLE_OCTAVES; octave ++)
     {
-        float half = (WAVETABLES[Oscillator::SQR].size() / 2);
+        std::vector<float> &wavetable = WAVETABLES[waveform_type][octave];
+        unsigned int num_harmonics =
+            (SAMPLE_RATE / 2) / octave_top(octave);
+        if(num_harmonics < 1)
+        {
+            num_harmonics = 1;
+        }
+        else if(num_harmonics > WAVETABLE_SIZE / 2 - 1)
+        {
+            num_harmonics = WAVETABLE_SIZE / 2 - 1;
+        }
 
-        if(i < half)
+        // Each sine wave is split between its positive and negative
+        // frequency bins
+        std::fill(bins.begin(), bins.end(), std::complex<double>(0, 0));
+        for(unsigned int i = 1; i <= num_harmonics; i ++)
         {
-            WAVETABLES[Oscillator::SQR][i] = 1;
+            double amplitude = harmonic_amplitude(waveform_type, i);
+            bins[i] = std::complex<double>(0, -amplitude / 2);
+            bins[WAVETABLE_SIZE - i] =
+                std::complex<double>(0, amplitude / 2);
         }
-        else
+        inverse_fft(&bins);
+
+        for(unsigned int i = 0; i < WAVETABLE_SIZE; i ++)
         {
-            WAVETABLES[Oscillator::SQR][i] = -1;
+            wavetable[i] = bins[i].real();
         }
+        wavetable[WAVETABLE_SIZE] = wavetable[0];
     }
 }
 
@@ -113,15 +161,34 @@ void populate_sqr()
  ***********************/
 
 /*
- * Populate all wavetables with 1 second long, 1 Hz waveforms.
+ * Populate all wavetables with one period of each waveform for every octave.
  */
 void populate_wavetables()
 {
-    populate_sin();
-    populate_tri();
-    populate_saw();
-    populate_sqr();
+    for(unsigned int i = Oscillator::SIN; i <= Oscillator::SQR; i ++)
+    {
+        populate_waveform(i);
+    }
 
     std::cout << "Wavetables populated" << std::endl;
 }
 
+
+/*
+ * Return the wavetable of the given waveform type for the octave that the
+ * given frequency falls in, so that none of its harmonics go above the
+ * Nyquist frequency.
+ */
+const float *find_wavetable(unsigned int waveform_type, double frequency)
+{
+    unsigned int octave = 0;
+
+    frequency = fabs(frequency);
+    while(octave < WAVETABLE_OCTAVES - 1
+          && frequency > octave_top(octave))
+    {
+        octave ++;
+    }
+
+    return &WAVETABLES[waveform_type][octave][0];
+}
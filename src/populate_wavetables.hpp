@@ -18,6 +18,8 @@
 
 // Populate wavetables
 void populate_wavetables();
+// Find the wavetable for a waveform type and frequency
+const float *find_wavetable(unsigned int, double);
 
 #endif
 
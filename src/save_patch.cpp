@@ -31,6 +31,10 @@
  * SAVE PATCH *
  **************/
 
+/*
+ * Save the text representation of every module to the given file, output
+ * module first, in the format read by load_patch().
+ */
 void save_patch(std::string filename)
 {
     std::ofstream outfile;
@@ -39,10 +43,17 @@ void save_patch(std::string filename)
 
     if(outfile.is_open())
     {
+        for(unsigned int i = 0; i < MODULES.size(); i ++)
+        {
+            if(MODULES[i] != NULL)
+            {
+                outfile << MODULES[i]->get_text_representation();
+            }
+        }
+
         outfile.close();
 
-        /* std::cout << "Patch " << filename << " saved" << std::endl; */
-        std::cout << "Patch saving not implemented" << std::endl;
+        std::cout << "Patch " << filename << " saved" << std::endl;
     }
     else
     {
@@ -0,0 +1,2143 @@
+/*
+ * Matthew Diamond 2016
+ * Signal kernels, and the selection of which implementations of them to use.
+ * Vectorized implementations are compiled for their instruction set with
+ * function target attributes, so the rest of the program is still built for
+ * any processor, and only the kernels selected at startup ever run.
+ */
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Vectorized kernels are only available on x86 processors
+#if defined(__x86_64__) || defined(__i386__)
+#define MSS_X86_SIGNAL_KERNELS
+#include <immintrin.h>
+#endif
+
+// Included files
+#include "signal_kernels.hpp"
+
+/*********************
+ * KERNEL TABLE TYPE *
+ *********************/
+
+// A complete set of kernels, all using the same instruction set
+struct Kernels
+{
+    const char *name;
+    void (*clip)(float *, unsigned int, float, float);
+    void (*scale)(float *, unsigned int, float, float, float, float);
+    void (*add)(const float *, const float *, float *, unsigned int);
+    void (*multiply)(const float *, const float *, float *, unsigned int);
+    void (*multiply_constant)(const float *, float, float *, unsigned int);
+    void (*multiply_add)(const float *, const float *, float *, unsigned int);
+    void (*multiply_add_constant)(const float *, float, float *,
+                                  unsigned int);
+    void (*mix)(const float * const *, const float *, unsigned int, float *,
+                unsigned int);
+    void (*interleave)(const float *, const float *, float *, unsigned int);
+    void (*sin)(const uint32_t *, float *, unsigned int);
+    void (*tri)(const uint32_t *, float *, unsigned int);
+    void (*saw)(const uint32_t *, float *, unsigned int);
+    void (*sqr)(const uint32_t *, float, float *, unsigned int);
+    void (*sqr_span)(const uint32_t *, const float *, float *, unsigned int);
+    void (*biquad)(const float *, float *, unsigned int, unsigned int, float *,
+                   const float *, float *);
+    void (*noise)(uint32_t *, float, float, float *, unsigned int);
+    void (*ramp)(float, float, float *, unsigned int);
+    void (*curve)(float, float, float, float *, unsigned int);
+    unsigned int (*rising_edge)(const float *, float, unsigned int);
+    bool (*constant)(const float *, unsigned int);
+};
+
+/**********************
+ * WAVEFORM CONSTANTS *
+ **********************/
+
+// Converts a fixed point phase read as a signed integer to a phase from -.5 to
+// .5, and read as a signed integer offset by half a period to a saw wave from
+// -1 to 1
+static const float SIGNED_PHASE_SCALE = 1.0f / 4294967296.0f;
+static const float SAW_SCALE = 1.0f / 2147483648.0f;
+static const uint32_t HALF_PERIOD = 0x80000000u;
+
+// A sine wave is calculated from its first quarter period with an odd
+// polynomial in the phase, fitted for the least maximum error on that quarter.
+// Every sample is within 2e-7 of the true sine.
+static const float SIN_C1 = 6.283185005f;
+static const float SIN_C3 = -41.34165573f;
+static const float SIN_C5 = 81.60100555f;
+static const float SIN_C7 = -76.54978943f;
+static const float SIN_C9 = 39.53673172f;
+
+/*******************
+ * NOISE CONSTANTS *
+ *******************/
+
+// Noise comes from xoshiro128+ generators running side by side, one per lane,
+// so that every instruction set produces the same noise. Random words are
+// scaled to the range with a separate multiply and add, never a fused one,
+// which would round differently. The state of the generators is their first
+// words, then their second words, and so on.
+static const unsigned int NOISE_LANES = NOISE_STATE_SIZE / 4;
+
+// Converts the top 24 bits of a random word to a number from 0 up to 1
+static const float NOISE_SCALE = 1.0f / 16777216.0f;
+
+/*****************
+ * PLAIN KERNELS *
+ *****************/
+
+// The plain kernels also process whatever samples are left over at the end
+// of a span after the vectorized kernels are done with it
+
+static void clip_plain(float *buffer, unsigned int num_samples, float min,
+                       float max)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        if(buffer[i] > max)
+        {
+            buffer[i] = max;
+        }
+        else if(buffer[i] < min)
+        {
+            buffer[i] = min;
+        }
+    }
+}
+
+static void scale_plain(float *buffer, unsigned int num_samples,
+                        float original_low, float original_high, float low,
+                        float high)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        buffer[i] = (buffer[i] - original_low)
+                    / (original_high - original_low);
+        buffer[i] *= high - low;
+        buffer[i] += low;
+    }
+}
+
+static void add_plain(const float *src1, const float *src2, float *dst,
+                      unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        dst[i] = src1[i] + src2[i];
+    }
+}
+
+static void multiply_plain(const float *src1, const float *src2, float *dst,
+                           unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        dst[i] = src1[i] * src2[i];
+    }
+}
+
+static void multiply_constant_plain(const float *src, float val, float *dst,
+                                    unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        dst[i] = src[i] * val;
+    }
+}
+
+static void multiply_add_plain(const float *src1, const float *src2,
+                               float *dst, unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        dst[i] += src1[i] * src2[i];
+    }
+}
+
+static void multiply_add_constant_plain(const float *src, float val,
+                                        float *dst, unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        dst[i] += src[i] * val;
+    }
+}
+
+// Mix only the samples from first up to but not including last
+static void mix_plain_range(const float * const *srcs, const float *gains,
+                            unsigned int num_srcs, float *dst,
+                            unsigned int first, unsigned int last)
+{
+    for(unsigned int i = first; i < last; i ++)
+    {
+        float sample = 0;
+        for(unsigned int j = 0; j < num_srcs; j ++)
+        {
+            sample += srcs[j][i] * gains[j];
+        }
+        dst[i] = sample;
+    }
+}
+
+static void mix_plain(const float * const *srcs, const float *gains,
+                      unsigned int num_srcs, float *dst,
+                      unsigned int num_samples)
+{
+    mix_plain_range(srcs, gains, num_srcs, dst, 0, num_samples);
+}
+
+static void interleave_plain(const float *left, const float *right,
+                             float *dst, unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        dst[i * 2] = left[i];
+        dst[i * 2 + 1] = right[i];
+    }
+}
+
+// Waveforms are folded into the first quarter of a period, the phase is read
+// as going from -.5 to .5 so that the second half of the period is the first
+// half negated
+static void sin_plain(const uint32_t *phases, float *dst,
+                      unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        float phase = (int32_t) phases[i] * SIGNED_PHASE_SCALE;
+        float quarter = .25f - fabsf(.25f - fabsf(phase));
+        float quarter_squared = quarter * quarter;
+        float sample = quarter * (SIN_C1 + quarter_squared
+                                  * (SIN_C3 + quarter_squared
+                                     * (SIN_C5 + quarter_squared
+                                        * (SIN_C7 + quarter_squared
+                                           * SIN_C9))));
+        dst[i] = phase < 0 ? -sample : sample;
+    }
+}
+
+static void tri_plain(const uint32_t *phases, float *dst,
+                      unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        float phase = (int32_t) phases[i] * SIGNED_PHASE_SCALE;
+        float sample = 4 * (.25f - fabsf(.25f - fabsf(phase)));
+        dst[i] = phase < 0 ? -sample : sample;
+    }
+}
+
+static void saw_plain(const uint32_t *phases, float *dst,
+                      unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        dst[i] = (int32_t) (phases[i] ^ HALF_PERIOD) * SAW_SCALE;
+    }
+}
+
+// A square wave is 1 wherever the saw wave is below where it is at the pulse
+// width
+static void sqr_plain(const uint32_t *phases, float pulse_width, float *dst,
+                      unsigned int num_samples)
+{
+    float threshold = 2 * pulse_width - 1;
+
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        float saw = (int32_t) (phases[i] ^ HALF_PERIOD) * SAW_SCALE;
+        dst[i] = saw < threshold ? 1 : -1;
+    }
+}
+
+static void sqr_span_plain(const uint32_t *phases, const float *pulse_widths,
+                           float *dst, unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        float saw = (int32_t) (phases[i] ^ HALF_PERIOD) * SAW_SCALE;
+        dst[i] = saw < 2 * pulse_widths[i] - 1 ? 1 : -1;
+    }
+}
+
+// The coefficients of a biquad cascade are stored one after another, b0, b1,
+// b2, a1, then a2, and its history z1 then z2, each with one lane per stage,
+// for four stages. Stages are transposed direct form II biquads.
+static const unsigned int BIQUAD_LANES = 4;
+
+// Filter one sample through one stage of a biquad cascade, then move that
+// stage's coefficients along by a sample
+static inline float biquad_stage(unsigned int stage, float x,
+                                 float *coefficients, const float *increments,
+                                 float *history)
+{
+    float y = coefficients[stage] * x + history[stage];
+
+    history[stage] = coefficients[BIQUAD_LANES + stage] * x
+                     - coefficients[3 * BIQUAD_LANES + stage] * y
+                     + history[BIQUAD_LANES + stage];
+    history[BIQUAD_LANES + stage] = coefficients[2 * BIQUAD_LANES + stage] * x
+                                    - coefficients[4 * BIQUAD_LANES + stage]
+                                    * y;
+    for(unsigned int j = 0; j < 5; j ++)
+    {
+        coefficients[j * BIQUAD_LANES + stage] +=
+            increments[j * BIQUAD_LANES + stage];
+    }
+
+    return y;
+}
+
+static void biquad_plain(const float *src, float *dst,
+                         unsigned int num_samples, unsigned int num_stages,
+                         float *coefficients, const float *increments,
+                         float *history)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        float sample = src[i];
+        for(unsigned int j = 0; j < num_stages; j ++)
+        {
+            sample = biquad_stage(j, sample, coefficients, increments,
+                                  history);
+        }
+        dst[i] = sample;
+    }
+}
+
+// Move every generator on by a step, writing one random word per lane
+static inline void noise_step_plain(uint32_t *state, uint32_t *words)
+{
+    uint32_t *s0 = state;
+    uint32_t *s1 = state + NOISE_LANES;
+    uint32_t *s2 = state + 2 * NOISE_LANES;
+    uint32_t *s3 = state + 3 * NOISE_LANES;
+
+    for(unsigned int j = 0; j < NOISE_LANES; j ++)
+    {
+        uint32_t t = s1[j] << 9;
+
+        words[j] = s0[j] + s3[j];
+        s2[j] ^= s0[j];
+        s3[j] ^= s1[j];
+        s1[j] ^= s2[j];
+        s0[j] ^= s3[j];
+        s2[j] ^= t;
+        s3[j] = (s3[j] << 11) | (s3[j] >> 21);
+    }
+}
+
+// Every step of the generators makes NOISE_LANES samples, the rest of a step
+// that runs past the end of the span is thrown away
+static void noise_plain(uint32_t *state, float low, float high, float *dst,
+                        unsigned int num_samples)
+{
+    float scale = (high - low) * NOISE_SCALE;
+    uint32_t words[NOISE_LANES];
+
+    for(unsigned int i = 0; i < num_samples; i += NOISE_LANES)
+    {
+        noise_step_plain(state, words);
+        for(unsigned int j = 0; j < NOISE_LANES && i + j < num_samples; j ++)
+        {
+            dst[i + j] = low + (words[j] >> 8) * scale;
+        }
+    }
+}
+
+// Every sample of a ramp is calculated from the start, so that rounding never
+// builds up along it
+static void ramp_plain(float start, float increment, float *dst,
+                       unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        dst[i] = start + i * increment;
+    }
+}
+
+static void curve_plain(float target, float start, float ratio, float *dst,
+                        unsigned int num_samples)
+{
+    float distance = start - target;
+
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        dst[i] = target + distance;
+        distance *= ratio;
+    }
+}
+
+// A rising edge is a sample above 0 right after one at or below 0
+static unsigned int rising_edge_plain(const float *src, float previous,
+                                      unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        if(previous <= 0 && src[i] > 0)
+        {
+            return i;
+        }
+        previous = src[i];
+    }
+
+    return num_samples;
+}
+
+// A span is constant if every sample equals the first, which is never true of
+// a NaN
+static bool constant_plain(const float *src, unsigned int num_samples)
+{
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        if(src[i] != src[0])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static const Kernels PLAIN_KERNELS =
+{
+    "plain",
+    clip_plain,
+    scale_plain,
+    add_plain,
+    multiply_plain,
+    multiply_constant_plain,
+    multiply_add_plain,
+    multiply_add_constant_plain,
+    mix_plain,
+    interleave_plain,
+    sin_plain,
+    tri_plain,
+    saw_plain,
+    sqr_plain,
+    sqr_span_plain,
+    biquad_plain,
+    noise_plain,
+    ramp_plain,
+    curve_plain,
+    rising_edge_plain,
+    constant_plain
+};
+
+#ifdef MSS_X86_SIGNAL_KERNELS
+
+/****************
+ * SSE2 KERNELS *
+ ****************/
+
+#define SSE2 __attribute__((target("sse2")))
+
+SSE2 static void clip_sse2(float *buffer, unsigned int num_samples, float min,
+                           float max)
+{
+    __m128 min_vector = _mm_set1_ps(min);
+    __m128 max_vector = _mm_set1_ps(max);
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        __m128 samples = _mm_loadu_ps(buffer + i);
+        samples = _mm_min_ps(_mm_max_ps(samples, min_vector), max_vector);
+        _mm_storeu_ps(buffer + i, samples);
+    }
+
+    clip_plain(buffer + i, num_samples - i, min, max);
+}
+
+SSE2 static void scale_sse2(float *buffer, unsigned int num_samples,
+                            float original_low, float original_high,
+                            float low, float high)
+{
+    __m128 original_low_vector = _mm_set1_ps(original_low);
+    __m128 original_range = _mm_set1_ps(original_high - original_low);
+    __m128 low_vector = _mm_set1_ps(low);
+    __m128 range = _mm_set1_ps(high - low);
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        __m128 samples = _mm_loadu_ps(buffer + i);
+        samples = _mm_div_ps(_mm_sub_ps(samples, original_low_vector),
+                             original_range);
+        samples = _mm_add_ps(_mm_mul_ps(samples, range), low_vector);
+        _mm_storeu_ps(buffer + i, samples);
+    }
+
+    scale_plain(buffer + i, num_samples - i, original_low, original_high, low,
+                high);
+}
+
+SSE2 static void add_sse2(const float *src1, const float *src2, float *dst,
+                          unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(src1 + i),
+                                          _mm_loadu_ps(src2 + i)));
+    }
+
+    add_plain(src1 + i, src2 + i, dst + i, num_samples - i);
+}
+
+SSE2 static void multiply_sse2(const float *src1, const float *src2,
+                               float *dst, unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src1 + i),
+                                          _mm_loadu_ps(src2 + i)));
+    }
+
+    multiply_plain(src1 + i, src2 + i, dst + i, num_samples - i);
+}
+
+SSE2 static void multiply_constant_sse2(const float *src, float val,
+                                        float *dst, unsigned int num_samples)
+{
+    __m128 val_vector = _mm_set1_ps(val);
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), val_vector));
+    }
+
+    multiply_constant_plain(src + i, val, dst + i, num_samples - i);
+}
+
+SSE2 static void multiply_add_sse2(const float *src1, const float *src2,
+                                   float *dst, unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        __m128 product = _mm_mul_ps(_mm_loadu_ps(src1 + i),
+                                    _mm_loadu_ps(src2 + i));
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), product));
+    }
+
+    multiply_add_plain(src1 + i, src2 + i, dst + i, num_samples - i);
+}
+
+SSE2 static void multiply_add_constant_sse2(const float *src, float val,
+                                            float *dst,
+                                            unsigned int num_samples)
+{
+    __m128 val_vector = _mm_set1_ps(val);
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        __m128 product = _mm_mul_ps(_mm_loadu_ps(src + i), val_vector);
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), product));
+    }
+
+    multiply_add_constant_plain(src + i, val, dst + i, num_samples - i);
+}
+
+SSE2 static void mix_sse2(const float * const *srcs, const float *gains,
+                          unsigned int num_srcs, float *dst,
+                          unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        __m128 sum = _mm_setzero_ps();
+        for(unsigned int j = 0; j < num_srcs; j ++)
+        {
+            __m128 product = _mm_mul_ps(_mm_loadu_ps(srcs[j] + i),
+                                        _mm_set1_ps(gains[j]));
+            sum = _mm_add_ps(sum, product);
+        }
+        _mm_storeu_ps(dst + i, sum);
+    }
+
+    mix_plain_range(srcs, gains, num_srcs, dst, i, num_samples);
+}
+
+SSE2 static void interleave_sse2(const float *left, const float *right,
+                                 float *dst, unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        __m128 left_samples = _mm_loadu_ps(left + i);
+        __m128 right_samples = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(dst + i * 2, _mm_unpacklo_ps(left_samples,
+                                                   right_samples));
+        _mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(left_samples,
+                                                       right_samples));
+    }
+
+    interleave_plain(left + i, right + i, dst + i * 2, num_samples - i);
+}
+
+// Fold phases read as going from -.5 to .5 into the first quarter of a
+// period, and return their signs separately
+SSE2 static inline __m128 fold_phases_sse2(const uint32_t *phases,
+                                           __m128 *signs)
+{
+    __m128 sign_mask = _mm_set1_ps(-0.0f);
+    __m128 quarter = _mm_set1_ps(.25f);
+    __m128 phase = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(
+                                  (const __m128i *) phases)),
+                              _mm_set1_ps(SIGNED_PHASE_SCALE));
+
+    *signs = _mm_and_ps(phase, sign_mask);
+    phase = _mm_andnot_ps(sign_mask, phase);
+    return _mm_sub_ps(quarter, _mm_andnot_ps(sign_mask,
+                                             _mm_sub_ps(quarter, phase)));
+}
+
+SSE2 static inline __m128 saw_sse2(const uint32_t *phases)
+{
+    __m128i offset = _mm_xor_si128(_mm_loadu_si128((const __m128i *) phases),
+                                   _mm_set1_epi32(HALF_PERIOD));
+    return _mm_mul_ps(_mm_cvtepi32_ps(offset), _mm_set1_ps(SAW_SCALE));
+}
+
+SSE2 static void sin_sse2(const uint32_t *phases, float *dst,
+                          unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        __m128 signs;
+        __m128 quarter = fold_phases_sse2(phases + i, &signs);
+        __m128 quarter_squared = _mm_mul_ps(quarter, quarter);
+        __m128 sample = _mm_set1_ps(SIN_C9);
+        sample = _mm_add_ps(_mm_mul_ps(sample, quarter_squared),
+                            _mm_set1_ps(SIN_C7));
+        sample = _mm_add_ps(_mm_mul_ps(sample, quarter_squared),
+                            _mm_set1_ps(SIN_C5));
+        sample = _mm_add_ps(_mm_mul_ps(sample, quarter_squared),
+                            _mm_set1_ps(SIN_C3));
+        sample = _mm_add_ps(_mm_mul_ps(sample, quarter_squared),
+                            _mm_set1_ps(SIN_C1));
+        sample = _mm_mul_ps(sample, quarter);
+        _mm_storeu_ps(dst + i, _mm_or_ps(sample, signs));
+    }
+
+    sin_plain(phases + i, dst + i, num_samples - i);
+}
+
+SSE2 static void tri_sse2(const uint32_t *phases, float *dst,
+                          unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        __m128 signs;
+        __m128 quarter = fold_phases_sse2(phases + i, &signs);
+        _mm_storeu_ps(dst + i, _mm_or_ps(_mm_mul_ps(quarter,
+                                                    _mm_set1_ps(4)),
+                                         signs));
+    }
+
+    tri_plain(phases + i, dst + i, num_samples - i);
+}
+
+SSE2 static void saw_sse2(const uint32_t *phases, float *dst,
+                          unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        _mm_storeu_ps(dst + i, saw_sse2(phases + i));
+    }
+
+    saw_plain(phases + i, dst + i, num_samples - i);
+}
+
+SSE2 static inline __m128 sqr_sse2(const uint32_t *phases, __m128 threshold)
+{
+    __m128 below = _mm_cmplt_ps(saw_sse2(phases), threshold);
+    return _mm_or_ps(_mm_and_ps(below, _mm_set1_ps(1)),
+                     _mm_andnot_ps(below, _mm_set1_ps(-1)));
+}
+
+SSE2 static void sqr_sse2(const uint32_t *phases, float pulse_width,
+                          float *dst, unsigned int num_samples)
+{
+    __m128 threshold = _mm_set1_ps(2 * pulse_width - 1);
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        _mm_storeu_ps(dst + i, sqr_sse2(phases + i, threshold));
+    }
+
+    sqr_plain(phases + i, pulse_width, dst + i, num_samples - i);
+}
+
+SSE2 static void sqr_span_sse2(const uint32_t *phases,
+                               const float *pulse_widths, float *dst,
+                               unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        __m128 threshold = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(pulse_widths
+                                                              + i),
+                                                 _mm_loadu_ps(pulse_widths
+                                                              + i)),
+                                      _mm_set1_ps(1));
+        _mm_storeu_ps(dst + i, sqr_sse2(phases + i, threshold));
+    }
+
+    sqr_span_plain(phases + i, pulse_widths + i, dst + i, num_samples - i);
+}
+
+// Every stage of the cascade runs side by side in its own lane, one sample
+// behind the stage before it. Until the last stage has caught up with the
+// first at the start of the span, and after the first stage has run out of
+// samples at the end of it, the stages that have a sample to work on are run
+// one at a time. Stages past the last one must have coefficients of 0.
+SSE2 static void biquad_sse2(const float *src, float *dst,
+                             unsigned int num_samples,
+                             unsigned int num_stages, float *coefficients,
+                             const float *increments, float *history)
+{
+    unsigned int last = num_stages - 1;
+    float outputs[BIQUAD_LANES] __attribute__((aligned(16))) = {0, 0, 0, 0};
+
+    // A single stage has nothing to run beside it
+    if(num_stages < 2 || num_samples < num_stages)
+    {
+        biquad_plain(src, dst, num_samples, num_stages, coefficients,
+                     increments, history);
+        return;
+    }
+
+    // Start each stage in turn, each stage reads what the stage before it
+    // output on the previous step, so later stages go first
+    for(unsigned int i = 0; i < last; i ++)
+    {
+        for(unsigned int j = i + 1; j -- > 0;)
+        {
+            outputs[j] = biquad_stage(j, j == 0 ? src[i] : outputs[j - 1],
+                                      coefficients, increments, history);
+        }
+    }
+
+    __m128 b0 = _mm_loadu_ps(coefficients);
+    __m128 b1 = _mm_loadu_ps(coefficients + BIQUAD_LANES);
+    __m128 b2 = _mm_loadu_ps(coefficients + 2 * BIQUAD_LANES);
+    __m128 a1 = _mm_loadu_ps(coefficients + 3 * BIQUAD_LANES);
+    __m128 a2 = _mm_loadu_ps(coefficients + 4 * BIQUAD_LANES);
+    __m128 z1 = _mm_loadu_ps(history);
+    __m128 z2 = _mm_loadu_ps(history + BIQUAD_LANES);
+    __m128 y = _mm_load_ps(outputs);
+
+    for(unsigned int i = last; i < num_samples; i ++)
+    {
+        // Shift every stage's output up a lane, and read the next sample into
+        // the first
+        __m128 x = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(y), 4));
+        x = _mm_move_ss(x, _mm_set_ss(src[i]));
+
+        y = _mm_add_ps(_mm_mul_ps(b0, x), z1);
+        z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), z2);
+        z2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+
+        b0 = _mm_add_ps(b0, _mm_loadu_ps(increments));
+        b1 = _mm_add_ps(b1, _mm_loadu_ps(increments + BIQUAD_LANES));
+        b2 = _mm_add_ps(b2, _mm_loadu_ps(increments + 2 * BIQUAD_LANES));
+        a1 = _mm_add_ps(a1, _mm_loadu_ps(increments + 3 * BIQUAD_LANES));
+        a2 = _mm_add_ps(a2, _mm_loadu_ps(increments + 4 * BIQUAD_LANES));
+
+        _mm_store_ps(outputs, y);
+        dst[i - last] = outputs[last];
+    }
+
+    _mm_storeu_ps(coefficients, b0);
+    _mm_storeu_ps(coefficients + BIQUAD_LANES, b1);
+    _mm_storeu_ps(coefficients + 2 * BIQUAD_LANES, b2);
+    _mm_storeu_ps(coefficients + 3 * BIQUAD_LANES, a1);
+    _mm_storeu_ps(coefficients + 4 * BIQUAD_LANES, a2);
+    _mm_storeu_ps(history, z1);
+    _mm_storeu_ps(history + BIQUAD_LANES, z2);
+
+    // Finish each stage in turn, earlier stages run out of samples first
+    for(unsigned int i = 1; i <= last; i ++)
+    {
+        for(unsigned int j = last; j >= i; j --)
+        {
+            outputs[j] = biquad_stage(j, outputs[j - 1], coefficients,
+                                      increments, history);
+        }
+        dst[num_samples - last + i - 1] = outputs[last];
+    }
+}
+
+// Each group of four generators is kept in registers while it makes its
+// samples for every whole step in the span
+SSE2 static void noise_sse2(uint32_t *state, float low, float high,
+                            float *dst, unsigned int num_samples)
+{
+    __m128 low_vector = _mm_set1_ps(low);
+    __m128 scale = _mm_set1_ps((high - low) * NOISE_SCALE);
+    unsigned int steps = num_samples / NOISE_LANES;
+
+    for(unsigned int j = 0; j < NOISE_LANES; j += 4)
+    {
+        __m128i *lanes = (__m128i *) (state + j);
+        __m128i s0 = _mm_loadu_si128(lanes);
+        __m128i s1 = _mm_loadu_si128(lanes + NOISE_LANES / 4);
+        __m128i s2 = _mm_loadu_si128(lanes + NOISE_LANES / 2);
+        __m128i s3 = _mm_loadu_si128(lanes + 3 * NOISE_LANES / 4);
+
+        for(unsigned int i = 0; i < steps; i ++)
+        {
+            __m128i words = _mm_add_epi32(s0, s3);
+            __m128i t = _mm_slli_epi32(s1, 9);
+            s2 = _mm_xor_si128(s2, s0);
+            s3 = _mm_xor_si128(s3, s1);
+            s1 = _mm_xor_si128(s1, s2);
+            s0 = _mm_xor_si128(s0, s3);
+            s2 = _mm_xor_si128(s2, t);
+            s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+            __m128 samples = _mm_cvtepi32_ps(_mm_srli_epi32(words, 8));
+            _mm_storeu_ps(dst + i * NOISE_LANES + j,
+                          _mm_add_ps(low_vector, _mm_mul_ps(samples, scale)));
+        }
+
+        _mm_storeu_si128(lanes, s0);
+        _mm_storeu_si128(lanes + NOISE_LANES / 4, s1);
+        _mm_storeu_si128(lanes + NOISE_LANES / 2, s2);
+        _mm_storeu_si128(lanes + 3 * NOISE_LANES / 4, s3);
+    }
+
+    noise_plain(state, low, high, dst + steps * NOISE_LANES,
+                num_samples - steps * NOISE_LANES);
+}
+
+SSE2 static void ramp_sse2(float start, float increment, float *dst,
+                           unsigned int num_samples)
+{
+    __m128 start_vector = _mm_set1_ps(start);
+    __m128 increment_vector = _mm_set1_ps(increment);
+    __m128 indices = _mm_setr_ps(0, 1, 2, 3);
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        _mm_storeu_ps(dst + i, _mm_add_ps(start_vector,
+                                          _mm_mul_ps(indices,
+                                                     increment_vector)));
+        indices = _mm_add_ps(indices, _mm_set1_ps(4));
+    }
+
+    ramp_plain(start + i * increment, increment, dst + i, num_samples - i);
+}
+
+// Each lane holds the distance to the target one sample further along than
+// the lane before it, and every lane moves four samples along at a time
+SSE2 static void curve_sse2(float target, float start, float ratio,
+                            float *dst, unsigned int num_samples)
+{
+    float distance = start - target;
+    __m128 target_vector = _mm_set1_ps(target);
+    __m128 distances = _mm_setr_ps(distance, distance * ratio,
+                                   distance * ratio * ratio,
+                                   distance * ratio * ratio * ratio);
+    __m128 step = _mm_set1_ps(ratio * ratio * ratio * ratio);
+    unsigned int i = 0;
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        _mm_storeu_ps(dst + i, _mm_add_ps(target_vector, distances));
+        distances = _mm_mul_ps(distances, step);
+    }
+
+    curve_plain(target, target + _mm_cvtss_f32(distances), ratio, dst + i,
+                num_samples - i);
+}
+
+// Every sample after the first is compared with the one before it, read from
+// the span one sample earlier
+SSE2 static unsigned int rising_edge_sse2(const float *src, float previous,
+                                          unsigned int num_samples)
+{
+    __m128 zero = _mm_setzero_ps();
+    unsigned int i = 1;
+
+    if(num_samples == 0 || (previous <= 0 && src[0] > 0))
+    {
+        return 0;
+    }
+
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        int edges = _mm_movemask_ps(
+            _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(src + i - 1), zero),
+                       _mm_cmpgt_ps(_mm_loadu_ps(src + i), zero)));
+        if(edges != 0)
+        {
+            return i + __builtin_ctz(edges);
+        }
+    }
+
+    return i + rising_edge_plain(src + i, src[i - 1], num_samples - i);
+}
+
+SSE2 static bool constant_sse2(const float *src, unsigned int num_samples)
+{
+    __m128 first;
+    unsigned int i = 1;
+
+    if(num_samples == 0)
+    {
+        return true;
+    }
+
+    first = _mm_set1_ps(src[0]);
+    for(; i + 4 <= num_samples; i += 4)
+    {
+        if(_mm_movemask_ps(_mm_cmpneq_ps(_mm_loadu_ps(src + i), first)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return constant_plain(src + i - 1, num_samples - i + 1);
+}
+
+static const Kernels SSE2_KERNELS =
+{
+    "SSE2",
+    clip_sse2,
+    scale_sse2,
+    add_sse2,
+    multiply_sse2,
+    multiply_constant_sse2,
+    multiply_add_sse2,
+    multiply_add_constant_sse2,
+    mix_sse2,
+    interleave_sse2,
+    sin_sse2,
+    tri_sse2,
+    saw_sse2,
+    sqr_sse2,
+    sqr_span_sse2,
+    biquad_sse2,
+    noise_sse2,
+    ramp_sse2,
+    curve_sse2,
+    rising_edge_sse2,
+    constant_sse2
+};
+
+/****************
+ * AVX2 KERNELS *
+ ****************/
+
+// Every processor with AVX2 that is worth selecting it for also has fused
+// multiply-add, both are checked for before these kernels are selected
+#define AVX2 __attribute__((target("avx2,fma")))
+
+AVX2 static void clip_avx2(float *buffer, unsigned int num_samples, float min,
+                           float max)
+{
+    __m256 min_vector = _mm256_set1_ps(min);
+    __m256 max_vector = _mm256_set1_ps(max);
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        __m256 samples = _mm256_loadu_ps(buffer + i);
+        samples = _mm256_min_ps(_mm256_max_ps(samples, min_vector),
+                                max_vector);
+        _mm256_storeu_ps(buffer + i, samples);
+    }
+
+    clip_plain(buffer + i, num_samples - i, min, max);
+}
+
+AVX2 static void scale_avx2(float *buffer, unsigned int num_samples,
+                            float original_low, float original_high,
+                            float low, float high)
+{
+    __m256 original_low_vector = _mm256_set1_ps(original_low);
+    __m256 original_range = _mm256_set1_ps(original_high - original_low);
+    __m256 low_vector = _mm256_set1_ps(low);
+    __m256 range = _mm256_set1_ps(high - low);
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        __m256 samples = _mm256_loadu_ps(buffer + i);
+        samples = _mm256_div_ps(_mm256_sub_ps(samples, original_low_vector),
+                                original_range);
+        samples = _mm256_fmadd_ps(samples, range, low_vector);
+        _mm256_storeu_ps(buffer + i, samples);
+    }
+
+    scale_plain(buffer + i, num_samples - i, original_low, original_high, low,
+                high);
+}
+
+AVX2 static void add_avx2(const float *src1, const float *src2, float *dst,
+                          unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(src1 + i),
+                                                _mm256_loadu_ps(src2 + i)));
+    }
+
+    add_plain(src1 + i, src2 + i, dst + i, num_samples - i);
+}
+
+AVX2 static void multiply_avx2(const float *src1, const float *src2,
+                               float *dst, unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src1 + i),
+                                                _mm256_loadu_ps(src2 + i)));
+    }
+
+    multiply_plain(src1 + i, src2 + i, dst + i, num_samples - i);
+}
+
+AVX2 static void multiply_constant_avx2(const float *src, float val,
+                                        float *dst, unsigned int num_samples)
+{
+    __m256 val_vector = _mm256_set1_ps(val);
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i),
+                                                val_vector));
+    }
+
+    multiply_constant_plain(src + i, val, dst + i, num_samples - i);
+}
+
+AVX2 static void multiply_add_avx2(const float *src1, const float *src2,
+                                   float *dst, unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(_mm256_loadu_ps(src1 + i),
+                                                  _mm256_loadu_ps(src2 + i),
+                                                  _mm256_loadu_ps(dst + i)));
+    }
+
+    multiply_add_plain(src1 + i, src2 + i, dst + i, num_samples - i);
+}
+
+AVX2 static void multiply_add_constant_avx2(const float *src, float val,
+                                            float *dst,
+                                            unsigned int num_samples)
+{
+    __m256 val_vector = _mm256_set1_ps(val);
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(_mm256_loadu_ps(src + i),
+                                                  val_vector,
+                                                  _mm256_loadu_ps(dst + i)));
+    }
+
+    multiply_add_constant_plain(src + i, val, dst + i, num_samples - i);
+}
+
+AVX2 static void mix_avx2(const float * const *srcs, const float *gains,
+                          unsigned int num_srcs, float *dst,
+                          unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        __m256 sum = _mm256_setzero_ps();
+        for(unsigned int j = 0; j < num_srcs; j ++)
+        {
+            sum = _mm256_fmadd_ps(_mm256_loadu_ps(srcs[j] + i),
+                                  _mm256_set1_ps(gains[j]), sum);
+        }
+        _mm256_storeu_ps(dst + i, sum);
+    }
+
+    mix_plain_range(srcs, gains, num_srcs, dst, i, num_samples);
+}
+
+AVX2 static void interleave_avx2(const float *left, const float *right,
+                                 float *dst, unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        __m256 left_samples = _mm256_loadu_ps(left + i);
+        __m256 right_samples = _mm256_loadu_ps(right + i);
+        // Unpacking interleaves within each 128 bit lane, so the lanes have
+        // to be put back in order afterwards
+        __m256 low = _mm256_unpacklo_ps(left_samples, right_samples);
+        __m256 high = _mm256_unpackhi_ps(left_samples, right_samples);
+        _mm256_storeu_ps(dst + i * 2, _mm256_permute2f128_ps(low, high, 0x20));
+        _mm256_storeu_ps(dst + i * 2 + 8,
+                         _mm256_permute2f128_ps(low, high, 0x31));
+    }
+
+    interleave_plain(left + i, right + i, dst + i * 2, num_samples - i);
+}
+
+AVX2 static inline __m256 fold_phases_avx2(const uint32_t *phases,
+                                           __m256 *signs)
+{
+    __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    __m256 quarter = _mm256_set1_ps(.25f);
+    __m256 phase = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256(
+                                     (const __m256i *) phases)),
+                                 _mm256_set1_ps(SIGNED_PHASE_SCALE));
+
+    *signs = _mm256_and_ps(phase, sign_mask);
+    phase = _mm256_andnot_ps(sign_mask, phase);
+    return _mm256_sub_ps(quarter,
+                         _mm256_andnot_ps(sign_mask,
+                                          _mm256_sub_ps(quarter, phase)));
+}
+
+AVX2 static inline __m256 saw_avx2(const uint32_t *phases)
+{
+    __m256i offset = _mm256_xor_si256(_mm256_loadu_si256(
+                                          (const __m256i *) phases),
+                                      _mm256_set1_epi32(HALF_PERIOD));
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(offset),
+                         _mm256_set1_ps(SAW_SCALE));
+}
+
+AVX2 static void sin_avx2(const uint32_t *phases, float *dst,
+                          unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        __m256 signs;
+        __m256 quarter = fold_phases_avx2(phases + i, &signs);
+        __m256 quarter_squared = _mm256_mul_ps(quarter, quarter);
+        __m256 sample = _mm256_set1_ps(SIN_C9);
+        sample = _mm256_fmadd_ps(sample, quarter_squared,
+                                 _mm256_set1_ps(SIN_C7));
+        sample = _mm256_fmadd_ps(sample, quarter_squared,
+                                 _mm256_set1_ps(SIN_C5));
+        sample = _mm256_fmadd_ps(sample, quarter_squared,
+                                 _mm256_set1_ps(SIN_C3));
+        sample = _mm256_fmadd_ps(sample, quarter_squared,
+                                 _mm256_set1_ps(SIN_C1));
+        sample = _mm256_mul_ps(sample, quarter);
+        _mm256_storeu_ps(dst + i, _mm256_or_ps(sample, signs));
+    }
+
+    sin_plain(phases + i, dst + i, num_samples - i);
+}
+
+AVX2 static void tri_avx2(const uint32_t *phases, float *dst,
+                          unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        __m256 signs;
+        __m256 quarter = fold_phases_avx2(phases + i, &signs);
+        _mm256_storeu_ps(dst + i,
+                         _mm256_or_ps(_mm256_mul_ps(quarter,
+                                                    _mm256_set1_ps(4)),
+                                      signs));
+    }
+
+    tri_plain(phases + i, dst + i, num_samples - i);
+}
+
+AVX2 static void saw_avx2(const uint32_t *phases, float *dst,
+                          unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, saw_avx2(phases + i));
+    }
+
+    saw_plain(phases + i, dst + i, num_samples - i);
+}
+
+AVX2 static inline __m256 sqr_avx2(const uint32_t *phases, __m256 threshold)
+{
+    __m256 below = _mm256_cmp_ps(saw_avx2(phases), threshold, _CMP_LT_OQ);
+    return _mm256_blendv_ps(_mm256_set1_ps(-1), _mm256_set1_ps(1), below);
+}
+
+AVX2 static void sqr_avx2(const uint32_t *phases, float pulse_width,
+                          float *dst, unsigned int num_samples)
+{
+    __m256 threshold = _mm256_set1_ps(2 * pulse_width - 1);
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, sqr_avx2(phases + i, threshold));
+    }
+
+    sqr_plain(phases + i, pulse_width, dst + i, num_samples - i);
+}
+
+AVX2 static void sqr_span_avx2(const uint32_t *phases,
+                               const float *pulse_widths, float *dst,
+                               unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        __m256 threshold = _mm256_fmsub_ps(_mm256_loadu_ps(pulse_widths + i),
+                                           _mm256_set1_ps(2),
+                                           _mm256_set1_ps(1));
+        _mm256_storeu_ps(dst + i, sqr_avx2(phases + i, threshold));
+    }
+
+    sqr_span_plain(phases + i, pulse_widths + i, dst + i, num_samples - i);
+}
+
+AVX2 static void noise_avx2(uint32_t *state, float low, float high,
+                            float *dst, unsigned int num_samples)
+{
+    __m256 low_vector = _mm256_set1_ps(low);
+    __m256 scale = _mm256_set1_ps((high - low) * NOISE_SCALE);
+    unsigned int steps = num_samples / NOISE_LANES;
+
+    for(unsigned int j = 0; j < NOISE_LANES; j += 8)
+    {
+        __m256i *lanes = (__m256i *) (state + j);
+        __m256i s0 = _mm256_loadu_si256(lanes);
+        __m256i s1 = _mm256_loadu_si256(lanes + NOISE_LANES / 8);
+        __m256i s2 = _mm256_loadu_si256(lanes + NOISE_LANES / 4);
+        __m256i s3 = _mm256_loadu_si256(lanes + 3 * NOISE_LANES / 8);
+
+        for(unsigned int i = 0; i < steps; i ++)
+        {
+            __m256i words = _mm256_add_epi32(s0, s3);
+            __m256i t = _mm256_slli_epi32(s1, 9);
+            s2 = _mm256_xor_si256(s2, s0);
+            s3 = _mm256_xor_si256(s3, s1);
+            s1 = _mm256_xor_si256(s1, s2);
+            s0 = _mm256_xor_si256(s0, s3);
+            s2 = _mm256_xor_si256(s2, t);
+            s3 = _mm256_or_si256(_mm256_slli_epi32(s3, 11),
+                                 _mm256_srli_epi32(s3, 21));
+
+            __m256 samples = _mm256_cvtepi32_ps(_mm256_srli_epi32(words, 8));
+            _mm256_storeu_ps(dst + i * NOISE_LANES + j,
+                             _mm256_add_ps(low_vector,
+                                           _mm256_mul_ps(samples, scale)));
+        }
+
+        _mm256_storeu_si256(lanes, s0);
+        _mm256_storeu_si256(lanes + NOISE_LANES / 8, s1);
+        _mm256_storeu_si256(lanes + NOISE_LANES / 4, s2);
+        _mm256_storeu_si256(lanes + 3 * NOISE_LANES / 8, s3);
+    }
+
+    noise_plain(state, low, high, dst + steps * NOISE_LANES,
+                num_samples - steps * NOISE_LANES);
+}
+
+AVX2 static void ramp_avx2(float start, float increment, float *dst,
+                           unsigned int num_samples)
+{
+    __m256 start_vector = _mm256_set1_ps(start);
+    __m256 increment_vector = _mm256_set1_ps(increment);
+    __m256 indices = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    unsigned int i = 0;
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(indices, increment_vector,
+                                                  start_vector));
+        indices = _mm256_add_ps(indices, _mm256_set1_ps(8));
+    }
+
+    ramp_plain(start + i * increment, increment, dst + i, num_samples - i);
+}
+
+AVX2 static void curve_avx2(float target, float start, float ratio,
+                            float *dst, unsigned int num_samples)
+{
+    float distances_array[8];
+    float step = 1;
+    __m256 target_vector = _mm256_set1_ps(target);
+    unsigned int i = 0;
+
+    distances_array[0] = start - target;
+    for(unsigned int j = 1; j < 8; j ++)
+    {
+        distances_array[j] = distances_array[j - 1] * ratio;
+    }
+    for(unsigned int j = 0; j < 8; j ++)
+    {
+        step *= ratio;
+    }
+    __m256 distances = _mm256_loadu_ps(distances_array);
+    __m256 step_vector = _mm256_set1_ps(step);
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(target_vector, distances));
+        distances = _mm256_mul_ps(distances, step_vector);
+    }
+
+    curve_plain(target, target + _mm256_cvtss_f32(distances), ratio, dst + i,
+                num_samples - i);
+}
+
+AVX2 static unsigned int rising_edge_avx2(const float *src, float previous,
+                                          unsigned int num_samples)
+{
+    __m256 zero = _mm256_setzero_ps();
+    unsigned int i = 1;
+
+    if(num_samples == 0 || (previous <= 0 && src[0] > 0))
+    {
+        return 0;
+    }
+
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        int edges = _mm256_movemask_ps(
+            _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(src + i - 1), zero,
+                                        _CMP_LE_OQ),
+                          _mm256_cmp_ps(_mm256_loadu_ps(src + i), zero,
+                                        _CMP_GT_OQ)));
+        if(edges != 0)
+        {
+            return i + __builtin_ctz(edges);
+        }
+    }
+
+    return i + rising_edge_plain(src + i, src[i - 1], num_samples - i);
+}
+
+AVX2 static bool constant_avx2(const float *src, unsigned int num_samples)
+{
+    __m256 first;
+    unsigned int i = 1;
+
+    if(num_samples == 0)
+    {
+        return true;
+    }
+
+    first = _mm256_set1_ps(src[0]);
+    for(; i + 8 <= num_samples; i += 8)
+    {
+        if(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(src + i), first,
+                                            _CMP_NEQ_UQ)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return constant_plain(src + i - 1, num_samples - i + 1);
+}
+
+static const Kernels AVX2_KERNELS =
+{
+    "AVX2",
+    clip_avx2,
+    scale_avx2,
+    add_avx2,
+    multiply_avx2,
+    multiply_constant_avx2,
+    multiply_add_avx2,
+    multiply_add_constant_avx2,
+    mix_avx2,
+    interleave_avx2,
+    sin_avx2,
+    tri_avx2,
+    saw_avx2,
+    sqr_avx2,
+    sqr_span_avx2,
+    biquad_sse2,
+    noise_avx2,
+    ramp_avx2,
+    curve_avx2,
+    rising_edge_avx2,
+    constant_avx2
+};
+
+/*******************
+ * AVX-512 KERNELS *
+ *******************/
+
+#define AVX512 __attribute__((target("avx512f")))
+
+AVX512 static void clip_avx512(float *buffer, unsigned int num_samples,
+                               float min, float max)
+{
+    __m512 min_vector = _mm512_set1_ps(min);
+    __m512 max_vector = _mm512_set1_ps(max);
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        __m512 samples = _mm512_loadu_ps(buffer + i);
+        __mmask16 above = _mm512_cmp_ps_mask(samples, max_vector, _CMP_GT_OQ);
+        __mmask16 below = _mm512_cmp_ps_mask(samples, min_vector, _CMP_LT_OQ);
+        samples = _mm512_mask_mov_ps(samples, above, max_vector);
+        samples = _mm512_mask_mov_ps(samples, below & ~above, min_vector);
+        _mm512_storeu_ps(buffer + i, samples);
+    }
+
+    clip_plain(buffer + i, num_samples - i, min, max);
+}
+
+AVX512 static void scale_avx512(float *buffer, unsigned int num_samples,
+                                float original_low, float original_high,
+                                float low, float high)
+{
+    __m512 original_low_vector = _mm512_set1_ps(original_low);
+    __m512 original_range = _mm512_set1_ps(original_high - original_low);
+    __m512 low_vector = _mm512_set1_ps(low);
+    __m512 range = _mm512_set1_ps(high - low);
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        __m512 samples = _mm512_loadu_ps(buffer + i);
+        samples = _mm512_div_ps(_mm512_sub_ps(samples, original_low_vector),
+                                original_range);
+        samples = _mm512_fmadd_ps(samples, range, low_vector);
+        _mm512_storeu_ps(buffer + i, samples);
+    }
+
+    scale_plain(buffer + i, num_samples - i, original_low, original_high, low,
+                high);
+}
+
+AVX512 static void add_avx512(const float *src1, const float *src2,
+                              float *dst, unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        _mm512_storeu_ps(dst + i, _mm512_add_ps(_mm512_loadu_ps(src1 + i),
+                                                _mm512_loadu_ps(src2 + i)));
+    }
+
+    add_plain(src1 + i, src2 + i, dst + i, num_samples - i);
+}
+
+AVX512 static void multiply_avx512(const float *src1, const float *src2,
+                                   float *dst, unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_loadu_ps(src1 + i),
+                                                _mm512_loadu_ps(src2 + i)));
+    }
+
+    multiply_plain(src1 + i, src2 + i, dst + i, num_samples - i);
+}
+
+AVX512 static void multiply_constant_avx512(const float *src, float val,
+                                            float *dst,
+                                            unsigned int num_samples)
+{
+    __m512 val_vector = _mm512_set1_ps(val);
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_loadu_ps(src + i),
+                                                val_vector));
+    }
+
+    multiply_constant_plain(src + i, val, dst + i, num_samples - i);
+}
+
+AVX512 static void multiply_add_avx512(const float *src1, const float *src2,
+                                       float *dst, unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        _mm512_storeu_ps(dst + i, _mm512_fmadd_ps(_mm512_loadu_ps(src1 + i),
+                                                  _mm512_loadu_ps(src2 + i),
+                                                  _mm512_loadu_ps(dst + i)));
+    }
+
+    multiply_add_plain(src1 + i, src2 + i, dst + i, num_samples - i);
+}
+
+AVX512 static void multiply_add_constant_avx512(const float *src, float val,
+                                                float *dst,
+                                                unsigned int num_samples)
+{
+    __m512 val_vector = _mm512_set1_ps(val);
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        _mm512_storeu_ps(dst + i, _mm512_fmadd_ps(_mm512_loadu_ps(src + i),
+                                                  val_vector,
+                                                  _mm512_loadu_ps(dst + i)));
+    }
+
+    multiply_add_constant_plain(src + i, val, dst + i, num_samples - i);
+}
+
+AVX512 static void mix_avx512(const float * const *srcs, const float *gains,
+                              unsigned int num_srcs, float *dst,
+                              unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        __m512 sum = _mm512_setzero_ps();
+        for(unsigned int j = 0; j < num_srcs; j ++)
+        {
+            sum = _mm512_fmadd_ps(_mm512_loadu_ps(srcs[j] + i),
+                                  _mm512_set1_ps(gains[j]), sum);
+        }
+        _mm512_storeu_ps(dst + i, sum);
+    }
+
+    mix_plain_range(srcs, gains, num_srcs, dst, i, num_samples);
+}
+
+// GCC's own header implements some unmasked AVX-512 intrinsics with an
+// undefined vector as the source of masked off lanes, and GCC 12 then warns
+// that it may be used uninitialized, although no lanes are ever masked off
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+AVX512 static inline __m512 fold_phases_avx512(const uint32_t *phases,
+                                               __m512i *signs)
+{
+    __m512 quarter = _mm512_set1_ps(.25f);
+    __m512 phase = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_loadu_si512(
+                                     phases)),
+                                 _mm512_set1_ps(SIGNED_PHASE_SCALE));
+
+    *signs = _mm512_and_si512(_mm512_castps_si512(phase),
+                              _mm512_set1_epi32(HALF_PERIOD));
+    return _mm512_sub_ps(quarter,
+                         _mm512_abs_ps(_mm512_sub_ps(quarter,
+                                                     _mm512_abs_ps(phase))));
+}
+
+AVX512 static inline __m512 saw_avx512(const uint32_t *phases)
+{
+    __m512i offset = _mm512_xor_si512(_mm512_loadu_si512(phases),
+                                      _mm512_set1_epi32(HALF_PERIOD));
+    return _mm512_mul_ps(_mm512_cvtepi32_ps(offset),
+                         _mm512_set1_ps(SAW_SCALE));
+}
+
+AVX512 static void sin_avx512(const uint32_t *phases, float *dst,
+                              unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        __m512i signs;
+        __m512 quarter = fold_phases_avx512(phases + i, &signs);
+        __m512 quarter_squared = _mm512_mul_ps(quarter, quarter);
+        __m512 sample = _mm512_set1_ps(SIN_C9);
+        sample = _mm512_fmadd_ps(sample, quarter_squared,
+                                 _mm512_set1_ps(SIN_C7));
+        sample = _mm512_fmadd_ps(sample, quarter_squared,
+                                 _mm512_set1_ps(SIN_C5));
+        sample = _mm512_fmadd_ps(sample, quarter_squared,
+                                 _mm512_set1_ps(SIN_C3));
+        sample = _mm512_fmadd_ps(sample, quarter_squared,
+                                 _mm512_set1_ps(SIN_C1));
+        sample = _mm512_mul_ps(sample, quarter);
+        _mm512_storeu_ps(dst + i, _mm512_castsi512_ps(_mm512_or_si512(
+                                      _mm512_castps_si512(sample), signs)));
+    }
+
+    sin_plain(phases + i, dst + i, num_samples - i);
+}
+
+AVX512 static void tri_avx512(const uint32_t *phases, float *dst,
+                              unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        __m512i signs;
+        __m512 sample = _mm512_mul_ps(fold_phases_avx512(phases + i, &signs),
+                                      _mm512_set1_ps(4));
+        _mm512_storeu_ps(dst + i, _mm512_castsi512_ps(_mm512_or_si512(
+                                      _mm512_castps_si512(sample), signs)));
+    }
+
+    tri_plain(phases + i, dst + i, num_samples - i);
+}
+
+AVX512 static void saw_avx512(const uint32_t *phases, float *dst,
+                              unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        _mm512_storeu_ps(dst + i, saw_avx512(phases + i));
+    }
+
+    saw_plain(phases + i, dst + i, num_samples - i);
+}
+
+AVX512 static inline __m512 sqr_avx512(const uint32_t *phases,
+                                       __m512 threshold)
+{
+    __mmask16 below = _mm512_cmp_ps_mask(saw_avx512(phases), threshold,
+                                         _CMP_LT_OQ);
+    return _mm512_mask_blend_ps(below, _mm512_set1_ps(-1), _mm512_set1_ps(1));
+}
+
+AVX512 static void sqr_avx512(const uint32_t *phases, float pulse_width,
+                              float *dst, unsigned int num_samples)
+{
+    __m512 threshold = _mm512_set1_ps(2 * pulse_width - 1);
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        _mm512_storeu_ps(dst + i, sqr_avx512(phases + i, threshold));
+    }
+
+    sqr_plain(phases + i, pulse_width, dst + i, num_samples - i);
+}
+
+AVX512 static void sqr_span_avx512(const uint32_t *phases,
+                                   const float *pulse_widths, float *dst,
+                                   unsigned int num_samples)
+{
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        __m512 threshold = _mm512_fmsub_ps(_mm512_loadu_ps(pulse_widths + i),
+                                           _mm512_set1_ps(2),
+                                           _mm512_set1_ps(1));
+        _mm512_storeu_ps(dst + i, sqr_avx512(phases + i, threshold));
+    }
+
+    sqr_span_plain(phases + i, pulse_widths + i, dst + i, num_samples - i);
+}
+
+// There are exactly as many generators as lanes, so every one of them stays
+// in registers for the whole span
+AVX512 static void noise_avx512(uint32_t *state, float low, float high,
+                                float *dst, unsigned int num_samples)
+{
+    __m512 low_vector = _mm512_set1_ps(low);
+    __m512 scale = _mm512_set1_ps((high - low) * NOISE_SCALE);
+    unsigned int steps = num_samples / NOISE_LANES;
+    __m512i s0 = _mm512_loadu_si512(state);
+    __m512i s1 = _mm512_loadu_si512(state + NOISE_LANES);
+    __m512i s2 = _mm512_loadu_si512(state + 2 * NOISE_LANES);
+    __m512i s3 = _mm512_loadu_si512(state + 3 * NOISE_LANES);
+
+    for(unsigned int i = 0; i < steps; i ++)
+    {
+        __m512i words = _mm512_add_epi32(s0, s3);
+        __m512i t = _mm512_slli_epi32(s1, 9);
+        s2 = _mm512_xor_si512(s2, s0);
+        s3 = _mm512_xor_si512(s3, s1);
+        s1 = _mm512_xor_si512(s1, s2);
+        s0 = _mm512_xor_si512(s0, s3);
+        s2 = _mm512_xor_si512(s2, t);
+        s3 = _mm512_rol_epi32(s3, 11);
+
+        __m512 samples = _mm512_cvtepi32_ps(_mm512_srli_epi32(words, 8));
+        _mm512_storeu_ps(dst + i * NOISE_LANES,
+                         _mm512_add_ps(low_vector,
+                                       _mm512_mul_ps(samples, scale)));
+    }
+
+    _mm512_storeu_si512(state, s0);
+    _mm512_storeu_si512(state + NOISE_LANES, s1);
+    _mm512_storeu_si512(state + 2 * NOISE_LANES, s2);
+    _mm512_storeu_si512(state + 3 * NOISE_LANES, s3);
+
+    noise_plain(state, low, high, dst + steps * NOISE_LANES,
+                num_samples - steps * NOISE_LANES);
+}
+
+#pragma GCC diagnostic pop
+
+AVX512 static void ramp_avx512(float start, float increment, float *dst,
+                               unsigned int num_samples)
+{
+    __m512 start_vector = _mm512_set1_ps(start);
+    __m512 increment_vector = _mm512_set1_ps(increment);
+    __m512 indices = _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+                                    13, 14, 15);
+    unsigned int i = 0;
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        _mm512_storeu_ps(dst + i, _mm512_fmadd_ps(indices, increment_vector,
+                                                  start_vector));
+        indices = _mm512_add_ps(indices, _mm512_set1_ps(16));
+    }
+
+    ramp_plain(start + i * increment, increment, dst + i, num_samples - i);
+}
+
+AVX512 static void curve_avx512(float target, float start, float ratio,
+                                float *dst, unsigned int num_samples)
+{
+    float distances_array[16];
+    float step = 1;
+    __m512 target_vector = _mm512_set1_ps(target);
+    unsigned int i = 0;
+
+    distances_array[0] = start - target;
+    for(unsigned int j = 1; j < 16; j ++)
+    {
+        distances_array[j] = distances_array[j - 1] * ratio;
+    }
+    for(unsigned int j = 0; j < 16; j ++)
+    {
+        step *= ratio;
+    }
+    __m512 distances = _mm512_loadu_ps(distances_array);
+    __m512 step_vector = _mm512_set1_ps(step);
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        _mm512_storeu_ps(dst + i, _mm512_add_ps(target_vector, distances));
+        distances = _mm512_mul_ps(distances, step_vector);
+    }
+
+    curve_plain(target, target + _mm512_cvtss_f32(distances), ratio,
+                dst + i, num_samples - i);
+}
+
+AVX512 static unsigned int rising_edge_avx512(const float *src,
+                                              float previous,
+                                              unsigned int num_samples)
+{
+    __m512 zero = _mm512_setzero_ps();
+    unsigned int i = 1;
+
+    if(num_samples == 0 || (previous <= 0 && src[0] > 0))
+    {
+        return 0;
+    }
+
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        unsigned int edges =
+            _mm512_cmp_ps_mask(_mm512_loadu_ps(src + i - 1), zero, _CMP_LE_OQ)
+            & _mm512_cmp_ps_mask(_mm512_loadu_ps(src + i), zero, _CMP_GT_OQ);
+        if(edges != 0)
+        {
+            return i + __builtin_ctz(edges);
+        }
+    }
+
+    return i + rising_edge_plain(src + i, src[i - 1], num_samples - i);
+}
+
+AVX512 static bool constant_avx512(const float *src, unsigned int num_samples)
+{
+    __m512 first;
+    unsigned int i = 1;
+
+    if(num_samples == 0)
+    {
+        return true;
+    }
+
+    first = _mm512_set1_ps(src[0]);
+    for(; i + 16 <= num_samples; i += 16)
+    {
+        if(_mm512_cmp_ps_mask(_mm512_loadu_ps(src + i), first, _CMP_NEQ_UQ)
+           != 0)
+        {
+            return false;
+        }
+    }
+
+    return constant_plain(src + i - 1, num_samples - i + 1);
+}
+
+// Interleaving is bound by memory rather than arithmetic, so the AVX2 version
+// is used with the AVX-512 kernels as well, and a biquad cascade only has four
+// stages to run side by side, so the SSE2 version is used with both
+static const Kernels AVX512_KERNELS =
+{
+    "AVX-512",
+    clip_avx512,
+    scale_avx512,
+    add_avx512,
+    multiply_avx512,
+    multiply_constant_avx512,
+    multiply_add_avx512,
+    multiply_add_constant_avx512,
+    mix_avx512,
+    interleave_avx2,
+    sin_avx512,
+    tri_avx512,
+    saw_avx512,
+    sqr_avx512,
+    sqr_span_avx512,
+    biquad_sse2,
+    noise_avx512,
+    ramp_avx512,
+    curve_avx512,
+    rising_edge_avx512,
+    constant_avx512
+};
+
+#endif
+
+/*****************************
+ * KERNEL SELECTION FUNCTION *
+ *****************************/
+
+// The selected kernels, plain until a faster set is selected
+static Kernels KERNELS = PLAIN_KERNELS;
+
+/*
+ * Check which instruction sets this processor supports, and select the kernels
+ * for the newest one. This must be done before audio starts, since the audio
+ * thread reads the selected kernels without any synchronization.
+ */
+const char *select_signal_kernels()
+{
+    if(!select_signal_kernels("AVX-512") && !select_signal_kernels("AVX2")
+       && !select_signal_kernels("SSE2"))
+    {
+        select_signal_kernels("plain");
+    }
+
+    return KERNELS.name;
+}
+
+/*
+ * Select the kernels for the instruction set with the given name, if this
+ * processor supports it. Return true if they were selected, false if the
+ * instruction set is unsupported or unknown. Like the function above, this
+ * must not be called while audio is on.
+ */
+bool select_signal_kernels(const char *name)
+{
+    std::string instruction_set = name;
+
+    if(instruction_set == PLAIN_KERNELS.name)
+    {
+        KERNELS = PLAIN_KERNELS;
+        return true;
+    }
+
+#ifdef MSS_X86_SIGNAL_KERNELS
+    __builtin_cpu_init();
+
+    if(instruction_set == AVX512_KERNELS.name
+       && __builtin_cpu_supports("avx512f"))
+    {
+        KERNELS = AVX512_KERNELS;
+        return true;
+    }
+    if(instruction_set == AVX2_KERNELS.name && __builtin_cpu_supports("avx2")
+       && __builtin_cpu_supports("fma"))
+    {
+        KERNELS = AVX2_KERNELS;
+        return true;
+    }
+    if(instruction_set == SSE2_KERNELS.name && __builtin_cpu_supports("sse2"))
+    {
+        KERNELS = SSE2_KERNELS;
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+/***************************
+ * SIGNAL KERNEL FUNCTIONS *
+ ***************************/
+
+/*
+ * Clip samples in place, making sure no sample goes above the max, and no
+ * sample goes below the min.
+ */
+void clip_samples(float *buffer, unsigned int num_samples, float min,
+                  float max)
+{
+    KERNELS.clip(buffer, num_samples, min, max);
+}
+
+/*
+ * Copy samples. The standard library copy is already as fast as copying gets,
+ * so there is only one version of this kernel.
+ */
+void copy_samples(const float *src, float *dst, unsigned int num_samples)
+{
+    memcpy(dst, src, num_samples * sizeof(float));
+}
+
+/*
+ * Scale samples in place from their original range to a new range.
+ */
+void scale_samples(float *buffer, unsigned int num_samples,
+                   float original_low, float original_high, float low,
+                   float high)
+{
+    KERNELS.scale(buffer, num_samples, original_low, original_high, low,
+                  high);
+}
+
+/*
+ * Add two spans of samples into a destination span.
+ */
+void add_samples(const float *src1, const float *src2, float *dst,
+                 unsigned int num_samples)
+{
+    KERNELS.add(src1, src2, dst, num_samples);
+}
+
+/*
+ * Multiply two spans of samples into a destination span.
+ */
+void multiply_samples(const float *src1, const float *src2, float *dst,
+                      unsigned int num_samples)
+{
+    KERNELS.multiply(src1, src2, dst, num_samples);
+}
+
+/*
+ * Multiply a span of samples by a constant into a destination span.
+ */
+void multiply_samples(const float *src, float val, float *dst,
+                      unsigned int num_samples)
+{
+    KERNELS.multiply_constant(src, val, dst, num_samples);
+}
+
+/*
+ * Multiply two spans of samples, and add the products to a destination span.
+ */
+void multiply_add_samples(const float *src1, const float *src2, float *dst,
+                          unsigned int num_samples)
+{
+    KERNELS.multiply_add(src1, src2, dst, num_samples);
+}
+
+/*
+ * Multiply a span of samples by a constant, and add the products to a
+ * destination span.
+ */
+void multiply_add_samples(const float *src, float val, float *dst,
+                          unsigned int num_samples)
+{
+    KERNELS.multiply_add_constant(src, val, dst, num_samples);
+}
+
+/*
+ * Multiply each source span by its own gain, and sum them all into a
+ * destination span in a single pass over it. With no sources, the destination
+ * is filled with 0s.
+ */
+void mix_samples(const float * const *srcs, const float *gains,
+                 unsigned int num_srcs, float *dst, unsigned int num_samples)
+{
+    KERNELS.mix(srcs, gains, num_srcs, dst, num_samples);
+}
+
+/*
+ * Interleave a left and a right span of samples into a destination span
+ * twice as long, as audio devices expect stereo samples to be.
+ */
+void interleave_samples(const float *left, const float *right, float *dst,
+                        unsigned int num_samples)
+{
+    KERNELS.interleave(left, right, dst, num_samples);
+}
+
+
+/*
+ * Generate a sine wave from a span of fixed point phases, where the whole
+ * range of a 32 bit integer is one period. Every sample is within 2e-7 of
+ * the true sine.
+ */
+void sin_samples(const uint32_t *phases, float *dst, unsigned int num_samples)
+{
+    KERNELS.sin(phases, dst, num_samples);
+}
+
+/*
+ * Generate a triangle wave from a span of fixed point phases, starting at 0
+ * and rising to 1 a quarter of the way through each period.
+ */
+void tri_samples(const uint32_t *phases, float *dst, unsigned int num_samples)
+{
+    KERNELS.tri(phases, dst, num_samples);
+}
+
+/*
+ * Generate a saw wave from a span of fixed point phases, rising from -1 to 1
+ * over each period.
+ */
+void saw_samples(const uint32_t *phases, float *dst, unsigned int num_samples)
+{
+    KERNELS.saw(phases, dst, num_samples);
+}
+
+/*
+ * Generate a square wave from a span of fixed point phases, 1 for the part of
+ * each period before the pulse width, and -1 after it.
+ */
+void sqr_samples(const uint32_t *phases, float pulse_width, float *dst,
+                 unsigned int num_samples)
+{
+    KERNELS.sqr(phases, pulse_width, dst, num_samples);
+}
+
+/*
+ * Generate a square wave from a span of fixed point phases, with a span of
+ * pulse widths, one for each phase.
+ */
+void sqr_samples(const uint32_t *phases, const float *pulse_widths,
+                 float *dst, unsigned int num_samples)
+{
+    KERNELS.sqr_span(phases, pulse_widths, dst, num_samples);
+}
+
+/*
+ * Filter a span of samples through a cascade of up to four biquad filters
+ * into a destination span, which may be the same span. The coefficients and
+ * history of every stage are updated in place, and each coefficient changes
+ * by its increment after every sample, so that the cascade can move smoothly
+ * from one set of coefficients to another.
+ */
+void biquad_samples(const float *src, float *dst, unsigned int num_samples,
+                    unsigned int num_stages, float *coefficients,
+                    const float *increments, float *history)
+{
+    KERNELS.biquad(src, dst, num_samples, num_stages, coefficients,
+                   increments, history);
+}
+
+/*
+ * Seed the state of a set of noise generators, NOISE_STATE_SIZE words, from a
+ * single number, using SplitMix64 to spread it over every word. Generators
+ * seeded from different numbers make unrelated noise.
+ */
+void seed_noise(uint32_t *state, uint64_t seed)
+{
+    for(unsigned int i = 0; i < NOISE_STATE_SIZE; i += 2)
+    {
+        seed += 0x9e3779b97f4a7c15ull;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        z ^= z >> 31;
+        state[i] = (uint32_t) z;
+        state[i + 1] = (uint32_t) (z >> 32);
+    }
+}
+
+/*
+ * Generate uniform white noise from a low up to a high into a destination
+ * span, moving the state of the noise generators along.
+ */
+void noise_samples(uint32_t *state, float low, float high, float *dst,
+                   unsigned int num_samples)
+{
+    KERNELS.noise(state, low, high, dst, num_samples);
+}
+
+/*
+ * Generate a ramp into a destination span, starting at the given value and
+ * moving by the given increment every sample.
+ */
+void ramp_samples(float start, float increment, float *dst,
+                  unsigned int num_samples)
+{
+    KERNELS.ramp(start, increment, dst, num_samples);
+}
+
+/*
+ * Generate an exponential curve into a destination span, starting at the
+ * given value and moving toward the target, so that the distance left to the
+ * target is multiplied by the given ratio every sample.
+ */
+void curve_samples(float target, float start, float ratio, float *dst,
+                   unsigned int num_samples)
+{
+    KERNELS.curve(target, start, ratio, dst, num_samples);
+}
+
+/*
+ * Return the index of the first rising edge in a span, the first sample above
+ * 0 right after one at or below 0, given the sample just before the span. If
+ * there is no rising edge, return the length of the span.
+ */
+unsigned int find_rising_edge(const float *src, float previous,
+                              unsigned int num_samples)
+{
+    return KERNELS.rising_edge(src, previous, num_samples);
+}
+
+/*
+ * Return whether or not every sample in a span is the same.
+ */
+bool is_constant(const float *src, unsigned int num_samples)
+{
+    return KERNELS.constant(src, num_samples);
+}
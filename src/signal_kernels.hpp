@@ -0,0 +1,90 @@
+/*
+ * Matthew Diamond 2016
+ * Header file for the signal kernels. Signal kernels are the inner loops of
+ * signal processing. Each one operates on spans of samples, given as a pointer
+ * to the first sample and a number of samples. Every kernel has a plain
+ * implementation, and on x86 processors also SSE2, AVX2, and AVX-512
+ * implementations. The fastest implementations this processor supports are
+ * selected once at startup.
+ */
+
+#ifndef MSS_SIGNAL_KERNELS_HPP
+#define MSS_SIGNAL_KERNELS_HPP
+
+/************
+ * INCLUDES *
+ ************/
+
+// Included libraries
+#include <cstdint>
+
+/*************
+ * CONSTANTS *
+ *************/
+
+// The number of 32 bit words in the state of a set of noise generators
+const unsigned int NOISE_STATE_SIZE = 64;
+
+/*************************
+ * FUNCTION DECLARATIONS *
+ *************************/
+
+// Select the fastest kernels this processor supports, return the name of the
+// instruction set they use
+const char *select_signal_kernels();
+// Select the kernels for the named instruction set, return whether or not
+// this processor supports it, used to test every set of kernels
+bool select_signal_kernels(const char *);
+
+// Signal kernels
+//   Clip samples in place between a min and a max
+void clip_samples(float *, unsigned int, float, float);
+//   Copy samples from a source span to a destination span
+void copy_samples(const float *, float *, unsigned int);
+//   Scale samples in place from an original range to a new range
+void scale_samples(float *, unsigned int, float, float, float, float);
+//   Add two spans into a destination span
+void add_samples(const float *, const float *, float *, unsigned int);
+//   Multiply two spans, or a span and a constant, into a destination span
+void multiply_samples(const float *, const float *, float *, unsigned int);
+void multiply_samples(const float *, float, float *, unsigned int);
+//   Multiply two spans, or a span and a constant, and add the result to a
+//   destination span
+void multiply_add_samples(const float *, const float *, float *,
+                          unsigned int);
+void multiply_add_samples(const float *, float, float *, unsigned int);
+//   Multiply each of a number of spans by its own gain, and sum them all into
+//   a destination span
+void mix_samples(const float * const *, const float *, unsigned int, float *,
+                 unsigned int);
+//   Interleave a left and a right span into a destination span twice as long
+void interleave_samples(const float *, const float *, float *, unsigned int);
+//   Generate a sine, triangle, saw, or square wave from a span of fixed point
+//   phases into a destination span, square waves given a constant pulse
+//   width or a span of them
+void sin_samples(const uint32_t *, float *, unsigned int);
+void tri_samples(const uint32_t *, float *, unsigned int);
+void saw_samples(const uint32_t *, float *, unsigned int);
+void sqr_samples(const uint32_t *, float, float *, unsigned int);
+void sqr_samples(const uint32_t *, const float *, float *, unsigned int);
+//   Filter a span through a cascade of up to four biquad filters into a
+//   destination span, given the coefficients of each stage, how much each
+//   coefficient changes every sample, and the history of each stage
+void biquad_samples(const float *, float *, unsigned int, unsigned int,
+                    float *, const float *, float *);
+//   Seed the state of a set of noise generators, then generate white noise
+//   in a range into a destination span with them
+void seed_noise(uint32_t *, uint64_t);
+void noise_samples(uint32_t *, float, float, float *, unsigned int);
+//   Generate a linear ramp from a start by an increment every sample, or an
+//   exponential curve from a start toward a target, into a destination span
+void ramp_samples(float, float, float *, unsigned int);
+void curve_samples(float, float, float, float *, unsigned int);
+//   Return the index of the first rising edge in a span, given the sample
+//   before it, or the length of the span if there is none
+unsigned int find_rising_edge(const float *, float, unsigned int);
+//   Return whether or not every sample in a span is the same
+bool is_constant(const float *, unsigned int);
+
+#endif
+
@@ -9,6 +9,7 @@
  ************/
 
 // Included libraries
+#include <cmath>
 #include <iostream>
 #include <vector>
 
@@ -18,6 +19,7 @@
 // Included files
 #include "image_processing.hpp"
 #include "main.hpp"
+#include "signal_kernels.hpp"
 #include "signal_processing.hpp"
 
 // Included modules classes
@@ -31,43 +33,48 @@
 
 /*
  * Audio callback which triggers the generation of samples
- * when more audio is needed to play. This function calls upon the
- * output module to process, which recursively triggers the processing
- * of samples down the entire signal chain. Once all samples are
- * processed and ready, the buffer is filled with the waiting samples
- * in the output modules inputs.
+ * when more audio is needed to play. This function first applies any changes
+ * posted by the main thread since the last block, then walks the most recently
+ * published execution plan, which processes every module the output module
+ * depends upon in topological order, so modules at the beginning of the signal
+ * chain are processed first. Once all samples are processed and ready, the
+ * buffer is filled with the waiting samples in the output modules inputs.
  */
 void audio_callback(void *userdata_, Uint8 *buffer_, int length_)
 {
     // Cast the buffer to a float buffer
     float *buffer = (float *) buffer_;
 
-    // Get the address of the output module for later use
-    Output *output = (Output *) MODULES[0];
+    // Apply changes made by the main thread at the block boundary, then pick
+    // up the most recently published execution plan
+    COMMAND_QUEUE.apply_commands();
+    Execution_Plan *execution_plan = PLAN_PUBLISHER.acquire();
 
-    // Process audio for the output module
-    // This will recursively call upon depended modules
-    // for processed audio, meaning that modules at
-    // the beginning of the signal chain will be processed first
-    output->process();
+    // Get the address of the output module for later use, the execution plan
+    // keeps track of it so that the vector of modules is never touched here
+    Module *output = execution_plan->output;
+
+    // Process audio for every module in the execution plan
+    execution_plan->process();
 
     // Populate the audio buffer, either with samples from the inputs to the
-    // output module, or with 0s if there is no input for the channel
-    for(unsigned int i = 0; i < BUFFER_SIZE; i ++)
+    // output module, or with 0s if there is no input for the channel. The
+    // common case of two live channels is interleaved by a signal kernel
+    if(output != nullptr && NUM_CHANNELS == 2 && output->inputs[0].live
+       && output->inputs[1].live)
     {
-        for(unsigned int j = 0; j < NUM_CHANNELS; j ++)
-        {
-            *buffer = output->inputs[j].live ? output->inputs[j].in->at(i) : 0;
-            buffer ++;
-        }
+        interleave_samples(output->inputs[0].in, output->inputs[1].in, buffer,
+                           BUFFER_SIZE);
+        return;
     }
 
-    // Mark all modules as not processed
-    for(unsigned int i = 1; i < MODULES.size(); i ++)
+    for(unsigned int i = 0; i < BUFFER_SIZE; i ++)
     {
-        if(MODULES[i] != NULL)
+        for(unsigned int j = 0; j < NUM_CHANNELS; j ++)
         {
-            MODULES[i]->processed = false;
+            *buffer = output != nullptr && output->inputs[j].live ?
+                      output->inputs[j].in[i] : 0;
+            buffer ++;
         }
     }
 }
@@ -83,17 +90,7 @@ void audio_callback(void *userdata_, Uint8 *buffer_, int length_)
  */
 void clip_signal(std::vector<float> *buffer, float min, float max)
 {
-    for(unsigned int i = 0; i < buffer->size(); i ++)
-    {
-        if((*buffer)[i] > max)
-        {
-            (*buffer)[i] = max;
-        }
-        else if((*buffer)[i] < min)
-        {
-            (*buffer)[i] = min;
-        }
-    }
+    clip_samples(buffer->data(), buffer->size(), min, max);
 }
 
 /*
@@ -101,10 +98,7 @@ void clip_signal(std::vector<float> *buffer, float min, float max)
  */
 void copy_signal(std::vector<float> *src, std::vector<float> *dst)
 {
-    for(unsigned int i = 0; i < src->size(); i ++)
-    {
-        (*dst)[i] = (*src)[i];
-    }
+    copy_samples(src->data(), dst->data(), src->size());
 }
 
 /*
@@ -120,7 +114,7 @@ void copy_signal_to_waveform_buffer(Waveform &waveform)
     {
         if(waveform.buffer != nullptr)
         {
-            waveform.render_buffer[index] = waveform.buffer->at(i);
+            waveform.render_buffer[index] = (*waveform.buffer)[i];
         }
         else
         {
@@ -136,11 +130,8 @@ void copy_signal_to_waveform_buffer(Waveform &waveform)
 void scale_signal(std::vector<float> *buffer, float original_low,
                   float original_high, float low, float high)
 {
-    for(auto it = (*buffer).begin(); it != (*buffer).end(); it ++)
-    {
-        *it = scale_sample(*it, original_low, original_high, low,
-                                    high);
-    }
+    scale_samples(buffer->data(), buffer->size(), original_low, original_high,
+                  low, high);
 }
 
 /*
@@ -149,11 +140,7 @@ void scale_signal(std::vector<float> *buffer, float original_low,
 void add_signals(std::vector<float> *buffer1, std::vector<float> *buffer2,
                  std::vector<float> *dst)
 {
-    // For each sample
-    for(unsigned int i = 0; i < buffer1->size(); i ++)
-    {
-        (*dst)[i] = (*buffer1)[i] + (*buffer2)[i];
-    }
+    add_samples(buffer1->data(), buffer2->data(), dst->data(), buffer1->size());
 }
 
 /*
@@ -162,11 +149,8 @@ void add_signals(std::vector<float> *buffer1, std::vector<float> *buffer2,
 void multiply_signals(std::vector<float> *buffer1, std::vector<float> *buffer2,
                       std::vector<float> *dst)
 {
-    // For each sample
-    for(unsigned int i = 0; i < buffer1->size(); i ++)
-    {
-        (*dst)[i] = (*buffer1)[i] * (*buffer2)[i];
-    }
+    multiply_samples(buffer1->data(), buffer2->data(), dst->data(),
+                     buffer1->size());
 }
 
 /*
@@ -176,10 +160,22 @@ void multiply_signals(std::vector<float> *buffer1, std::vector<float> *buffer2,
 void multiply_signals(std::vector<float> *buffer, float val,
                       std::vector<float> *dst)
 {
-    // For each sample
-    for(unsigned int i = 0; i < buffer->size(); i ++)
-    {
-        (*dst)[i] = (*buffer)[i] * val;
-    }
+    multiply_samples(buffer->data(), val, dst->data(), buffer->size());
 }
 
+/*
+ * Return the tangent of an angle from 0 up to but not including pi / 2, using
+ * a rational approximation over the first half of that range, and the
+ * tangent's symmetry about pi / 4 for the second half. Up to 0.49 pi, the
+ * result is within 2e-6 of the true tangent, relative to its size.
+ */
+float fast_tan(float angle)
+{
+    bool reflected = angle > (float) (M_PI / 4);
+    float x = reflected ? (float) (M_PI / 2) - angle : angle;
+    float x_squared = x * x;
+    float tangent = x * (945 - 105 * x_squared + x_squared * x_squared)
+                    / (945 - 420 * x_squared + 15 * x_squared * x_squared);
+
+    return reflected ? 1 / tangent : tangent;
+}
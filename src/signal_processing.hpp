@@ -34,6 +34,7 @@ void add_signals(std::vector<float> *, std::vector<float> *,
 void multiply_signals(std::vector<float> *, std::vector<float> *,
                       std::vector<float> *);
 void multiply_signals(std::vector<float> *, float, std::vector<float> *);
+float fast_tan(float);
 
 #endif
 
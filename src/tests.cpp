@@ -8,7 +8,15 @@
  ************/
 
 // Included libraries
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -16,8 +24,42 @@
 #include "SDL.h"
 
 // Included files
+#include "Execution_Plan.hpp"
+#include "main.hpp"
+#include "Modules/Delay.hpp"
+#include "Modules/Filter.hpp"
+#include "Modules/Mixer.hpp"
+#include "Modules/Multiplier.hpp"
+#include "Modules/Oscillator.hpp"
+#include "Modules/Output.hpp"
+#include "Modules/Poly.hpp"
+#include "signal_kernels.hpp"
 #include "signal_processing.hpp"
 #include "tests.hpp"
+#include "Wav_Writer.hpp"
+
+/*************
+ * CONSTANTS *
+ *************/
+
+// The instruction sets whose kernels are compared to the plain kernels, any
+// that this processor does not support are skipped
+static const char *INSTRUCTION_SETS[] = {"SSE2", "AVX2", "AVX-512"};
+static const unsigned int NUM_INSTRUCTION_SETS = 3;
+
+// The span lengths every kernel is tested with, most of which leave samples
+// over after the 4, 8, and 16 sample vectors of the instruction sets
+static const unsigned int SPAN_LENGTHS[] = {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17,
+                                            31, 33, 63, 64, 65, 512, 515};
+static const unsigned int NUM_SPAN_LENGTHS = 18;
+
+/*********
+ * TYPES *
+ *********/
+
+// A function that runs a kernel on spans of the given length, and appends
+// everything the kernel produced to the given vector
+typedef void (*Kernel_Run)(unsigned int, std::vector<float> *);
 
 /********************
  * HELPER FUNCTIONS *
@@ -43,6 +85,123 @@ bool compare_buffers(std::vector<float> *buffer1, std::vector<float> *buffer2,
     return same;
 }
 
+/*
+ * Fill a buffer with the given number of samples from -1 to 1, which are the
+ * same every time for the same seed.
+ */
+std::vector<float> generate_test_samples(unsigned int num_samples,
+                                         uint32_t seed)
+{
+    std::vector<float> samples(num_samples);
+
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        samples[i] = (seed >> 8) / 8388608.0f - 1;
+    }
+
+    return samples;
+}
+
+/*
+ * Fill a buffer with the given number of fixed point phases, starting with
+ * the phases at which waveforms change direction or sign, followed by phases
+ * which are the same every time for the same seed.
+ */
+std::vector<uint32_t> generate_test_phases(unsigned int num_samples,
+                                           uint32_t seed)
+{
+    static const uint32_t edges[] = {0, 1, 0x3fffffff, 0x40000000, 0x7fffffff,
+                                     0x80000000, 0x80000001, 0xc0000000,
+                                     0xffffffff};
+    std::vector<uint32_t> phases(num_samples);
+
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        phases[i] = i < 9 ? edges[i] : seed;
+    }
+
+    return phases;
+}
+
+/*
+ * Compare two buffers of kernel results. Return true if every result is
+ * within the given tolerance of the expected one, relative to the expected
+ * result once it is larger than 1, false otherwise. A tolerance of 0 means
+ * the results must be bit-identical.
+ */
+bool compare_kernel_results(std::vector<float> *expected,
+                            std::vector<float> *results, float tolerance)
+{
+    if(expected->size() != results->size())
+    {
+        return false;
+    }
+
+    for(unsigned int i = 0; i < expected->size(); i ++)
+    {
+        float expected_result = (*expected)[i];
+        float result = (*results)[i];
+
+        if(tolerance == 0)
+        {
+            if(memcmp(&expected_result, &result, sizeof(float)) != 0)
+            {
+                return false;
+            }
+        }
+        else if(!(fabsf(expected_result - result)
+                  <= tolerance * std::max(1.0f, fabsf(expected_result))))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Run a kernel with every set of kernels this processor supports, on spans
+ * of every test length, and compare the results to those of the plain
+ * kernels. Print which instruction set and span length failed, if any.
+ * Return true if every result was within the given tolerance, false
+ * otherwise. The fastest kernels are selected again afterwards.
+ */
+bool compare_kernels(Kernel_Run run, float tolerance)
+{
+    bool same = true;
+
+    for(unsigned int i = 0; i < NUM_INSTRUCTION_SETS; i ++)
+    {
+        for(unsigned int j = 0; j < NUM_SPAN_LENGTHS; j ++)
+        {
+            std::vector<float> expected;
+            std::vector<float> results;
+
+            select_signal_kernels("plain");
+            run(SPAN_LENGTHS[j], &expected);
+            if(!select_signal_kernels(INSTRUCTION_SETS[i]))
+            {
+                break;
+            }
+            run(SPAN_LENGTHS[j], &results);
+
+            if(!compare_kernel_results(&expected, &results, tolerance))
+            {
+                std::cout << "    " << INSTRUCTION_SETS[i]
+                          << " kernels differ from the plain kernels for "
+                          << SPAN_LENGTHS[j] << " samples" << std::endl;
+                same = false;
+            }
+        }
+    }
+
+    select_signal_kernels();
+
+    return same;
+}
+
 /*
  * Print out the results of all tests.
  */
@@ -91,6 +250,178 @@ bool all_tests_passed(int *results, int test_num)
     return passed;
 }
 
+/*
+ * Process an execution plan in which an oscillator with the given waveform and
+ * frequency is read by the multiplier input of a multiplier, whose signal is a
+ * DC offset of 1, with the given control period, and append the multiplier's
+ * output for the given number of blocks to the given vector. Return whether
+ * or not the oscillator was calculated at control rate.
+ */
+bool render_modulation(Oscillator::WaveformType waveform_type,
+                       float frequency, unsigned int control_period,
+                       unsigned int num_blocks, std::vector<float> *results)
+{
+    Output *output;
+    Oscillator *oscillator, *offset;
+    Multiplier *multiplier;
+    Execution_Plan plan;
+    unsigned int previous_control_period = CONTROL_PERIOD;
+    bool control_rate;
+
+    CONTROL_PERIOD = control_period;
+
+    output = new Output();
+    MODULES.push_back(output);
+    oscillator = new Oscillator();
+    MODULES.push_back(oscillator);
+    offset = new Oscillator();
+    MODULES.push_back(offset);
+    multiplier = new Multiplier();
+    MODULES.push_back(multiplier);
+
+    oscillator->switch_waveform(waveform_type);
+    oscillator->inputs[Oscillator::OSCILLATOR_FREQUENCY].val = frequency;
+    offset->inputs[Oscillator::OSCILLATOR_RANGE_LOW].val = 1;
+    offset->inputs[Oscillator::OSCILLATOR_RANGE_HIGH].val = 1;
+    multiplier->inputs[Multiplier::MULTIPLIER_SIGNAL].from = offset;
+    multiplier->inputs[Multiplier::MULTIPLIER_MULTIPLIER].from = oscillator;
+    output->inputs[Output::OUTPUT_INPUT_L].from = multiplier;
+    output->inputs[Output::OUTPUT_INPUT_R].from = multiplier;
+
+    plan.compile(output);
+    plan.bind();
+    for(unsigned int i = 0; i < num_blocks; i ++)
+    {
+        plan.process();
+        results->insert(results->end(), multiplier->out,
+                        multiplier->out + BUFFER_SIZE);
+    }
+    control_rate = oscillator->at_control_rate(BUFFER_SIZE);
+
+    for(unsigned int i = 0; i < MODULES.size(); i ++)
+    {
+        delete MODULES[i];
+    }
+    MODULES.clear();
+    CONTROL_PERIOD = previous_control_period;
+
+    return control_rate;
+}
+
+/*
+ * Process an execution plan in which eight oscillators at different
+ * frequencies are multiplied together in pairs, then the products in pairs,
+ * and so on down to one multiplier, with the parallel scheduler given the
+ * given number of worker threads, or none, and append that multiplier's output
+ * for the given number of blocks to the given vector. Return whether or not
+ * the plan was processed in parallel.
+ */
+bool render_wide_graph(unsigned int num_workers, unsigned int num_blocks,
+                       std::vector<float> *results)
+{
+    Output *output;
+    std::vector<Module *> level;
+    Execution_Plan plan;
+    bool parallel;
+
+    if(num_workers > 0)
+    {
+        PARALLEL_SCHEDULER = new Parallel_Scheduler(num_workers);
+    }
+
+    output = new Output();
+    MODULES.push_back(output);
+    for(unsigned int i = 0; i < 8; i ++)
+    {
+        Oscillator *oscillator = new Oscillator();
+        MODULES.push_back(oscillator);
+        oscillator->inputs[Oscillator::OSCILLATOR_FREQUENCY].val =
+            110 * (i + 1);
+        level.push_back(oscillator);
+    }
+    while(level.size() > 1)
+    {
+        std::vector<Module *> products;
+        for(unsigned int i = 0; i < level.size(); i += 2)
+        {
+            Multiplier *multiplier = new Multiplier();
+            MODULES.push_back(multiplier);
+            multiplier->inputs[Multiplier::MULTIPLIER_SIGNAL].from =
+                level[i];
+            multiplier->inputs[Multiplier::MULTIPLIER_MULTIPLIER].from =
+                level[i + 1];
+            products.push_back(multiplier);
+        }
+        level = products;
+    }
+    output->inputs[Output::OUTPUT_INPUT_L].from = level[0];
+    output->inputs[Output::OUTPUT_INPUT_R].from = level[0];
+
+    plan.compile(output);
+    plan.bind();
+    for(unsigned int i = 0; i < num_blocks; i ++)
+    {
+        plan.process();
+        results->insert(results->end(), level[0]->out,
+                        level[0]->out + BUFFER_SIZE);
+    }
+    parallel = plan.parallel;
+
+    for(unsigned int i = 0; i < MODULES.size(); i ++)
+    {
+        delete MODULES[i];
+    }
+    MODULES.clear();
+    delete PARALLEL_SCHEDULER;
+    PARALLEL_SCHEDULER = nullptr;
+
+    return parallel;
+}
+
+/*
+ * Write the given interleaved samples to a temporary WAV file with the given
+ * number of channels, as 16 bit PCM or as 32 bit floats, then read the whole
+ * file back into the given string and remove it. Return whether or not the
+ * file was written successfully.
+ */
+bool write_test_wav(bool pcm, unsigned int num_channels,
+                    std::vector<float> samples, std::string *bytes)
+{
+    std::string filename = "mss_test_wav_writer.wav";
+    bool written;
+
+    {
+        Wav_Writer wav_writer(filename, num_channels, 44100, pcm);
+        wav_writer.write(samples.data(), samples.size());
+        written = wav_writer.is_open() && wav_writer.close();
+    }
+
+    std::ifstream file(filename, std::ios::binary);
+    *bytes = std::string(std::istreambuf_iterator<char>(file),
+                         std::istreambuf_iterator<char>());
+    file.close();
+    std::remove(filename.c_str());
+
+    return written;
+}
+
+/*
+ * Return the little endian integer of the given number of bytes at the given
+ * offset in the given string.
+ */
+uint32_t read_little_endian(const std::string &bytes, unsigned int offset,
+                            unsigned int num_bytes)
+{
+    uint32_t val = 0;
+
+    for(unsigned int i = num_bytes; i -- > 0;)
+    {
+        val = (val << 8) | (unsigned char) bytes[offset + i];
+    }
+
+    return val;
+}
+
 /*********
  * TESTS *
  *********/
@@ -132,30 +463,1194 @@ bool test_add_signals_1()
     return false;
 }
 
-/*************
- * RUN TESTS *
- *************/
+/*
+ * Run the clip kernel on samples from -2 to 2.
+ */
+void run_clip_kernel(unsigned int num_samples, std::vector<float> *results)
+{
+    *results = generate_test_samples(num_samples, 1);
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        (*results)[i] *= 2;
+    }
+
+    clip_samples(results->data(), num_samples, -1, .5);
+}
 
 /*
- * Run all tests.
+ * Test the clip kernels against the plain clip kernel.
  */
-bool run_tests()
+bool test_clip_kernels()
 {
-    std::string names[1];
-    int results[1];
-    int test_num = 0;
+    return compare_kernels(run_clip_kernel, 0);
+}
 
-    names[test_num] = "test add signals 1";
-    results[test_num] = test_add_signals_1();
-    test_num ++;
+/*
+ * Run the scale kernel from the range of an oscillator to another range.
+ */
+void run_scale_kernel(unsigned int num_samples, std::vector<float> *results)
+{
+    *results = generate_test_samples(num_samples, 2);
 
-    print_test_results(names, results, test_num);
+    scale_samples(results->data(), num_samples, -1, 1, -3, 7);
+}
 
-    if(all_tests_passed(results, test_num))
+/*
+ * Test the scale kernels against the plain scale kernel.
+ */
+bool test_scale_kernels()
+{
+    return compare_kernels(run_scale_kernel, 1e-6);
+}
+
+/*
+ * Run the add kernel.
+ */
+void run_add_kernel(unsigned int num_samples, std::vector<float> *results)
+{
+    std::vector<float> src1 = generate_test_samples(num_samples, 3);
+    std::vector<float> src2 = generate_test_samples(num_samples, 4);
+
+    results->resize(num_samples);
+    add_samples(src1.data(), src2.data(), results->data(), num_samples);
+}
+
+/*
+ * Test the add kernels against the plain add kernel.
+ */
+bool test_add_kernels()
+{
+    return compare_kernels(run_add_kernel, 0);
+}
+
+/*
+ * Run the multiply kernels, with a span and with a constant.
+ */
+void run_multiply_kernels(unsigned int num_samples,
+                          std::vector<float> *results)
+{
+    std::vector<float> src1 = generate_test_samples(num_samples, 5);
+    std::vector<float> src2 = generate_test_samples(num_samples, 6);
+
+    results->resize(2 * num_samples);
+    multiply_samples(src1.data(), src2.data(), results->data(), num_samples);
+    multiply_samples(src1.data(), -.3f, results->data() + num_samples,
+                     num_samples);
+}
+
+/*
+ * Test the multiply kernels against the plain multiply kernels.
+ */
+bool test_multiply_kernels()
+{
+    return compare_kernels(run_multiply_kernels, 0);
+}
+
+/*
+ * Run the multiply add kernels, with a span and with a constant. Kernels that
+ * fuse the multiply and the add round once instead of twice.
+ */
+void run_multiply_add_kernels(unsigned int num_samples,
+                              std::vector<float> *results)
+{
+    std::vector<float> src1 = generate_test_samples(num_samples, 7);
+    std::vector<float> src2 = generate_test_samples(num_samples, 8);
+    std::vector<float> dst = generate_test_samples(num_samples, 9);
+
+    *results = dst;
+    results->insert(results->end(), dst.begin(), dst.end());
+    multiply_add_samples(src1.data(), src2.data(), results->data(),
+                         num_samples);
+    multiply_add_samples(src1.data(), .7f, results->data() + num_samples,
+                         num_samples);
+}
+
+/*
+ * Test the multiply add kernels against the plain multiply add kernels.
+ */
+bool test_multiply_add_kernels()
+{
+    return compare_kernels(run_multiply_add_kernels, 1e-6);
+}
+
+/*
+ * Run the mix kernel with no sources, and with more sources than any
+ * instruction set mixes at once.
+ */
+void run_mix_kernel(unsigned int num_samples, std::vector<float> *results)
+{
+    const unsigned int max_srcs = 9;
+    std::vector<std::vector<float>> srcs;
+    std::vector<const float *> src_pointers;
+    std::vector<float> gains = generate_test_samples(max_srcs, 10);
+    std::vector<float> dst(num_samples);
+
+    for(unsigned int i = 0; i < max_srcs; i ++)
     {
-        return true;
+        srcs.push_back(generate_test_samples(num_samples, 11 + i));
+        src_pointers.push_back(srcs.back().data());
     }
 
-    return false;
+    results->clear();
+    for(unsigned int num_srcs = 0; num_srcs <= max_srcs; num_srcs ++)
+    {
+        std::fill(dst.begin(), dst.end(), 1);
+        mix_samples(src_pointers.data(), gains.data(), num_srcs, dst.data(),
+                    num_samples);
+        results->insert(results->end(), dst.begin(), dst.end());
+    }
+}
+
+/*
+ * Test the mix kernels against the plain mix kernel.
+ */
+bool test_mix_kernels()
+{
+    return compare_kernels(run_mix_kernel, 1e-5);
+}
+
+/*
+ * Run the interleave kernel.
+ */
+void run_interleave_kernel(unsigned int num_samples,
+                           std::vector<float> *results)
+{
+    std::vector<float> left = generate_test_samples(num_samples, 20);
+    std::vector<float> right = generate_test_samples(num_samples, 21);
+
+    results->resize(2 * num_samples);
+    interleave_samples(left.data(), right.data(), results->data(),
+                       num_samples);
+}
+
+/*
+ * Test the interleave kernels against the plain interleave kernel.
+ */
+bool test_interleave_kernels()
+{
+    return compare_kernels(run_interleave_kernel, 0);
+}
+
+/*
+ * Run the sine wave kernel.
+ */
+void run_sin_kernel(unsigned int num_samples, std::vector<float> *results)
+{
+    std::vector<uint32_t> phases = generate_test_phases(num_samples, 22);
+
+    results->resize(num_samples);
+    sin_samples(phases.data(), results->data(), num_samples);
+}
+
+/*
+ * Test the sine wave kernels against the plain sine wave kernel. Kernels that
+ * fuse multiplies and adds evaluate the polynomial with less rounding.
+ */
+bool test_sin_kernels()
+{
+    return compare_kernels(run_sin_kernel, 1e-6);
+}
+
+/*
+ * Run the triangle wave kernel.
+ */
+void run_tri_kernel(unsigned int num_samples, std::vector<float> *results)
+{
+    std::vector<uint32_t> phases = generate_test_phases(num_samples, 23);
+
+    results->resize(num_samples);
+    tri_samples(phases.data(), results->data(), num_samples);
+}
+
+/*
+ * Test the triangle wave kernels against the plain triangle wave kernel.
+ */
+bool test_tri_kernels()
+{
+    return compare_kernels(run_tri_kernel, 0);
+}
+
+/*
+ * Run the saw wave kernel.
+ */
+void run_saw_kernel(unsigned int num_samples, std::vector<float> *results)
+{
+    std::vector<uint32_t> phases = generate_test_phases(num_samples, 24);
+
+    results->resize(num_samples);
+    saw_samples(phases.data(), results->data(), num_samples);
+}
+
+/*
+ * Test the saw wave kernels against the plain saw wave kernel.
+ */
+bool test_saw_kernels()
+{
+    return compare_kernels(run_saw_kernel, 0);
+}
+
+/*
+ * Run the square wave kernel with a few constant pulse widths.
+ */
+void run_sqr_kernel(unsigned int num_samples, std::vector<float> *results)
+{
+    std::vector<uint32_t> phases = generate_test_phases(num_samples, 25);
+    const float pulse_widths[] = {0, .1, .5, .9, 1};
+
+    results->resize(5 * num_samples);
+    for(unsigned int i = 0; i < 5; i ++)
+    {
+        sqr_samples(phases.data(), pulse_widths[i],
+                    results->data() + i * num_samples, num_samples);
+    }
+}
+
+/*
+ * Test the square wave kernels against the plain square wave kernel.
+ */
+bool test_sqr_kernels()
+{
+    return compare_kernels(run_sqr_kernel, 0);
+}
+
+/*
+ * Run the square wave kernel with a span of pulse widths from 0 to 1.
+ */
+void run_sqr_span_kernel(unsigned int num_samples,
+                         std::vector<float> *results)
+{
+    std::vector<uint32_t> phases = generate_test_phases(num_samples, 26);
+    std::vector<float> pulse_widths = generate_test_samples(num_samples, 27);
+
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        pulse_widths[i] = (pulse_widths[i] + 1) / 2;
+    }
+    results->resize(num_samples);
+    sqr_samples(phases.data(), pulse_widths.data(), results->data(),
+                num_samples);
 }
 
+/*
+ * Test the square wave kernels with a span of pulse widths against the plain
+ * square wave kernel with a span of pulse widths.
+ */
+bool test_sqr_span_kernels()
+{
+    return compare_kernels(run_sqr_span_kernel, 0);
+}
+
+/*
+ * Run the biquad kernel with every number of stages, low pass filters whose
+ * coefficients move a little every sample, and append the coefficients and
+ * history it leaves behind to the filtered samples. Stages past the last one
+ * have coefficients of 0, as the kernels require.
+ */
+void run_biquad_kernel(unsigned int num_samples, std::vector<float> *results)
+{
+    const float stage_coefficients[] = {.0675f, .135f, .0675f, -1.143f, .413f};
+    std::vector<float> src = generate_test_samples(num_samples, 28);
+    std::vector<float> dst(num_samples);
+
+    results->clear();
+    for(unsigned int num_stages = 1; num_stages <= 4; num_stages ++)
+    {
+        float coefficients[20];
+        float increments[20];
+        float history[8] = {0};
+
+        for(unsigned int j = 0; j < 5; j ++)
+        {
+            for(unsigned int k = 0; k < 4; k ++)
+            {
+                bool used = k < num_stages;
+                coefficients[j * 4 + k] = used ? stage_coefficients[j] : 0;
+                increments[j * 4 + k] = used ? 1e-6f * (k + 1) : 0;
+            }
+        }
+
+        biquad_samples(src.data(), dst.data(), num_samples, num_stages,
+                       coefficients, increments, history);
+        results->insert(results->end(), dst.begin(), dst.end());
+        results->insert(results->end(), coefficients, coefficients + 20);
+        results->insert(results->end(), history, history + 8);
+    }
+}
+
+/*
+ * Test the biquad kernels against the plain biquad kernel.
+ */
+bool test_biquad_kernels()
+{
+    return compare_kernels(run_biquad_kernel, 1e-5);
+}
+
+/*
+ * Run the noise kernel twice from the same seed, so that the second span
+ * starts wherever the generators were left by the first, and append the
+ * state of the generators, a half word at a time so that it fits in floats
+ * exactly.
+ */
+void run_noise_kernel(unsigned int num_samples, std::vector<float> *results)
+{
+    uint32_t state[NOISE_STATE_SIZE];
+
+    seed_noise(state, 29);
+    results->resize(2 * num_samples);
+    noise_samples(state, -1, 1, results->data(), num_samples);
+    noise_samples(state, -.5, 2, results->data() + num_samples, num_samples);
+
+    for(unsigned int i = 0; i < NOISE_STATE_SIZE; i ++)
+    {
+        results->push_back(state[i] >> 16);
+        results->push_back(state[i] & 0xffff);
+    }
+}
+
+/*
+ * Test the noise kernels against the plain noise kernel. Noise must be
+ * bit-identical whatever instruction set generates it.
+ */
+bool test_noise_kernels()
+{
+    return compare_kernels(run_noise_kernel, 0);
+}
+
+/*
+ * Run the ramp kernel up and down.
+ */
+void run_ramp_kernel(unsigned int num_samples, std::vector<float> *results)
+{
+    results->resize(2 * num_samples);
+    ramp_samples(.25, .001, results->data(), num_samples);
+    ramp_samples(440, -.37, results->data() + num_samples, num_samples);
+}
+
+/*
+ * Test the ramp kernels against the plain ramp kernel.
+ */
+bool test_ramp_kernels()
+{
+    return compare_kernels(run_ramp_kernel, 1e-6);
+}
+
+/*
+ * Run the curve kernel towards a target above and below its start.
+ */
+void run_curve_kernel(unsigned int num_samples, std::vector<float> *results)
+{
+    results->resize(2 * num_samples);
+    curve_samples(1, 0, .99, results->data(), num_samples);
+    curve_samples(-200, 3000, .9995, results->data() + num_samples,
+                  num_samples);
+}
+
+/*
+ * Test the curve kernels against the plain curve kernel.
+ */
+bool test_curve_kernels()
+{
+    return compare_kernels(run_curve_kernel, 1e-5);
+}
+
+/*
+ * Run the rising edge kernel on spans with a single rising edge at every
+ * position, after a sample either side of 0, and on a span with none.
+ */
+void run_rising_edge_kernel(unsigned int num_samples,
+                            std::vector<float> *results)
+{
+    std::vector<float> src(num_samples, -1);
+
+    results->clear();
+    for(unsigned int i = 0; i <= num_samples; i ++)
+    {
+        if(i < num_samples)
+        {
+            src[i] = 1;
+        }
+        results->push_back(find_rising_edge(src.data(), 0, num_samples));
+        results->push_back(find_rising_edge(src.data(), 1, num_samples));
+        if(i < num_samples)
+        {
+            src[i] = -1;
+        }
+    }
+}
+
+/*
+ * Test the rising edge kernels against the plain rising edge kernel.
+ */
+bool test_rising_edge_kernels()
+{
+    return compare_kernels(run_rising_edge_kernel, 0);
+}
+
+/*
+ * Run the constant kernel on a constant span, and on spans with a single
+ * different sample at every position.
+ */
+void run_constant_kernel(unsigned int num_samples,
+                         std::vector<float> *results)
+{
+    std::vector<float> src(num_samples, .5);
+
+    results->clear();
+    results->push_back(is_constant(src.data(), num_samples));
+    for(unsigned int i = 0; i < num_samples; i ++)
+    {
+        src[i] = -.5;
+        results->push_back(is_constant(src.data(), num_samples));
+        src[i] = .5;
+    }
+}
+
+/*
+ * Test the constant kernels against the plain constant kernel.
+ */
+bool test_constant_kernels()
+{
+    return compare_kernels(run_constant_kernel, 0);
+}
+
+/*
+ * Filter noise through a single state variable filter, and check that its
+ * lowpass and highpass outputs, added to its bandpass output scaled by 1 / q,
+ * give back the noise, and that its main output is its bandpass output.
+ */
+bool test_filter_outputs()
+{
+    Filter filter;
+    std::vector<float> signal = generate_test_samples(BUFFER_SIZE, 1);
+    std::vector<float> out(BUFFER_SIZE);
+    float damping = .5;
+    bool rebuilt = true;
+
+    filter.switch_topology(Filter::SVF);
+    filter.switch_filter(Filter::BANDPASS);
+    filter.inputs[Filter::FILTER_SIGNAL].in = signal.data();
+    filter.inputs[Filter::FILTER_SIGNAL].live = true;
+    filter.inputs[Filter::FILTER_FREQUENCY_CUTOFF].val = 1000;
+    filter.inputs[Filter::FILTER_Q].val = 1 / damping;
+    filter.out = out.data();
+
+    // The second block starts from the state the first left behind
+    for(unsigned int i = 0; i < 2; i ++)
+    {
+        filter.process(BUFFER_SIZE);
+        for(unsigned int j = 0; j < BUFFER_SIZE; j ++)
+        {
+            float sum = filter.extra_outs[0][j]
+                        + damping * filter.extra_outs[1][j]
+                        + filter.extra_outs[2][j];
+
+            if(fabs(sum - signal[j]) > 1e-5
+               || out[j] != filter.extra_outs[1][j])
+            {
+                rebuilt = false;
+            }
+        }
+    }
+
+    return rebuilt;
+}
+
+/*
+ * Compile an execution plan for a small graph in which one oscillator is read
+ * by two multipliers processed some time apart, and check that no module in
+ * the schedule is given a buffer whose module's output is still read later,
+ * while some buffers are still reused. Modules read by the output module are
+ * read after the whole schedule.
+ */
+bool test_buffer_liveness()
+{
+    Output *output;
+    Oscillator *oscillator_1, *oscillator_2;
+    Multiplier *multiplier_1, *multiplier_2, *multiplier_3;
+    Execution_Plan plan;
+    std::vector<unsigned int> last_reads;
+    std::set<unsigned int> buffers;
+    bool live = false;
+
+    // Each module takes the next free slot when it is created
+    output = new Output();
+    MODULES.push_back(output);
+    oscillator_1 = new Oscillator();
+    MODULES.push_back(oscillator_1);
+    oscillator_2 = new Oscillator();
+    MODULES.push_back(oscillator_2);
+    multiplier_1 = new Multiplier();
+    MODULES.push_back(multiplier_1);
+    multiplier_2 = new Multiplier();
+    MODULES.push_back(multiplier_2);
+    multiplier_3 = new Multiplier();
+    MODULES.push_back(multiplier_3);
+
+    multiplier_1->inputs[Multiplier::MULTIPLIER_SIGNAL].from = oscillator_1;
+    multiplier_2->inputs[Multiplier::MULTIPLIER_SIGNAL].from = multiplier_1;
+    multiplier_2->inputs[Multiplier::MULTIPLIER_MULTIPLIER].from =
+        oscillator_2;
+    multiplier_3->inputs[Multiplier::MULTIPLIER_SIGNAL].from = oscillator_1;
+    multiplier_3->inputs[Multiplier::MULTIPLIER_MULTIPLIER].from =
+        multiplier_2;
+    output->inputs[Output::OUTPUT_INPUT_L].from = multiplier_3;
+    output->inputs[Output::OUTPUT_INPUT_R].from = multiplier_3;
+
+    plan.compile(output);
+
+    // Find the last position in the schedule at which each module's output
+    // is read
+    for(unsigned int i = 0; i < plan.schedule.size(); i ++)
+    {
+        last_reads.push_back(i);
+    }
+    for(unsigned int i = 0; i < plan.bindings.size(); i ++)
+    {
+        Execution_Plan::Binding &binding = plan.bindings[i];
+        if(binding.src == nullptr)
+        {
+            continue;
+        }
+
+        unsigned int read_position = plan.schedule.size();
+        if(binding.module != output)
+        {
+            read_position = std::find(plan.schedule.begin(),
+                                      plan.schedule.end(), binding.module)
+                            - plan.schedule.begin();
+        }
+        last_reads[binding.src_index] =
+            std::max(last_reads[binding.src_index], read_position);
+    }
+
+    for(unsigned int i = 0; i < plan.schedule.size(); i ++)
+    {
+        buffers.insert(plan.buffer_indices[i]);
+        for(unsigned int j = i + 1;
+            j <= last_reads[i] && j < plan.schedule.size(); j ++)
+        {
+            if(plan.buffer_indices[j] == plan.buffer_indices[i])
+            {
+                std::cout << "    " << plan.schedule[j]->name
+                          << " outputs into the buffer of "
+                          << plan.schedule[i]->name
+                          << " while it is still read" << std::endl;
+                live = true;
+            }
+        }
+    }
+
+    for(unsigned int i = 0; i < MODULES.size(); i ++)
+    {
+        delete MODULES[i];
+    }
+    MODULES.clear();
+
+    return plan.schedule.size() == 5 && !live
+           && buffers.size() < plan.schedule.size();
+}
+
+/*
+ * Process an execution plan for an oscillator at 0 Hz used as a DC offset,
+ * read by a multiplier, and check that both reuse their outputs once they
+ * have settled, and that changing the oscillator's range makes both of them
+ * process again.
+ */
+bool test_static_outputs()
+{
+    Output *output;
+    Oscillator *oscillator;
+    Multiplier *multiplier;
+    Execution_Plan plan;
+    bool reused, updated;
+
+    output = new Output();
+    MODULES.push_back(output);
+    oscillator = new Oscillator();
+    MODULES.push_back(oscillator);
+    multiplier = new Multiplier();
+    MODULES.push_back(multiplier);
+
+    oscillator->inputs[Oscillator::OSCILLATOR_RANGE_LOW].val = .25;
+    oscillator->inputs[Oscillator::OSCILLATOR_RANGE_HIGH].val = .25;
+    multiplier->inputs[Multiplier::MULTIPLIER_SIGNAL].from = oscillator;
+    multiplier->inputs[Multiplier::MULTIPLIER_MULTIPLIER].val = 2;
+    output->inputs[Output::OUTPUT_INPUT_L].from = multiplier;
+    output->inputs[Output::OUTPUT_INPUT_R].from = multiplier;
+
+    plan.compile(output);
+    plan.bind();
+
+    // The oscillator settles after two blocks, and the multiplier one block
+    // after it
+    for(unsigned int i = 0; i < 4; i ++)
+    {
+        plan.process();
+    }
+    reused = oscillator->output_reused && multiplier->output_reused
+             && multiplier->out[0] == .5
+             && multiplier->out[BUFFER_SIZE - 1] == .5;
+
+    oscillator->jump_input(Oscillator::OSCILLATOR_RANGE_HIGH, .75);
+    plan.process();
+    updated = !oscillator->output_reused && !multiplier->output_reused
+              && multiplier->out[0] == 1
+              && multiplier->out[BUFFER_SIZE - 1] == 1;
+
+    for(unsigned int i = 0; i < MODULES.size(); i ++)
+    {
+        delete MODULES[i];
+    }
+    MODULES.clear();
+
+    return reused && updated;
+}
+
+/*
+ * Modulate a multiplier with LFOs from -1 to 1 calculated at control rate with
+ * the default control period, and check that the result stays within a
+ * thousandth of the range of modulating it with the same LFOs calculated
+ * every sample for sines, and within a hundredth for triangles, whose corners
+ * are rounded off. A square wave is always calculated every sample.
+ */
+bool test_control_rate()
+{
+    Oscillator::WaveformType waveform_types[] = {Oscillator::SIN,
+                                                 Oscillator::TRI,
+                                                 Oscillator::SQR};
+    float tolerances[] = {.002, .02, 0};
+    float frequencies[] = {.5, 7, 35};
+    bool control_rate = true;
+    bool close = true;
+
+    for(unsigned int i = 0; i < 3; i ++)
+    {
+        for(unsigned int j = 0; j < 3; j ++)
+        {
+            std::vector<float> control_results, audio_results;
+
+            control_rate = render_modulation(waveform_types[i],
+                                             frequencies[j], CONTROL_PERIOD,
+                                             16, &control_results)
+                           == (waveform_types[i] != Oscillator::SQR)
+                           && control_rate;
+            render_modulation(waveform_types[i], frequencies[j], 1, 16,
+                              &audio_results);
+            for(unsigned int k = 0; k < control_results.size(); k ++)
+            {
+                if(fabs(control_results[k] - audio_results[k])
+                   > tolerances[i])
+                {
+                    close = false;
+                }
+            }
+        }
+    }
+
+    return CONTROL_PERIOD > 1 && control_rate && close;
+}
+
+/*
+ * Play more notes than a poly module has voices, and check that a new note
+ * steals the voice released the longest ago, and once no voice is released,
+ * the voice whose note started the longest ago.
+ */
+bool test_poly_voice_stealing()
+{
+    Poly poly;
+    std::vector<float> out(BUFFER_SIZE);
+    unsigned int voices[4];
+    bool stolen = true;
+
+    poly.out = out.data();
+    poly.switch_num_voices(4);
+    poly.process(BUFFER_SIZE);
+
+    for(unsigned int i = 0; i < 4; i ++)
+    {
+        poly.note_on(60 + i, 440);
+    }
+    for(unsigned int v = 0; v < 4; v ++)
+    {
+        voices[poly.notes[v] - 60] = v;
+    }
+
+    // Notes 61 and 63 are released, 61 first
+    poly.note_off(61);
+    poly.note_off(63);
+
+    poly.note_on(64, 440);
+    stolen = poly.notes[voices[1]] == 64 && stolen;
+    poly.note_on(65, 440);
+    stolen = poly.notes[voices[3]] == 65 && stolen;
+    poly.note_on(66, 440);
+    stolen = poly.notes[voices[0]] == 66 && stolen;
+    poly.note_on(67, 440);
+    stolen = poly.notes[voices[2]] == 67 && stolen;
+
+    return stolen;
+}
+
+/*
+ * Drive a poly module's note on/off input with a gate that rises and falls
+ * partway through a block, and check that the note starts and is released on
+ * exactly the samples the gate changes.
+ */
+bool test_poly_note_edges()
+{
+    Poly poly;
+    std::vector<float> note(BUFFER_SIZE, 0);
+    std::vector<float> out(BUFFER_SIZE);
+    unsigned int note_on = 100, note_off = 300;
+    unsigned int v;
+    float released;
+    bool silent = true;
+
+    std::fill(note.begin() + note_on, note.begin() + note_off, 1);
+    poly.inputs[Poly::POLY_NOTE].in = note.data();
+    poly.inputs[Poly::POLY_NOTE].live = true;
+    poly.out = out.data();
+    poly.process(BUFFER_SIZE);
+
+    // The envelope starts from nothing on the sample the note starts
+    for(unsigned int i = 0; i <= note_on; i ++)
+    {
+        silent = out[i] == 0 && silent;
+    }
+    for(v = 0; poly.notes[v] != Poly::INPUT_NOTE; v ++)
+    {
+        if(v == poly.num_voices - 1)
+        {
+            return false;
+        }
+    }
+
+    // The attack went on for as many samples as the gate was up, and the
+    // release for the rest of the block
+    released = (note_off - note_on) / poly.attack_samples;
+    return silent && out[note_on + 1] != 0
+           && poly.stages[v] == Poly::VOICE_R_STAGE
+           && poly.stage_samples[v]
+              == poly.release_samples - (BUFFER_SIZE - note_off)
+           && fabs(poly.amplitude_increments[v] * poly.release_samples
+                   + released) < 1e-5;
+}
+
+/*
+ * Set a multiplier's multiplier smoothly while audio is on, and check that
+ * the ramp moves in a straight line from the old value, which it leaves on its
+ * first sample, to the new value, which it reaches on the last sample of the
+ * smoothing time, that the new value is saved while the ramp is under way,
+ * and that setting a value the way loading a patch does jumps straight to it.
+ */
+bool test_smoothing()
+{
+    Multiplier multiplier;
+    int input_num = Multiplier::MULTIPLIER_MULTIPLIER;
+    Module::Parameter *input = &multiplier.inputs[input_num];
+    unsigned int samples = SMOOTHING_TIME * SAMPLE_RATE / 1000;
+    std::string saved = "\n" + std::to_string(1.0f) + "\n";
+    std::vector<float> ramp;
+    bool audio_on = AUDIO_ON;
+    bool ramped = true, jumped;
+
+    AUDIO_ON = true;
+    multiplier.scheduled = true;
+    multiplier.set(input_num, 0, false);
+    multiplier.set(input_num, 1);
+    COMMAND_QUEUE.apply_commands();
+
+    for(unsigned int i = 0; i < samples / BUFFER_SIZE + 2; i ++)
+    {
+        multiplier.start_smoothing(BUFFER_SIZE);
+        for(unsigned int j = 0; j < BUFFER_SIZE; j ++)
+        {
+            ramp.push_back(input->live ? input->in[j] : input->val);
+        }
+        multiplier.finish_smoothing(BUFFER_SIZE);
+
+        if(i == 0)
+        {
+            ramped = multiplier.get_text_representation().find(saved)
+                     != std::string::npos && input->val != 1;
+        }
+    }
+    for(unsigned int i = 0; i < ramp.size(); i ++)
+    {
+        if(fabs(ramp[i] - std::min((float) (i + 1) / samples, (float) 1))
+           > 1e-5)
+        {
+            ramped = false;
+        }
+    }
+    ramped = ramped && ramp[samples - 2] < 1 && ramp[samples - 1] == 1
+             && input->val == 1 && input->smoothing_samples == 0;
+
+    // Loading a patch sets values without smoothing them
+    multiplier.set(input_num, .25);
+    multiplier.set(input_num, .5, false);
+    COMMAND_QUEUE.apply_commands();
+    multiplier.start_smoothing(BUFFER_SIZE);
+    jumped = !input->live && input->val == .5
+             && input->smoothing_samples == 0
+             && multiplier.get_text_representation().find(
+                    "\n" + std::to_string(.5f) + "\n") != std::string::npos;
+
+    AUDIO_ON = audio_on;
+
+    return ramped && jumped;
+}
+
+/*
+ * Process a plan wide enough to be shared between threads with three worker
+ * threads, and check that it really is processed in parallel, and that its
+ * output is the same, sample for sample, as processing it on one thread.
+ */
+bool test_parallel_scheduler()
+{
+    std::vector<float> parallel_results, serial_results;
+    bool parallel;
+
+    parallel = render_wide_graph(3, 64, &parallel_results);
+    render_wide_graph(0, 64, &serial_results);
+
+    return parallel && parallel_results.size() == 64 * BUFFER_SIZE
+           && parallel_results == serial_results;
+}
+
+/*
+ * Compile execution plans for a loop in which a mixer adds a DC offset of 1 to
+ * a multiplier halving the mixer's own output, and check that the offset is
+ * scheduled first, then the multiplier, which is farther from the output
+ * module, then the mixer, and that only the multiplier reading the mixer is a
+ * feedback connection. Then check that processed a block at a time, the
+ * feedback reaches the mixer a block later, and processed one sample at a
+ * time, it reaches the mixer a sample later.
+ */
+bool test_feedback_plans()
+{
+    Output *output;
+    Oscillator *offset;
+    Multiplier *multiplier;
+    Mixer *mixer;
+    unsigned int delays[] = {BUFFER_SIZE, 1};
+    bool tight_feedback = TIGHT_FEEDBACK;
+    bool scheduled = true, delayed = true;
+
+    output = new Output();
+    MODULES.push_back(output);
+    offset = new Oscillator();
+    MODULES.push_back(offset);
+    multiplier = new Multiplier();
+    MODULES.push_back(multiplier);
+    mixer = new Mixer();
+    MODULES.push_back(mixer);
+
+    offset->inputs[Oscillator::OSCILLATOR_RANGE_LOW].val = 1;
+    offset->inputs[Oscillator::OSCILLATOR_RANGE_HIGH].val = 1;
+    mixer->inputs[Mixer::MIXER_SIGNAL].from = offset;
+    mixer->inputs[2 + Mixer::MIXER_SIGNAL].from = multiplier;
+    multiplier->inputs[Multiplier::MULTIPLIER_SIGNAL].from = mixer;
+    multiplier->inputs[Multiplier::MULTIPLIER_MULTIPLIER].val = .5;
+    output->inputs[Output::OUTPUT_INPUT_L].from = mixer;
+    output->inputs[Output::OUTPUT_INPUT_R].from = mixer;
+
+    for(unsigned int i = 0; i < 2; i ++)
+    {
+        Execution_Plan plan;
+        std::vector<float> results;
+        unsigned int num_feedbacks = 0;
+
+        TIGHT_FEEDBACK = i == 1;
+        plan.compile(output);
+        plan.bind();
+
+        scheduled = scheduled && plan.schedule.size() == 3
+                    && plan.schedule[0] == offset
+                    && plan.schedule[1] == multiplier
+                    && plan.schedule[2] == mixer && plan.loops.size() == 1
+                    && plan.loops[0].first == 1 && plan.loops[0].last == 2
+                    && plan.tight_feedback == (i == 1);
+        for(unsigned int k = 0; k < plan.bindings.size(); k ++)
+        {
+            if(plan.bindings[k].feedback)
+            {
+                num_feedbacks ++;
+                scheduled = scheduled
+                            && plan.bindings[k].module == multiplier
+                            && plan.bindings[k].input_num
+                               == Multiplier::MULTIPLIER_SIGNAL
+                            && plan.bindings[k].src == mixer;
+            }
+        }
+        scheduled = scheduled && num_feedbacks == 1;
+
+        for(unsigned int j = 0; j < 3; j ++)
+        {
+            plan.process();
+            results.insert(results.end(), mixer->out,
+                           mixer->out + BUFFER_SIZE);
+        }
+
+        // Before the feedback arrives, the mixer reads silence from it
+        for(unsigned int n = 0; n < results.size(); n ++)
+        {
+            float feedback = n >= delays[i] ? results[n - delays[i]] : 0;
+            if(fabs(results[n] - (1 + .5 * feedback)) > 1e-6)
+            {
+                delayed = false;
+            }
+        }
+    }
+
+    TIGHT_FEEDBACK = tight_feedback;
+    for(unsigned int i = 0; i < MODULES.size(); i ++)
+    {
+        delete MODULES[i];
+    }
+    MODULES.clear();
+
+    return scheduled && delayed;
+}
+
+/*
+ * Fill a delay line with a signal, reset it, then lengthen the max delay time
+ * and the delay time past what the reset cleared, and check that nothing from
+ * before the reset can be heard.
+ */
+bool test_delay_reset()
+{
+    Delay delay;
+    std::vector<float> signal(BUFFER_SIZE, 1);
+    std::vector<float> out(BUFFER_SIZE);
+    bool silent = true;
+
+    delay.inputs[Delay::DELAY_SIGNAL].in = signal.data();
+    delay.inputs[Delay::DELAY_SIGNAL].live = true;
+    delay.inputs[Delay::DELAY_MAX_DELAY_TIME].val = 20;
+    delay.inputs[Delay::DELAY_DELAY_TIME].val = 10;
+    delay.out = out.data();
+    for(unsigned int i = 0; i < 20; i ++)
+    {
+        delay.process(BUFFER_SIZE);
+    }
+
+    delay.reset_buffer();
+    delay.inputs[Delay::DELAY_SIGNAL].in = nullptr;
+    delay.inputs[Delay::DELAY_SIGNAL].live = false;
+    delay.inputs[Delay::DELAY_MAX_DELAY_TIME].val = 200;
+    delay.inputs[Delay::DELAY_DELAY_TIME].val = 150;
+    for(unsigned int i = 0; i < 2; i ++)
+    {
+        delay.process(BUFFER_SIZE);
+        for(unsigned int j = 0; j < BUFFER_SIZE; j ++)
+        {
+            silent = out[j] == 0 && silent;
+        }
+    }
+
+    return silent && delay.cleared_samples < delay.circular_buffer.size();
+}
+
+/*
+ * Write a few samples as 32 bit floats in stereo and as 16 bit PCM in mono,
+ * read the files back, and check every field of their headers, and that the
+ * samples come back exactly, or clipped and scaled to 16 bits for PCM.
+ */
+bool test_wav_writer()
+{
+    std::vector<float> samples = {0, .5, -1, 2};
+    std::string bytes;
+    bool float_correct, pcm_correct;
+
+    float_correct = write_test_wav(false, 2, samples, &bytes)
+                    && bytes.size() == 74
+                    && bytes.compare(0, 4, "RIFF") == 0
+                    && read_little_endian(bytes, 4, 4) == 66
+                    && bytes.compare(8, 8, "WAVEfmt ") == 0
+                    && read_little_endian(bytes, 16, 4) == 18
+                    && read_little_endian(bytes, 20, 2) == 3
+                    && read_little_endian(bytes, 22, 2) == 2
+                    && read_little_endian(bytes, 24, 4) == 44100
+                    && read_little_endian(bytes, 28, 4) == 44100 * 2 * 4
+                    && read_little_endian(bytes, 32, 2) == 8
+                    && read_little_endian(bytes, 34, 2) == 32
+                    && read_little_endian(bytes, 36, 2) == 0
+                    && bytes.compare(38, 4, "fact") == 0
+                    && read_little_endian(bytes, 42, 4) == 4
+                    && read_little_endian(bytes, 46, 4) == 2
+                    && bytes.compare(50, 4, "data") == 0
+                    && read_little_endian(bytes, 54, 4) == 16;
+    for(unsigned int i = 0; float_correct && i < samples.size(); i ++)
+    {
+        uint32_t bits = read_little_endian(bytes, 58 + 4 * i, 4);
+        float sample;
+
+        memcpy(&sample, &bits, 4);
+        float_correct = sample == samples[i];
+    }
+
+    pcm_correct = write_test_wav(true, 1, samples, &bytes)
+                  && bytes.size() == 52
+                  && bytes.compare(0, 4, "RIFF") == 0
+                  && read_little_endian(bytes, 4, 4) == 44
+                  && bytes.compare(8, 8, "WAVEfmt ") == 0
+                  && read_little_endian(bytes, 16, 4) == 16
+                  && read_little_endian(bytes, 20, 2) == 1
+                  && read_little_endian(bytes, 22, 2) == 1
+                  && read_little_endian(bytes, 24, 4) == 44100
+                  && read_little_endian(bytes, 28, 4) == 44100 * 2
+                  && read_little_endian(bytes, 32, 2) == 2
+                  && read_little_endian(bytes, 34, 2) == 16
+                  && bytes.compare(36, 4, "data") == 0
+                  && read_little_endian(bytes, 40, 4) == 8
+                  && (int16_t) read_little_endian(bytes, 44, 2) == 0
+                  && (int16_t) read_little_endian(bytes, 46, 2) == 16383
+                  && (int16_t) read_little_endian(bytes, 48, 2) == -32767
+                  && (int16_t) read_little_endian(bytes, 50, 2) == 32767;
+
+    return float_correct && pcm_correct;
+}
+
+/*************
+ * RUN TESTS *
+ *************/
+
+/*
+ * Run all tests.
+ */
+bool run_tests()
+{
+    std::string names[30];
+    int results[30];
+    int test_num = 0;
+
+    names[test_num] = "test add signals 1";
+    results[test_num] = test_add_signals_1();
+    test_num ++;
+
+    names[test_num] = "test clip kernels";
+    results[test_num] = test_clip_kernels();
+    test_num ++;
+
+    names[test_num] = "test scale kernels";
+    results[test_num] = test_scale_kernels();
+    test_num ++;
+
+    names[test_num] = "test add kernels";
+    results[test_num] = test_add_kernels();
+    test_num ++;
+
+    names[test_num] = "test multiply kernels";
+    results[test_num] = test_multiply_kernels();
+    test_num ++;
+
+    names[test_num] = "test multiply add kernels";
+    results[test_num] = test_multiply_add_kernels();
+    test_num ++;
+
+    names[test_num] = "test mix kernels";
+    results[test_num] = test_mix_kernels();
+    test_num ++;
+
+    names[test_num] = "test interleave kernels";
+    results[test_num] = test_interleave_kernels();
+    test_num ++;
+
+    names[test_num] = "test sin kernels";
+    results[test_num] = test_sin_kernels();
+    test_num ++;
+
+    names[test_num] = "test tri kernels";
+    results[test_num] = test_tri_kernels();
+    test_num ++;
+
+    names[test_num] = "test saw kernels";
+    results[test_num] = test_saw_kernels();
+    test_num ++;
+
+    names[test_num] = "test sqr kernels";
+    results[test_num] = test_sqr_kernels();
+    test_num ++;
+
+    names[test_num] = "test sqr span kernels";
+    results[test_num] = test_sqr_span_kernels();
+    test_num ++;
+
+    names[test_num] = "test biquad kernels";
+    results[test_num] = test_biquad_kernels();
+    test_num ++;
+
+    names[test_num] = "test noise kernels";
+    results[test_num] = test_noise_kernels();
+    test_num ++;
+
+    names[test_num] = "test ramp kernels";
+    results[test_num] = test_ramp_kernels();
+    test_num ++;
+
+    names[test_num] = "test curve kernels";
+    results[test_num] = test_curve_kernels();
+    test_num ++;
+
+    names[test_num] = "test rising edge kernels";
+    results[test_num] = test_rising_edge_kernels();
+    test_num ++;
+
+    names[test_num] = "test constant kernels";
+    results[test_num] = test_constant_kernels();
+    test_num ++;
+
+    names[test_num] = "test filter outputs";
+    results[test_num] = test_filter_outputs();
+    test_num ++;
+
+    names[test_num] = "test buffer liveness";
+    results[test_num] = test_buffer_liveness();
+    test_num ++;
+
+    names[test_num] = "test static outputs";
+    results[test_num] = test_static_outputs();
+    test_num ++;
+
+    names[test_num] = "test control rate";
+    results[test_num] = test_control_rate();
+    test_num ++;
+
+    names[test_num] = "test poly voice stealing";
+    results[test_num] = test_poly_voice_stealing();
+    test_num ++;
+
+    names[test_num] = "test poly note edges";
+    results[test_num] = test_poly_note_edges();
+    test_num ++;
+
+    names[test_num] = "test smoothing";
+    results[test_num] = test_smoothing();
+    test_num ++;
+
+    names[test_num] = "test parallel scheduler";
+    results[test_num] = test_parallel_scheduler();
+    test_num ++;
+
+    names[test_num] = "test feedback plans";
+    results[test_num] = test_feedback_plans();
+    test_num ++;
+
+    names[test_num] = "test delay reset";
+    results[test_num] = test_delay_reset();
+    test_num ++;
+
+    names[test_num] = "test wav writer";
+    results[test_num] = test_wav_writer();
+    test_num ++;
+
+    print_test_results(names, results, test_num);
+
+    if(all_tests_passed(results, test_num))
+    {
+        return true;
+    }
+
+    return false;
+}